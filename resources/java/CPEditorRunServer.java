@@ -0,0 +1,505 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The Java run server is a long-lived JVM started by Extensions::JavaRunServer.
+ * It loads the compiled solution in a new class loader for each run, so the JVM start-up
+ * and JIT warm-up are paid only once per session.
+ *
+ * On start-up it prints "READY <port>" (or "UNSUPPORTED <reason>") to stdout, and it exits
+ * when its stdin is closed, i.e. when CP Editor exits.
+ *
+ * It also compiles Java sources by javax.tools.JavaCompiler, so javac doesn't start a new JVM for each compilation.
+ *
+ * The protocol is compatible with QDataStream (big-endian, byte arrays are prefixed by a 32-bit length).
+ * Each request starts with the request type.
+ * Run request: class path, class name, argument count, arguments, input, time limit (ms), output limit (bytes).
+ * Run response: status, exit code, load time (ns), execution time (ns), stdout, stderr.
+ * Compile request: argument count, arguments (the same as the arguments of javac).
+ * Compile response: status, exit code, compile time (ns), diagnostics.
+ *
+ * After a time limit exceeded or an output limit exceeded, the solution can't be stopped safely,
+ * so the server halts itself and CP Editor starts a new one for the next run.
+ * It waits for the other runs to finish before halting, and the new runs are answered by the
+ * failed-to-start status meanwhile, so CP Editor runs them by plain java.
+ */
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.File;
+import java.io.FileDescriptor;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.io.PrintStream;
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.net.InetAddress;
+import java.net.ServerSocket;
+import java.net.Socket;
+import java.net.URL;
+import java.net.URLClassLoader;
+import java.nio.charset.StandardCharsets;
+import java.security.Permission;
+import java.util.concurrent.atomic.AtomicInteger;
+import javax.tools.JavaCompiler;
+import javax.tools.ToolProvider;
+
+public class CPEditorRunServer
+{
+    static final int REQUEST_RUN = 0;
+    static final int REQUEST_COMPILE = 1;
+
+    static final int STATUS_FINISHED = 0;
+    static final int STATUS_TIME_LIMIT_EXCEEDED = 1;
+    static final int STATUS_OUTPUT_LIMIT_EXCEEDED = 2;
+    static final int STATUS_FAILED_TO_START = 3;
+
+    // the number of accepted connections not finished, the server is halted when it becomes zero and a halt is pending
+    static final AtomicInteger activeRequests = new AtomicInteger();
+    static volatile boolean haltPending = false;
+
+    // the streams of the run on the current thread, inherited by the threads created by the solution
+    static final InheritableThreadLocal<InputStream> currentIn = new InheritableThreadLocal<>();
+    static final InheritableThreadLocal<OutputStream> currentOut = new InheritableThreadLocal<>();
+    static final InheritableThreadLocal<OutputStream> currentErr = new InheritableThreadLocal<>();
+
+    static class ExitException extends SecurityException
+    {
+        final int status;
+
+        ExitException(int status)
+        {
+            super("System.exit(" + status + ")");
+            this.status = status;
+        }
+    }
+
+    static class LimitedOutputStream extends ByteArrayOutputStream
+    {
+        final int limit;
+        volatile boolean exceeded = false;
+
+        LimitedOutputStream(int limit)
+        {
+            this.limit = limit;
+        }
+
+        @Override
+        public synchronized void write(int b)
+        {
+            if (count >= limit)
+                exceeded = true;
+            else
+                super.write(b);
+        }
+
+        @Override
+        public synchronized void write(byte[] b, int off, int len)
+        {
+            if (count + len > limit)
+            {
+                exceeded = true;
+                len = Math.max(0, limit - count);
+            }
+            super.write(b, off, len);
+        }
+    }
+
+    static class RedirectedOutputStream extends OutputStream
+    {
+        final InheritableThreadLocal<OutputStream> current;
+        final OutputStream fallback;
+
+        RedirectedOutputStream(InheritableThreadLocal<OutputStream> current, OutputStream fallback)
+        {
+            this.current = current;
+            this.fallback = fallback;
+        }
+
+        OutputStream target()
+        {
+            OutputStream out = current.get();
+            return out == null ? fallback : out;
+        }
+
+        @Override
+        public void write(int b) throws IOException
+        {
+            target().write(b);
+        }
+
+        @Override
+        public void write(byte[] b, int off, int len) throws IOException
+        {
+            target().write(b, off, len);
+        }
+
+        @Override
+        public void flush() throws IOException
+        {
+            target().flush();
+        }
+    }
+
+    static class RedirectedInputStream extends InputStream
+    {
+        static final InputStream EMPTY = new ByteArrayInputStream(new byte[0]);
+
+        InputStream target()
+        {
+            InputStream in = currentIn.get();
+            return in == null ? EMPTY : in;
+        }
+
+        @Override
+        public int read() throws IOException
+        {
+            return target().read();
+        }
+
+        @Override
+        public int read(byte[] b, int off, int len) throws IOException
+        {
+            return target().read(b, off, len);
+        }
+
+        @Override
+        public int available() throws IOException
+        {
+            return target().available();
+        }
+    }
+
+    static class Run implements Runnable
+    {
+        final String classPath;
+        final String className;
+        final String[] args;
+        final byte[] input;
+        final LimitedOutputStream out;
+        final LimitedOutputStream err;
+
+        volatile int exitCode = 0;
+        volatile long loadTime = 0;
+        volatile long executionTime = 0;
+        volatile boolean started = false;
+        volatile long loadStart = 0;
+        volatile long executionStart = 0;
+
+        Run(String classPath, String className, String[] args, byte[] input, int outputLimit)
+        {
+            this.classPath = classPath;
+            this.className = className;
+            this.args = args;
+            this.input = input;
+            this.out = new LimitedOutputStream(outputLimit);
+            this.err = new LimitedOutputStream(outputLimit);
+        }
+
+        @Override
+        public void run()
+        {
+            currentIn.set(new ByteArrayInputStream(input));
+            currentOut.set(out);
+            currentErr.set(err);
+
+            loadStart = System.nanoTime();
+            try
+            {
+                // the parent is the parent of the application class loader, so the server classes are invisible
+                URLClassLoader loader = new URLClassLoader(new URL[] {new File(classPath).toURI().toURL()},
+                                                           ClassLoader.getSystemClassLoader().getParent());
+                // the class is initialized in main.invoke, so errors in static initializers are runtime errors
+                Class<?> mainClass = Class.forName(className, false, loader);
+                Method main = mainClass.getMethod("main", String[].class);
+                executionStart = System.nanoTime();
+                loadTime = executionStart - loadStart;
+                started = true;
+                main.invoke(null, (Object) args);
+            }
+            catch (Throwable e)
+            {
+                handle(e);
+            }
+            finally
+            {
+                if (!started)
+                    loadTime = System.nanoTime() - loadStart;
+                else
+                    executionTime = System.nanoTime() - executionStart;
+                System.out.flush();
+                System.err.flush();
+            }
+        }
+
+        // record the time used so far, called by the watchdog when it stops waiting for a run which is still running
+        void stopTiming()
+        {
+            long now = System.nanoTime();
+            if (loadStart == 0)
+                return; // the worker hasn't started yet
+            if (started)
+                executionTime = now - executionStart;
+            else
+                loadTime = now - loadStart;
+        }
+
+        void handle(Throwable e)
+        {
+            while ((e instanceof InvocationTargetException || e instanceof ExceptionInInitializerError) &&
+                   e.getCause() != null)
+                e = e.getCause();
+            if (e instanceof ExitException)
+            {
+                exitCode = ((ExitException) e).status;
+                return;
+            }
+            exitCode = 1;
+            e.printStackTrace(new PrintStream(err, true));
+        }
+    }
+
+    static byte[] readBytes(DataInputStream in) throws IOException
+    {
+        int length = in.readInt();
+        if (length == -1) // null QByteArray
+            return new byte[0];
+        byte[] data = new byte[length];
+        in.readFully(data);
+        return data;
+    }
+
+    static String readString(DataInputStream in) throws IOException
+    {
+        return new String(readBytes(in), StandardCharsets.UTF_8);
+    }
+
+    static void writeBytes(DataOutputStream out, byte[] data) throws IOException
+    {
+        out.writeInt(data.length);
+        out.write(data);
+    }
+
+    static void handle(Socket socket)
+    {
+        try
+        {
+            DataInputStream request = new DataInputStream(socket.getInputStream());
+            if (request.readInt() == REQUEST_COMPILE)
+                handleCompile(socket, request);
+            else
+                handleRun(socket, request);
+        }
+        catch (IOException e)
+        {
+            // the connection is closed by CP Editor before the request is received
+        }
+        finally
+        {
+            if (activeRequests.decrementAndGet() == 0 && haltPending)
+                Runtime.getRuntime().halt(0);
+        }
+    }
+
+    static void handleCompile(Socket socket, DataInputStream request) throws IOException
+    {
+        String[] args = new String[request.readInt()];
+        for (int i = 0; i < args.length; ++i)
+            args[i] = readString(request);
+
+        int status = STATUS_FINISHED;
+        int exitCode = 0;
+        ByteArrayOutputStream diagnostics = new ByteArrayOutputStream();
+        long compileStart = System.nanoTime();
+        try
+        {
+            // null if the server is running on a JRE
+            JavaCompiler compiler = ToolProvider.getSystemJavaCompiler();
+            if (compiler == null)
+                status = STATUS_FAILED_TO_START;
+            else
+                exitCode = compiler.run(null, diagnostics, diagnostics, args);
+        }
+        catch (RuntimeException e)
+        {
+            // let CP Editor compile it by javac, which reports the error in its own way
+            status = STATUS_FAILED_TO_START;
+        }
+        long compileTime = System.nanoTime() - compileStart;
+
+        DataOutputStream response = new DataOutputStream(socket.getOutputStream());
+        response.writeInt(status);
+        response.writeInt(exitCode);
+        response.writeLong(compileTime);
+        writeBytes(response, diagnostics.toByteArray());
+        response.flush();
+        socket.close();
+    }
+
+    static void handleRun(Socket socket, DataInputStream request)
+    {
+        boolean halt = false;
+        try
+        {
+            String classPath = readString(request);
+            String className = readString(request);
+            String[] args = new String[request.readInt()];
+            for (int i = 0; i < args.length; ++i)
+                args[i] = readString(request);
+            byte[] input = readBytes(request);
+            int timeLimit = request.readInt();
+            int outputLimit = request.readInt();
+
+            if (haltPending)
+            {
+                // the solution is not run, so CP Editor can run it by plain java
+                DataOutputStream response = new DataOutputStream(socket.getOutputStream());
+                response.writeInt(STATUS_FAILED_TO_START);
+                response.writeInt(0);
+                response.writeLong(0);
+                response.writeLong(0);
+                writeBytes(response, new byte[0]);
+                writeBytes(response, new byte[0]);
+                response.flush();
+                socket.close();
+                return;
+            }
+
+            Run run = new Run(classPath, className, args, input, outputLimit);
+            Thread worker = new Thread(run, "CP Editor Run");
+            worker.setDaemon(true);
+            worker.start();
+
+            // the watchdog, it stops waiting when the time limit or the output limit is exceeded
+            long deadline = System.nanoTime() + timeLimit * 1000000L;
+            int status = STATUS_FINISHED;
+            while (worker.isAlive())
+            {
+                worker.join(10);
+                if (run.out.exceeded || run.err.exceeded)
+                {
+                    status = STATUS_OUTPUT_LIMIT_EXCEEDED;
+                    break;
+                }
+                if (System.nanoTime() > deadline && worker.isAlive())
+                {
+                    status = STATUS_TIME_LIMIT_EXCEEDED;
+                    break;
+                }
+            }
+
+            if (status == STATUS_FINISHED && !run.started)
+                status = STATUS_FAILED_TO_START;
+
+            halt = worker.isAlive();
+            if (halt)
+                run.stopTiming(); // the worker sets the times when it finishes, which is never in this case
+
+            DataOutputStream response = new DataOutputStream(socket.getOutputStream());
+            response.writeInt(status);
+            response.writeInt(run.exitCode);
+            response.writeLong(run.loadTime);
+            response.writeLong(run.executionTime);
+            writeBytes(response, run.out.toByteArray());
+            writeBytes(response, run.err.toByteArray());
+            response.flush();
+            socket.close();
+        }
+        catch (Exception e)
+        {
+            // the connection is closed by CP Editor (e.g. the run is killed), the solution may be still running
+            halt = true;
+        }
+
+        // halting now would break the other runs on this JVM, which have run their solutions already
+        if (halt)
+            haltPending = true;
+    }
+
+    public static void main(String[] args) throws IOException
+    {
+        PrintStream stdout = new PrintStream(new FileOutputStream(FileDescriptor.out), true);
+        PrintStream stderr = new PrintStream(new FileOutputStream(FileDescriptor.err), true);
+        InputStream stdin = new FileInputStream(FileDescriptor.in);
+
+        System.setIn(new RedirectedInputStream());
+        System.setOut(new PrintStream(new RedirectedOutputStream(currentOut, stdout), false));
+        System.setErr(new PrintStream(new RedirectedOutputStream(currentErr, stderr), false));
+
+        try
+        {
+            System.setSecurityManager(new SecurityManager() {
+                @Override
+                public void checkPermission(Permission permission)
+                {
+                }
+
+                @Override
+                public void checkPermission(Permission permission, Object context)
+                {
+                }
+
+                @Override
+                public void checkExit(int status)
+                {
+                    // only System.exit in the solutions is intercepted
+                    if (currentOut.get() != null)
+                        throw new ExitException(status);
+                }
+            });
+        }
+        catch (UnsupportedOperationException | SecurityException e)
+        {
+            stdout.println("UNSUPPORTED " + e);
+            return;
+        }
+
+        ServerSocket server = new ServerSocket(0, 50, InetAddress.getLoopbackAddress());
+
+        Thread parentWatcher = new Thread(() -> {
+            try
+            {
+                while (stdin.read() != -1)
+                {
+                }
+            }
+            catch (IOException e)
+            {
+                // the parent has gone
+            }
+            Runtime.getRuntime().halt(0);
+        });
+        parentWatcher.setDaemon(true);
+        parentWatcher.start();
+
+        stdout.println("READY " + server.getLocalPort());
+
+        while (true)
+        {
+            Socket socket = server.accept();
+            activeRequests.incrementAndGet(); // counted before it's handled, so a pending halt waits for it
+            Thread handler = new Thread(() -> handle(socket));
+            handler.setDaemon(true);
+            handler.start();
+        }
+    }
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The benchmark used to calibrate the speed of the local machine against the online judges.
+ * It's compiled with the C++ compile command by Extensions::JudgeCalibration, and the same source can be run on the
+ * custom invocation of a judge to get the score of the judge.
+ * Each kernel is a typical workload of competitive programming, and the score is the total time in milliseconds.
+ * It must be portable: only the standard library is used, and it reads nothing from the input.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <numeric>
+#include <vector>
+
+static std::uint64_t checksum = 0;
+
+// integer arithmetic and division, bound by the latency of the ALU
+static void arithmetic()
+{
+    std::uint64_t x = 1;
+    for (std::uint32_t i = 1; i <= 50000000; ++i)
+        x = (x * 6364136223846793005ULL + i) % 1000000007ULL;
+    checksum += x;
+}
+
+// the sieve of Eratosthenes, bound by the sequential memory bandwidth
+static void sieve()
+{
+    const int n = 30000000;
+    std::vector<bool> composite(n + 1);
+    int count = 0;
+    for (int i = 2; i <= n; ++i)
+    {
+        if (composite[i])
+            continue;
+        ++count;
+        for (long long j = 1LL * i * i; j <= n; j += i)
+            composite[j] = true;
+    }
+    checksum += count;
+}
+
+// a random cyclic permutation walked by pointer chasing, bound by the latency of the memory
+static void randomAccess()
+{
+    const int n = 1 << 22;
+    std::vector<int> next(n);
+    std::iota(next.begin(), next.end(), 0);
+    std::uint64_t seed = 88172645463325252ULL;
+    for (int i = n - 1; i > 0; --i) // Sattolo's algorithm, so that the walk visits every element
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        std::swap(next[i], next[seed % i]);
+    }
+    int position = 0;
+    for (int i = 0; i < n; ++i)
+        position = next[position];
+    checksum += position;
+}
+
+// sorting random integers, bound by branches and the cache
+static void sorting()
+{
+    const int n = 3000000;
+    std::vector<std::uint32_t> values(n);
+    std::uint32_t seed = 2463534242U;
+    for (auto &value : values)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        value = seed;
+    }
+    std::sort(values.begin(), values.end());
+    checksum += values[n / 2];
+}
+
+// floating-point matrix multiplication, bound by the floating-point units
+static void matrix()
+{
+    const int n = 512;
+    std::vector<double> a(n * n), b(n * n), c(n * n);
+    for (int i = 0; i < n * n; ++i)
+    {
+        a[i] = (i % 7) * 0.5;
+        b[i] = (i % 11) * 0.25;
+    }
+    for (int i = 0; i < n; ++i)
+        for (int k = 0; k < n; ++k)
+            for (int j = 0; j < n; ++j)
+                c[i * n + j] += a[i * n + k] * b[k * n + j];
+    checksum += static_cast<std::uint64_t>(c[n * n / 2]);
+}
+
+// balanced binary search tree operations, bound by the allocator and the cache
+static void tree()
+{
+    std::map<int, int> values;
+    std::uint32_t seed = 123456789U;
+    for (int i = 0; i < 500000; ++i)
+    {
+        seed = seed * 1103515245U + 12345U;
+        values[seed >> 8] += i;
+    }
+    for (const auto &value : values)
+        checksum += value.second;
+}
+
+int main()
+{
+    struct Kernel
+    {
+        const char *name;
+        void (*run)();
+    };
+    const Kernel kernels[] = {{"arithmetic", arithmetic}, {"sieve", sieve},   {"random-access", randomAccess},
+                              {"sorting", sorting},       {"matrix", matrix}, {"tree", tree}};
+
+    long long total = 0;
+    for (const auto &kernel : kernels)
+    {
+        auto start = std::chrono::steady_clock::now();
+        kernel.run();
+        auto time =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        total += time;
+        std::printf("%s %lld\n", kernel.name, static_cast<long long>(time));
+    }
+    std::printf("total %lld\n", total);
+    std::fprintf(stderr, "checksum %llu\n", static_cast<unsigned long long>(checksum));
+    return 0;
+}
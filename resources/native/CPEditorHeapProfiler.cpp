@@ -0,0 +1,392 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The allocation recorder used by the heap profiling run mode.
+ * It's compiled into a shared library by Extensions::HeapProfiler, and preloaded into the program by LD_PRELOAD.
+ * It interposes the malloc family, counts the allocations, the bytes and the peak live heap, and records the call
+ * stack of each allocation. When the program exits, the report is written as JSON to $CPEDITOR_HEAP_PROFILE.
+ *
+ * It must not allocate by itself: the real functions are found by dlsym, the calls made during dlsym are served
+ * from a static buffer, and the calls made inside the recorder (e.g. by backtrace) are not recorded.
+ * Programs killed by a signal (e.g. TLE) or linked statically produce no report.
+ */
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <elf.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <link.h>
+#include <malloc.h>
+#include <sys/auxv.h>
+#include <unistd.h>
+
+namespace
+{
+typedef void *(*MallocFunction)(size_t);
+typedef void (*FreeFunction)(void *);
+typedef void *(*CallocFunction)(size_t, size_t);
+typedef void *(*ReallocFunction)(void *, size_t);
+typedef void *(*MemalignFunction)(size_t, size_t);
+typedef int (*PosixMemalignFunction)(void **, size_t, size_t);
+
+MallocFunction realMalloc = nullptr;
+FreeFunction realFree = nullptr;
+CallocFunction realCalloc = nullptr;
+ReallocFunction realRealloc = nullptr;
+MemalignFunction realMemalign = nullptr;
+MemalignFunction realAlignedAlloc = nullptr;
+PosixMemalignFunction realPosixMemalign = nullptr;
+
+// dlsym may call calloc before the real functions are known
+char bootstrapBuffer[8192];
+size_t bootstrapUsed = 0;
+bool initializing = false;
+
+// the calls made by the recorder itself are not recorded
+__thread bool insideRecorder __attribute__((tls_model("initial-exec"))) = false;
+
+unsigned long long allocationCount = 0;
+unsigned long long freeCount = 0;
+unsigned long long allocatedBytes = 0;
+long long liveBytes = 0;
+long long peakBytes = 0;
+
+const int STACK_DEPTH = 10;
+const int SKIPPED_FRAMES = 2; // record() and the interposed function
+const size_t SITE_COUNT = 1 << 14;
+
+struct Site
+{
+    void *frames[STACK_DEPTH];
+    int depth;
+    unsigned long long count;
+    unsigned long long bytes;
+};
+
+Site sites[SITE_COUNT];
+volatile int sitesLock = 0;
+
+bool isBootstrapPointer(void *ptr)
+{
+    return ptr >= static_cast<void *>(bootstrapBuffer) &&
+           ptr < static_cast<void *>(bootstrapBuffer + sizeof(bootstrapBuffer));
+}
+
+void *bootstrapAlloc(size_t size)
+{
+    size = (size + 15) & ~size_t(15);
+    if (bootstrapUsed + size > sizeof(bootstrapBuffer))
+        return nullptr;
+    void *result = bootstrapBuffer + bootstrapUsed;
+    bootstrapUsed += size;
+    return result;
+}
+
+void initialize()
+{
+    if (realMalloc != nullptr || initializing)
+        return;
+    initializing = true;
+    realMalloc = reinterpret_cast<MallocFunction>(dlsym(RTLD_NEXT, "malloc"));
+    realFree = reinterpret_cast<FreeFunction>(dlsym(RTLD_NEXT, "free"));
+    realCalloc = reinterpret_cast<CallocFunction>(dlsym(RTLD_NEXT, "calloc"));
+    realRealloc = reinterpret_cast<ReallocFunction>(dlsym(RTLD_NEXT, "realloc"));
+    realMemalign = reinterpret_cast<MemalignFunction>(dlsym(RTLD_NEXT, "memalign"));
+    realAlignedAlloc = reinterpret_cast<MemalignFunction>(dlsym(RTLD_NEXT, "aligned_alloc"));
+    realPosixMemalign = reinterpret_cast<PosixMemalignFunction>(dlsym(RTLD_NEXT, "posix_memalign"));
+    initializing = false;
+}
+
+void updateLive(long long delta)
+{
+    long long live = __atomic_add_fetch(&liveBytes, delta, __ATOMIC_RELAXED);
+    long long peak = __atomic_load_n(&peakBytes, __ATOMIC_RELAXED);
+    while (live > peak && !__atomic_compare_exchange_n(&peakBytes, &peak, live, true, __ATOMIC_RELAXED,
+                                                       __ATOMIC_RELAXED))
+    {
+    }
+}
+
+__attribute__((noinline)) void record(void *ptr, size_t size)
+{
+    if (ptr == nullptr || insideRecorder)
+        return;
+    insideRecorder = true;
+
+    __atomic_add_fetch(&allocationCount, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&allocatedBytes, size, __ATOMIC_RELAXED);
+    updateLive(static_cast<long long>(malloc_usable_size(ptr)));
+
+    void *frames[STACK_DEPTH + SKIPPED_FRAMES];
+    int depth = backtrace(frames, STACK_DEPTH + SKIPPED_FRAMES) - SKIPPED_FRAMES;
+    if (depth > 0)
+    {
+        size_t hash = 0;
+        for (int i = 0; i < depth; ++i)
+            hash = hash * 1000003 ^ reinterpret_cast<size_t>(frames[i + SKIPPED_FRAMES]);
+
+        while (__atomic_test_and_set(&sitesLock, __ATOMIC_ACQUIRE))
+        {
+        }
+        // open addressing, the allocations from new call stacks are dropped when the table is full
+        for (size_t probe = 0; probe < SITE_COUNT; ++probe)
+        {
+            Site &site = sites[(hash + probe) & (SITE_COUNT - 1)];
+            if (site.depth == 0)
+            {
+                site.depth = depth;
+                std::memcpy(site.frames, frames + SKIPPED_FRAMES, sizeof(void *) * depth);
+            }
+            else if (site.depth != depth ||
+                     std::memcmp(site.frames, frames + SKIPPED_FRAMES, sizeof(void *) * depth) != 0)
+            {
+                continue;
+            }
+            ++site.count;
+            site.bytes += size;
+            break;
+        }
+        __atomic_clear(&sitesLock, __ATOMIC_RELEASE);
+    }
+
+    insideRecorder = false;
+}
+
+// usableSize is the malloc_usable_size() of the freed block, it must be read before the block is freed
+void forget(size_t usableSize)
+{
+    if (insideRecorder)
+        return;
+    __atomic_add_fetch(&freeCount, 1, __ATOMIC_RELAXED);
+    updateLive(-static_cast<long long>(usableSize));
+}
+
+size_t sortedSites[SITE_COUNT];
+
+int compareSites(const void *a, const void *b)
+{
+    auto countA = sites[*static_cast<const size_t *>(a)].count;
+    auto countB = sites[*static_cast<const size_t *>(b)].count;
+    return countA < countB ? 1 : (countA > countB ? -1 : 0);
+}
+
+char reportBuffer[1 << 18];
+size_t reportLength = 0;
+
+void append(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+void append(const char *format, ...)
+{
+    if (reportLength >= sizeof(reportBuffer))
+        return;
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(reportBuffer + reportLength, sizeof(reportBuffer) - reportLength, format, args);
+    va_end(args);
+    if (length > 0)
+        reportLength += static_cast<size_t>(length);
+}
+
+void appendJsonString(const char *text)
+{
+    append("\"");
+    for (const char *c = text; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            append("\\%c", *c);
+        else if (static_cast<unsigned char>(*c) < 0x20)
+            append("\\u%04x", *c);
+        else
+            append("%c", *c);
+    }
+    append("\"");
+}
+
+__attribute__((constructor)) void start()
+{
+    initialize();
+    // backtrace loads libgcc_s on the first call, which allocates
+    insideRecorder = true;
+    void *frames[1];
+    backtrace(frames, 1);
+    insideRecorder = false;
+}
+
+__attribute__((destructor)) void finish()
+{
+    const char *path = getenv("CPEDITOR_HEAP_PROFILE");
+    if (path == nullptr)
+        return;
+    insideRecorder = true;
+
+    // only the frames in the executable can be mapped to the source file, the others are left out
+    // the entry point is in the executable, it tells the base address of the executable
+    Dl_info executableInfo;
+    if (dladdr(reinterpret_cast<void *>(getauxval(AT_ENTRY)), &executableInfo) == 0)
+        return;
+    void *executableBase = executableInfo.dli_fbase;
+
+    char executable[4096];
+    ssize_t executableLength = readlink("/proc/self/exe", executable, sizeof(executable) - 1);
+    executable[executableLength > 0 ? executableLength : 0] = '\0';
+
+    size_t siteCount = 0;
+    for (size_t i = 0; i < SITE_COUNT; ++i)
+    {
+        if (sites[i].depth > 0)
+            sortedSites[siteCount++] = i;
+    }
+    qsort(sortedSites, siteCount, sizeof(size_t), compareSites);
+
+    append("{\"executable\":");
+    appendJsonString(executable);
+    append(",\"allocations\":%llu,\"frees\":%llu,\"bytes\":%llu,\"peak\":%lld,\"sites\":[", allocationCount,
+           freeCount, allocatedBytes, peakBytes);
+
+    bool firstSite = true;
+    for (size_t i = 0; i < siteCount; ++i)
+    {
+        const Site &site = sites[sortedSites[i]];
+        // the most frequent call stacks, and the ones allocating at least 1% of the bytes
+        if (i >= 200 && site.bytes * 100 < allocatedBytes)
+            continue;
+        bool firstFrame = true;
+        for (int j = 0; j < site.depth; ++j)
+        {
+            Dl_info info;
+            if (dladdr(site.frames[j], &info) == 0 || info.dli_fbase != executableBase)
+                continue;
+            // a return address points to the instruction after the call
+            auto pc = reinterpret_cast<size_t>(site.frames[j]) - 1;
+            // addr2line accepts the offsets in position independent executables, and the absolute addresses otherwise
+            auto header = static_cast<const ElfW(Ehdr) *>(info.dli_fbase);
+            auto address = header->e_type == ET_EXEC ? pc : pc - reinterpret_cast<size_t>(info.dli_fbase);
+            if (firstFrame)
+                append("%s{\"count\":%llu,\"bytes\":%llu,\"frames\":[", firstSite ? "" : ",", site.count,
+                       site.bytes);
+            append("%s\"0x%zx\"", firstFrame ? "" : ",", address);
+            firstFrame = false;
+            firstSite = false;
+        }
+        if (!firstFrame)
+            append("]}");
+    }
+    append("]}\n");
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd != -1)
+    {
+        size_t written = 0;
+        while (written < reportLength)
+        {
+            ssize_t length = write(fd, reportBuffer + written, reportLength - written);
+            if (length <= 0)
+                break;
+            written += static_cast<size_t>(length);
+        }
+        close(fd);
+    }
+}
+} // namespace
+
+extern "C"
+{
+    void *malloc(size_t size)
+    {
+        initialize();
+        if (realMalloc == nullptr)
+            return bootstrapAlloc(size);
+        void *ptr = realMalloc(size);
+        record(ptr, size);
+        return ptr;
+    }
+
+    void free(void *ptr)
+    {
+        if (ptr == nullptr || isBootstrapPointer(ptr))
+            return;
+        initialize();
+        forget(malloc_usable_size(ptr));
+        realFree(ptr);
+    }
+
+    void *calloc(size_t count, size_t size)
+    {
+        initialize();
+        if (realCalloc == nullptr)
+            return bootstrapAlloc(count * size); // the static buffer is zero-initialized
+        void *ptr = realCalloc(count, size);
+        record(ptr, count * size);
+        return ptr;
+    }
+
+    void *realloc(void *ptr, size_t size)
+    {
+        initialize();
+        if (isBootstrapPointer(ptr))
+        {
+            void *result = malloc(size);
+            if (result != nullptr)
+            {
+                // the size of the old block is unknown, but it can't go beyond the used part of the buffer
+                size_t available = static_cast<size_t>(bootstrapBuffer + bootstrapUsed - static_cast<char *>(ptr));
+                std::memcpy(result, ptr, size < available ? size : available);
+            }
+            return result;
+        }
+        if (realRealloc == nullptr)
+            return bootstrapAlloc(size);
+        size_t oldSize = ptr == nullptr ? 0 : malloc_usable_size(ptr);
+        void *result = realRealloc(ptr, size);
+        // the old block is kept if it fails, and it's freed without a new block by realloc(ptr, 0) in glibc
+        if (ptr != nullptr && (result != nullptr || size == 0))
+            forget(oldSize);
+        record(result, size);
+        return result;
+    }
+
+    void *memalign(size_t alignment, size_t size)
+    {
+        initialize();
+        void *ptr = realMemalign(alignment, size);
+        record(ptr, size);
+        return ptr;
+    }
+
+    void *aligned_alloc(size_t alignment, size_t size)
+    {
+        initialize();
+        void *ptr = realAlignedAlloc(alignment, size);
+        record(ptr, size);
+        return ptr;
+    }
+
+    int posix_memalign(void **ptr, size_t alignment, size_t size)
+    {
+        initialize();
+        int result = realPosixMemalign(ptr, alignment, size);
+        if (result == 0)
+            record(*ptr, size);
+        return result;
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The reference program used by Extensions::ToolchainProbe to compare the compilers and the linkers.
+ * It uses the parts of the standard library which are common in competitive programming, so its compile time and
+ * link time are typical for a solution, and its output is used to check that a toolchain builds it correctly.
+ * It must be portable: only the standard library is used.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+template <typename T> struct SegmentTree
+{
+    int n;
+    std::vector<T> tree;
+
+    explicit SegmentTree(int size) : n(size), tree(2 * size)
+    {
+    }
+
+    void update(int pos, T value)
+    {
+        for (tree[pos += n] = value; pos > 1; pos >>= 1)
+            tree[pos >> 1] = tree[pos] + tree[pos ^ 1];
+    }
+
+    T query(int l, int r) const
+    {
+        T result{};
+        for (l += n, r += n; l < r; l >>= 1, r >>= 1)
+        {
+            if (l & 1)
+                result = result + tree[l++];
+            if (r & 1)
+                result = result + tree[--r];
+        }
+        return result;
+    }
+};
+
+int main()
+{
+    int n = 1000;
+    std::cin >> n;
+
+    std::vector<std::int64_t> values(n);
+    std::uint64_t seed = 12345;
+    for (auto &value : values)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        value = std::int64_t(seed >> 40) % 1000;
+    }
+
+    std::vector<std::int64_t> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    SegmentTree<std::int64_t> tree(n);
+    for (int i = 0; i < n; ++i)
+        tree.update(i, values[i]);
+
+    std::map<std::int64_t, int> counts;
+    std::unordered_map<std::int64_t, int> lastSeen;
+    std::set<std::int64_t> distinct;
+    std::priority_queue<std::int64_t> heap;
+    for (int i = 0; i < n; ++i)
+    {
+        ++counts[values[i]];
+        lastSeen[values[i]] = i;
+        distinct.insert(values[i]);
+        heap.push(values[i]);
+    }
+
+    std::ostringstream out;
+    out << std::accumulate(values.begin(), values.end(), std::int64_t(0)) << ' ' << sorted[n / 2] << ' '
+        << tree.query(n / 4, n / 2) << ' ' << counts.size() << ' ' << lastSeen.size() << ' ' << distinct.size()
+        << ' ' << heap.top() << '\n';
+    std::cout << out.str();
+
+    return 0;
+}
@@ -53,6 +53,7 @@ Checker::~Checker()
 void Checker::prepare(const QString &compileCommand)
 {
     clearTasks();
+    failReason.clear();
 
     if (!compiled)
     {
@@ -94,27 +95,37 @@ void Checker::prepare(const QString &compileCommand)
         // get the code of the checker
         QString checkerCode = Util::readFile(checkerResource, tr("Read Checker"), log);
         if (checkerCode.isNull())
+        {
+            fail(tr("Failed to read the checker %1").arg(checkerResource));
             return;
+        }
 
         // create a temporary directory
         tmpDir = new QTemporaryDir();
         if (!tmpDir->isValid())
         {
-            log->error(tr("Checker"), tr("Failed to create temporary directory"));
+            if (log != nullptr)
+                log->error(tr("Checker"), tr("Failed to create temporary directory"));
+            fail(tr("Failed to create temporary directory"));
             return;
         }
 
         // save the checker source file on the disk
         checkerPath = tmpDir->filePath("checker.cpp");
         if (!Util::saveFile(checkerPath, checkerCode, tr("Checker"), false, log))
+        {
+            fail(tr("Failed to save the checker to %1").arg(checkerPath));
             return;
+        }
 
         // save testlib.h on the disk
         auto testlib_h = Util::readFile(":/testlib/testlib.h", tr("Read testlib.h"), log);
-        if (testlib_h.isNull())
-            return;
-        if (!Util::saveFile(tmpDir->filePath("testlib.h"), testlib_h, tr("Save testlib.h"), false, log))
+        if (testlib_h.isNull() ||
+            !Util::saveFile(tmpDir->filePath("testlib.h"), testlib_h, tr("Save testlib.h"), false, log))
+        {
+            fail(tr("Failed to save testlib.h"));
             return;
+        }
 
         // start the compilation of the checker
         delete compiler;
@@ -131,7 +142,9 @@ void Checker::prepare(const QString &compileCommand)
 void Checker::reqeustCheck(int index, const QString &input, const QString &output, const QString &expected)
 {
     LOG_INFO(BOOL_INFO_OF(compiled));
-    if (compiled)
+    if (!failReason.isEmpty())
+        emit checkFailed(index, failReason); // the checker will never be ready
+    else if (compiled)
         check(index, input, output, expected); // check immediately if the checker is compiled
     else
         pendingTasks.push_back({index, input, output, expected}); // otherwise push it into the pending tasks list
@@ -139,7 +152,8 @@ void Checker::reqeustCheck(int index, const QString &input, const QString &outpu
 
 void Checker::onCompilationStarted()
 {
-    log->info(tr("Checker"), tr("Started compiling the checker"));
+    if (log != nullptr)
+        log->info(tr("Checker"), tr("Started compiling the checker"));
 }
 
 void Checker::clearTasks()
@@ -153,7 +167,7 @@ void Checker::clearTasks()
 void Checker::onCompilationFinished()
 {
     compiled = true; // mark that the checker is compiled
-    if (checkerType >= Ncmp)
+    if (checkerType >= Ncmp && log != nullptr)
         log->info(tr("Checker"), tr("The checker is compiled"));
     for (auto const &t : pendingTasks)
         check(t.index, t.input, t.output, t.expected); // solve the pending tasks
@@ -162,12 +176,16 @@ void Checker::onCompilationFinished()
 
 void Checker::onCompilationErrorOccurred(const QString &error)
 {
-    log->error(tr("Checker"), tr("Error occurred while compiling the checker:\n%1").arg(error));
+    if (log != nullptr)
+        log->error(tr("Checker"), tr("Error occurred while compiling the checker:\n%1").arg(error));
+    fail(tr("Error occurred while compiling the checker:\n%1").arg(error));
 }
 
 void Checker::onCompilationFailed(const QString &reason)
 {
-    log->error(tr("Checker"), tr("Failed to compile the checker: %1").arg(reason), false);
+    if (log != nullptr)
+        log->error(tr("Checker"), tr("Failed to compile the checker: %1").arg(reason), false);
+    fail(tr("Failed to compile the checker: %1").arg(reason));
 }
 
 void Checker::onCompilationKilled()
@@ -181,13 +199,13 @@ void Checker::onCompilationKilled()
 void Checker::onRunFinished(int index, const QString & /*unused*/, const QString &err, int exitCode, int /*unused*/,
                             bool tle)
 {
-    if (tle)
+    if (tle && log != nullptr)
         log->warn(head(index), tr("Time Limit Exceeded"));
 
     switch (TResult(exitCode))
     {
     case _ok:
-        if (!err.isEmpty())
+        if (!err.isEmpty() && log != nullptr)
             log->message(head(index), err, "green");
         emit checkFinished(index, Widgets::TestCase::AC);
         return;
@@ -199,10 +217,8 @@ void Checker::onRunFinished(int index, const QString & /*unused*/, const QString
     case _points:
     case _unexpected_eof:
     case _partially:
-        if (err.isEmpty())
-            log->error(head(index), tr("Checker exited with exit code %1").arg(exitCode));
-        else
-            log->error(head(index), err);
+        if (log != nullptr)
+            log->error(head(index), err.isEmpty() ? tr("Checker exited with exit code %1").arg(exitCode) : err);
         emit checkFinished(index, Widgets::TestCase::WA);
         return;
 
@@ -211,18 +227,26 @@ void Checker::onRunFinished(int index, const QString & /*unused*/, const QString
     }
 
     // This exit code is not one of the normal exit codes of a testlib checker, maybe the checker crashed
-    log->error(head(index), tr("Checker exited with unknown exit code %1").arg(exitCode));
-    if (!err.isEmpty())
-        log->error(head(index), err);
+    if (log != nullptr)
+    {
+        log->error(head(index), tr("Checker exited with unknown exit code %1").arg(exitCode));
+        if (!err.isEmpty())
+            log->error(head(index), err);
+    }
+    emit checkFailed(index, tr("Checker exited with unknown exit code %1").arg(exitCode));
 }
 
 void Checker::onFailedToStartRun(int index, const QString &error)
 {
-    log->error(head(index), error, false);
+    if (log != nullptr)
+        log->error(head(index), error, false);
+    emit checkFailed(index, error);
 }
 
 void Checker::onRunOutputLimitExceeded(int index, const QString &type)
 {
+    if (log == nullptr)
+        return;
     log->warn(
         head(index),
         tr("The %1 of the process running on the testcase #%2 contains more than %3 characters, which is longer "
@@ -236,7 +260,17 @@ void Checker::onRunOutputLimitExceeded(int index, const QString &type)
 
 void Checker::onRunKilled(int index)
 {
-    log->error(head(index), tr("The checker is killed"));
+    if (log != nullptr)
+        log->error(head(index), tr("The checker is killed"));
+}
+
+void Checker::fail(const QString &reason)
+{
+    LOG_WARN(INFO_OF(reason));
+    failReason = reason;
+    for (auto const &t : pendingTasks)
+        emit checkFailed(t.index, reason);
+    pendingTasks.clear();
 }
 
 bool Checker::checkIgnoreTrailingSpaces(const QString &output, const QString &expected)
@@ -289,6 +323,19 @@ bool Checker::checkStrict(const QString &output, const QString &expected)
     return a.replace("\r\n", "\n").replace("\r", "\n") == b.replace("\r\n", "\n").replace("\r", "\n");
 }
 
+Widgets::TestCase::Verdict Checker::checkBuiltIn(CheckerType type, const QString &output, const QString &expected)
+{
+    switch (type)
+    {
+    case IgnoreTrailingSpaces:
+        return checkIgnoreTrailingSpaces(output, expected) ? Widgets::TestCase::AC : Widgets::TestCase::WA;
+    case Strict:
+        return checkStrict(output, expected) ? Widgets::TestCase::AC : Widgets::TestCase::WA;
+    default:
+        return Widgets::TestCase::UNKNOWN;
+    }
+}
+
 void Checker::check(int index, const QString &input, const QString &output, const QString &expected)
 {
     LOG_INFO(INFO_OF(index));
@@ -296,20 +343,21 @@ void Checker::check(int index, const QString &input, const QString &output, cons
     {
     // check directly if it's a built-in checker
     case IgnoreTrailingSpaces:
-        emit checkFinished(index,
-                           checkIgnoreTrailingSpaces(output, expected) ? Widgets::TestCase::AC : Widgets::TestCase::WA);
-        break;
     case Strict:
-        emit checkFinished(index, checkStrict(output, expected) ? Widgets::TestCase::AC : Widgets::TestCase::WA);
+        emit checkFinished(index, checkBuiltIn(checkerType, output, expected));
         break;
     default:
         // if it's a testlib checker, save the input, output and expected files first
         auto inputPath = tmpDir->filePath(QString::number(index) + ".in");
         auto outputPath = tmpDir->filePath(QString::number(index) + ".out");
         auto expectedPath = tmpDir->filePath(QString::number(index) + ".ans");
-        if (Util::saveFile(inputPath, input, tr("Checker"), false, log) &&
-            Util::saveFile(outputPath, output, tr("Checker"), false, log) &&
-            Util::saveFile(expectedPath, expected, tr("Checker"), false, log))
+        if (!Util::saveFile(inputPath, input, tr("Checker"), false, log) ||
+            !Util::saveFile(outputPath, output, tr("Checker"), false, log) ||
+            !Util::saveFile(expectedPath, expected, tr("Checker"), false, log))
+        {
+            emit checkFailed(index, tr("Failed to save the files for the checker"));
+        }
+        else
         {
             // if files are successfully saved, run the checker
             auto *tmp = new Runner(index);
@@ -65,7 +65,7 @@ class Checker : public QObject
     /**
      * @brief construct a checker
      * @param type the type of the checker
-     * @param logger the message logger that receives the messages
+     * @param logger the message logger that receives the messages, it can be nullptr, e.g. in the headless judge
      * @param parent the parent of a QObject
      * @note Don't construct a custom checker by this.
      */
@@ -74,7 +74,7 @@ class Checker : public QObject
     /**
      * @brief construct a custom checker
      * @param path the file path to the custom checker
-     * @param logger the message logger that receives the messages
+     * @param logger the message logger that receives the messages, it can be nullptr
      * @param parent the parent of a QObject
      */
     Checker(const QString &path, MessageLogger *logger, QObject *parent = nullptr);
@@ -108,6 +108,16 @@ class Checker : public QObject
      */
     void clearTasks();
 
+    /**
+     * @brief check an output by a built-in checker, without constructing a checker
+     * @param type the type of the checker
+     * @param output the output to check
+     * @param expected the expected output of the testcase
+     * @returns AC or WA, UNKNOWN if the type is not a built-in checker
+     * @note it's used by Extensions::JudgeService to check the outputs in the service process
+     */
+    static Widgets::TestCase::Verdict checkBuiltIn(CheckerType type, const QString &output, const QString &expected);
+
   signals:
     /**
      * @brief return the check result
@@ -116,6 +126,14 @@ class Checker : public QObject
      */
     void checkFinished(int index, Widgets::TestCase::Verdict verdict);
 
+    /**
+     * @brief the checker can't give a verdict, e.g. it failed to compile or it crashed
+     * @param index the index of the testcase
+     * @param reason the reason of the failure
+     * @note checkFinished won't be emitted for this testcase
+     */
+    void checkFailed(int index, const QString &reason);
+
   private slots:
     void onCompilationStarted();
 
@@ -167,6 +185,11 @@ class Checker : public QObject
      */
     static QString head(int index);
 
+    /**
+     * @brief mark the checker as failed, the pending and the future tasks are failed with the reason
+     */
+    void fail(const QString &reason);
+
     // a struct with the info of a testcase, or called a check task, used to save check requests
     struct Task
     {
@@ -197,6 +220,7 @@ class Checker : public QObject
     QVector<Task> pendingTasks;      // the unsolved check requests
     bool compiled = false;           // whether the testlib checker is compiled or not
                                      // It should be true for built-in checkers.
+    QString failReason;              // the reason why the checker can't be prepared, empty if it's not failed
 };
 
 } // namespace Core
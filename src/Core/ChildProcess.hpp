@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The ChildProcess is the interface of the process launchers used by Core::Runner.
+ * The functions and the signals are the same as the corresponding ones in QProcess,
+ * so the Runner works in the same way no matter which launcher is used.
+ * Core::QtChildProcess is based on QProcess and works on all platforms,
+ * Core::SpawnChildProcess is a low-overhead launcher on Linux.
+ */
+
+#ifndef CHILDPROCESS_HPP
+#define CHILDPROCESS_HPP
+
+#include <QProcess>
+
+namespace Core
+{
+class ChildProcess : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit ChildProcess(QObject *parent = nullptr);
+
+    /**
+     * @brief start a program
+     * @param program the name or the path of the program
+     * @param arguments the command line arguments
+     * @note This should be called only once. Either started or errorOccurred(FailedToStart) will be emitted.
+     */
+    virtual void start(const QString &program, const QStringList &arguments) = 0;
+
+    /**
+     * @brief set the working directory of the program, it should be called before start()
+     */
+    virtual void setWorkingDirectory(const QString &dir) = 0;
+
+    /**
+     * @brief set the environment variables of the program, it should be called before start()
+     * @note the environment of CP Editor is used if it's not called
+     */
+    virtual void setProcessEnvironment(const QProcessEnvironment &environment) = 0;
+
+    /**
+     * @brief write data to the stdin of the program
+     * @returns the number of bytes queued, or -1 if the write channel is closed
+     */
+    virtual qint64 write(const QByteArray &data) = 0;
+
+    /**
+     * @brief close the stdin of the program after all data written
+     */
+    virtual void closeWriteChannel() = 0;
+
+    /**
+     * @brief the number of bytes waiting to be written to the stdin of the program
+     */
+    virtual qint64 bytesToWrite() const = 0;
+
+    /**
+     * @brief read all available data in stdout
+     */
+    virtual QByteArray readAllStandardOutput() = 0;
+
+    /**
+     * @brief read all available data in stderr
+     */
+    virtual QByteArray readAllStandardError() = 0;
+
+    /**
+     * @brief the state of the process, the same as QProcess::state()
+     */
+    virtual QProcess::ProcessState state() const = 0;
+
+    /**
+     * @brief the native process ID of the running program, or 0 if it's not running
+     */
+    virtual qint64 processId() const = 0;
+
+    /**
+     * @brief kill the program immediately
+     */
+    virtual void kill() = 0;
+
+  signals:
+    void started();
+
+    /**
+     * @brief the program exits
+     * @param exitTime when the exit is noticed, in QElapsedTimer::msecsSinceReference(), the signal may arrive later
+     */
+    void finished(int exitCode, QProcess::ExitStatus exitStatus, qint64 exitTime);
+
+    void readyReadStandardOutput();
+
+    void readyReadStandardError();
+
+    void errorOccurred(QProcess::ProcessError error);
+};
+} // namespace Core
+
+#endif // CHILDPROCESS_HPP
@@ -17,11 +17,15 @@
 
 #include "Core/Compiler.hpp"
 #include "Core/EventLogger.hpp"
+#include "Extensions/JavaRunServer.hpp"
 #include "Settings/SettingsManager.hpp"
 #include "Util/FileUtil.hpp"
 #include "generated/SettingsHelper.hpp"
+#include <QDataStream>
 #include <QDir>
 #include <QFileInfo>
+#include <QHostAddress>
+#include <QTcpSocket>
 #include <QTextCodec>
 
 namespace Core
@@ -31,7 +35,7 @@ Compiler::Compiler()
 {
     // create compiliation process and connect signals
     compileProcess = new QProcess();
-    connect(compileProcess, &QProcess::started, this, &Compiler::compilationStarted);
+    connect(compileProcess, &QProcess::started, this, &Compiler::onProcessStarted);
     connect(compileProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
             &Compiler::onProcessFinished);
     connect(compileProcess, &QProcess::errorOccurred, this, &Compiler::onProcessErrorOccurred);
@@ -39,6 +43,14 @@ Compiler::Compiler()
 
 Compiler::~Compiler()
 {
+    if (javaServerSocket != nullptr)
+    {
+        LOG_WARN("Compilation on the Java run server was running and is being abandoned");
+        javaServerSocket->disconnect(this);
+        delete javaServerSocket;
+        emit compilationKilled();
+    }
+
     if (compileProcess != nullptr)
     {
         if (compileProcess->state() != QProcess::NotRunning)
@@ -56,6 +68,7 @@ void Compiler::start(const QString &tmpFilePath, const QString &sourceFilePath,
                      const QString &lang)
 {
     this->lang = lang;
+    compilationStartedEmitted = false;
     if (!QFile::exists(tmpFilePath))
     {
         // quit with error if the source file is not found
@@ -102,6 +115,19 @@ void Compiler::start(const QString &tmpFilePath, const QString &sourceFilePath,
     compileProcess->setWorkingDirectory(
         QFileInfo(QFile::exists(sourceFilePath) ? sourceFilePath : tmpFilePath).canonicalPath());
 
+    // only javac is replaced by the server, other compilers like ecj are started as usual
+    if (lang == "Java" && SettingsHelper::isJavaRunServerCompile() && QFileInfo(program).completeBaseName() == "javac")
+    {
+        auto *server = Extensions::JavaRunServer::instance();
+        if (server->isReady())
+        {
+            compileOnJavaServer(program, args);
+            return;
+        }
+        // the server is started asynchronously for the next compilations, this compilation uses javac
+        server->start(SettingsHelper::getJavaCompileCommand(), SettingsHelper::getJavaRunCommand());
+    }
+
     compileProcess->start(program, args);
 }
 
@@ -146,15 +172,7 @@ QString Compiler::outputFilePath(const QString &tmpFilePath, const QString &sour
 
 void Compiler::onProcessFinished(int exitCode, QProcess::ExitStatus e)
 {
-    QString codecName = "UTF-8";
-    if (lang == "C++")
-        codecName = SettingsHelper::getCppCompilerOutputCodec();
-    else if (lang == "Java")
-        codecName = SettingsHelper::getJavaCompilerOutputCodec();
-    QTextCodec *codec = QTextCodec::codecForName(codecName.toUtf8());
-    if (!codec)
-        codec = QTextCodec::codecForName("UTF-8");
-    QString output = codec->toUnicode(compileProcess->readAllStandardError());
+    QString output = decodeOutput(compileProcess->readAllStandardError());
     // emit different signals due to different exit codes
     if (exitCode == 0)
         emit compilationFinished(output);
@@ -173,4 +191,114 @@ void Compiler::onProcessErrorOccurred(QProcess::ProcessError error)
     }
 }
 
+void Compiler::onProcessStarted()
+{
+    if (!compilationStartedEmitted)
+    {
+        compilationStartedEmitted = true;
+        emit compilationStarted();
+    }
+}
+
+void Compiler::onJavaRunServerConnected()
+{
+    javaServerSocket->write(javaServerRequest);
+    onProcessStarted();
+}
+
+void Compiler::onJavaRunServerReadyRead()
+{
+    QDataStream response(javaServerSocket);
+    response.setVersion(QDataStream::Qt_5_0);
+
+    qint32 status = 0;
+    qint32 exitCode = 0;
+    qint64 compileTime = 0;
+    QByteArray diagnostics;
+
+    response.startTransaction();
+    response >> status >> exitCode >> compileTime >> diagnostics;
+    if (!response.commitTransaction())
+        return; // wait for the rest of the response
+
+    LOG_INFO(INFO_OF(status) << INFO_OF(exitCode) << INFO_OF(compileTime));
+
+    if (status != Extensions::JavaRunServer::Finished)
+    {
+        // e.g. the server is running on a JRE, which doesn't have a compiler
+        onJavaRunServerDisconnected();
+        return;
+    }
+
+    javaServerSocket->disconnect(this);
+    javaServerSocket->deleteLater();
+    javaServerSocket = nullptr;
+
+    QString output = decodeOutput(diagnostics);
+    if (exitCode == 0)
+        emit compilationFinished(output);
+    else
+        emit compilationErrorOccurred(output);
+}
+
+void Compiler::onJavaRunServerDisconnected()
+{
+    LOG_WARN("Failed to compile on the Java run server, falling back to javac. "
+             << INFO_OF(javaServerSocket->errorString()));
+
+    javaServerSocket->disconnect(this);
+    javaServerSocket->deleteLater();
+    javaServerSocket = nullptr;
+
+    compileProcess->start(javaFallbackProgram, javaFallbackArguments);
+}
+
+void Compiler::compileOnJavaServer(const QString &program, const QStringList &args)
+{
+    LOG_INFO("Compiling on the Java run server");
+
+    javaFallbackProgram = program;
+    javaFallbackArguments = args;
+
+    // the server doesn't share the working directory of compileProcess, so the paths are made absolute
+    QStringList arguments;
+    for (const auto &arg : args)
+    {
+        if (!arg.startsWith('-') && QFileInfo(QDir(compileProcess->workingDirectory()), arg).exists())
+            arguments.push_back(QFileInfo(QDir(compileProcess->workingDirectory()), arg).absoluteFilePath());
+        else
+            arguments.push_back(arg);
+    }
+
+    // the protocol is described in resources/java/CPEditorRunServer.java
+    QDataStream request(&javaServerRequest, QIODevice::WriteOnly);
+    request.setVersion(QDataStream::Qt_5_0);
+    request << qint32(Extensions::JavaRunServer::CompileRequest) << qint32(arguments.length());
+    for (const auto &argument : arguments)
+        request << argument.toUtf8();
+
+    javaServerSocket = new QTcpSocket(this);
+    connect(javaServerSocket, &QTcpSocket::connected, this, &Compiler::onJavaRunServerConnected);
+    connect(javaServerSocket, &QTcpSocket::readyRead, this, &Compiler::onJavaRunServerReadyRead);
+    connect(javaServerSocket, &QTcpSocket::stateChanged, this, [this](QAbstractSocket::SocketState state) {
+        if (state == QAbstractSocket::UnconnectedState)
+            onJavaRunServerDisconnected();
+    });
+
+    javaServerSocket->connectToHost(QHostAddress::LocalHost, Extensions::JavaRunServer::instance()->port());
+}
+
+QString Compiler::decodeOutput(const QByteArray &output) const
+{
+    QString codecName = "UTF-8";
+    if (lang == "C++")
+        codecName = SettingsHelper::getCppCompilerOutputCodec();
+    else if (lang == "Java")
+        codecName = SettingsHelper::getJavaCompilerOutputCodec();
+    QTextCodec *codec = QTextCodec::codecForName(codecName.toUtf8());
+    if (!codec)
+        codec = QTextCodec::codecForName("UTF-8");
+    return codec->toUnicode(output);
+}
+
 } // namespace Core
@@ -22,6 +22,7 @@
  * The compilation process will be automatically killed when the Compiler is destructed,
  * so it's convenient to use one Compiler for one compilation.
  * When using it to "compile" Python, it will emit compilationFinished("") immediately.
+ * Java may be compiled on the Java run server instead of a new javac process, see Extensions::JavaRunServer.
  */
 
 #ifndef COMPILER_HPP
@@ -30,6 +31,8 @@
 #include <QObject>
 #include <QProcess>
 
+class QTcpSocket;
+
 namespace Core
 {
 
@@ -117,9 +120,46 @@ class Compiler : public QObject
 
     void onProcessErrorOccurred(QProcess::ProcessError error);
 
+    /**
+     * @brief the compile process or the compilation on the Java run server is started, emit compilationStarted once
+     */
+    void onProcessStarted();
+
+    /**
+     * @brief the connection to the Java run server is established, send the request
+     */
+    void onJavaRunServerConnected();
+
+    /**
+     * @brief read the response from the Java run server
+     */
+    void onJavaRunServerReadyRead();
+
+    /**
+     * @brief the connection to the Java run server is broken before the response, fall back to javac
+     */
+    void onJavaRunServerDisconnected();
+
   private:
-    QProcess *compileProcess = nullptr; // the compilation process
+    /**
+     * @brief send the compilation to the Java run server
+     * @param program the compiler, used when falling back to javac
+     * @param args the arguments of the compiler
+     */
+    void compileOnJavaServer(const QString &program, const QStringList &args);
+
+    /**
+     * @brief decode the compiler output by the codec in the settings
+     */
+    QString decodeOutput(const QByteArray &output) const;
+
+    QProcess *compileProcess = nullptr;     // the compilation process
     QString lang;
+    QTcpSocket *javaServerSocket = nullptr; // the connection to the Java run server
+    QByteArray javaServerRequest;           // the request sent to the Java run server
+    QString javaFallbackProgram;            // the compiler, used when the Java run server fails
+    QStringList javaFallbackArguments;      // the arguments of the compiler, used when the Java run server fails
+    bool compilationStartedEmitted = false; // compilationStarted is emitted once, even if it falls back to javac
 };
 
 } // namespace Core
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/CompilerDiagnostics.hpp"
+#include <QHash>
+#include <QRegularExpression>
+
+namespace Core
+{
+
+/**
+ * @brief add a child to a diagnostic, or merge it into the child with the same headline
+ * @param childIndex the indices of the children of the parent, keyed by their headlines
+ * @returns true if it's added, false if it's merged
+ */
+static bool addChild(CompilerDiagnostics::Diagnostic &parent, QHash<QString, int> &childIndex,
+                     const CompilerDiagnostics::Diagnostic &child, int *merged)
+{
+    auto key = CompilerDiagnostics::headline(child);
+    auto it = childIndex.constFind(key);
+    if (it != childIndex.constEnd())
+    {
+        parent.children[it.value()].repeats += child.repeats;
+        ++*merged;
+        return false;
+    }
+    childIndex.insert(key, parent.children.size());
+    parent.children.push_back(child);
+    return true;
+}
+
+QVector<CompilerDiagnostics::Diagnostic> CompilerDiagnostics::parse(const QString &output, int *merged)
+{
+    // "file:line:column: severity: message", the column is missing in the output of javac
+    static const QRegularExpression diagnosticRegex(
+        R"(^(.+?):(\d+):(?:(\d+):)? (fatal error|error|warning|note): (.*)$)");
+    // "tool: severity: message", like "collect2: error: ld returned 1 exit status"
+    static const QRegularExpression toolRegex(R"(^([^\s:]+): (fatal error|error|warning): (.*)$)");
+    // "file: In function ...", "file:line:column:   required from here"
+    static const QRegularExpression contextRegex(
+        R"(^(.+?):(?:(\d+):(?:(\d+):)?)? +((?:In |required |recursively required |in ).*)$)");
+    // "In file included from file:line:", "                 from file:line,"
+    static const QRegularExpression includeRegex(R"(^(In file included | +)from (.+?):(\d+)(?::(\d+))?[:,]$)");
+
+    int mergedCount = 0;
+    QVector<Diagnostic> diagnostics;
+    QHash<QString, int> indexOfKey; // the keys of the finished diagnostics
+    QVector<QHash<QString, int>> childIndices; // the child indices of the finished diagnostics, see addChild()
+    QVector<Diagnostic> pendingContext; // the context before the next error or warning
+    Diagnostic current;
+    QHash<QString, int> currentChildIndex; // the child indices of current
+    bool hasCurrent = false;
+    bool discardDetails = false; // the last note is merged, so its details are not needed
+
+    auto finishCurrent = [&] {
+        if (!hasCurrent)
+            return;
+        hasCurrent = false;
+        auto key = headline(current);
+        auto it = indexOfKey.find(key);
+        if (it == indexOfKey.end())
+        {
+            indexOfKey[key] = diagnostics.size();
+            diagnostics.push_back(current);
+            childIndices.push_back(currentChildIndex);
+            return;
+        }
+        // the same error in another instantiation of a template, only the new context and notes are kept
+        auto &existing = diagnostics[it.value()];
+        existing.repeats += current.repeats;
+        ++mergedCount;
+        for (const auto &child : current.children)
+            addChild(existing, childIndices[it.value()], child, &mergedCount);
+    };
+
+    auto lastDetails = [&]() -> QStringList & {
+        return current.children.isEmpty() ? current.details : current.children.last().details;
+    };
+
+    for (const auto &line : output.split('\n'))
+    {
+        QString text = line;
+        if (text.endsWith('\r'))
+            text.chop(1);
+        if (text.isEmpty())
+            continue;
+
+        Diagnostic diagnostic;
+        bool matched = false;
+        bool included = false; // the include stack, printed before a diagnostic in a header
+
+        // most lines are the excerpts of the code, check the cheap condition before the regular expressions
+        if (text.contains(": ") || text.contains("from "))
+        {
+            auto match = diagnosticRegex.match(text);
+            if (match.hasMatch())
+            {
+                diagnostic.file = match.captured(1);
+                diagnostic.line = match.captured(2).toInt();
+                diagnostic.column = match.captured(3).toInt();
+                auto severity = match.captured(4);
+                diagnostic.severity = severity == "note" ? Note : (severity == "warning" ? Warning : Error);
+                diagnostic.message = match.captured(5);
+                matched = true;
+            }
+            else if ((match = toolRegex.match(text)).hasMatch())
+            {
+                diagnostic.file = match.captured(1);
+                diagnostic.severity = match.captured(2) == "warning" ? Warning : Error;
+                diagnostic.message = match.captured(3);
+                matched = true;
+            }
+            else if ((match = contextRegex.match(text)).hasMatch())
+            {
+                diagnostic.file = match.captured(1);
+                diagnostic.line = match.captured(2).toInt();
+                diagnostic.column = match.captured(3).toInt();
+                diagnostic.severity = Context;
+                diagnostic.message = match.captured(4);
+                matched = true;
+            }
+            else if ((match = includeRegex.match(text)).hasMatch())
+            {
+                diagnostic.file = match.captured(2);
+                diagnostic.line = match.captured(3).toInt();
+                diagnostic.column = match.captured(4).toInt();
+                diagnostic.severity = Context;
+                diagnostic.message = QString("In file included from %1:%2").arg(diagnostic.file).arg(diagnostic.line);
+                matched = true;
+                included = true;
+            }
+        }
+
+        if (!matched)
+        {
+            if (discardDetails)
+                continue;
+            if (hasCurrent)
+                lastDetails().push_back(text);
+            else if (!pendingContext.isEmpty())
+                pendingContext.last().details.push_back(text);
+            else
+            {
+                // the lines without a location, like the errors of the linker
+                diagnostic.severity = Context;
+                diagnostic.message = text;
+                pendingContext.push_back(diagnostic);
+            }
+            continue;
+        }
+
+        if ((diagnostic.severity == Note || included) && hasCurrent)
+        {
+            // the notes of an error can be in the headers, their include stacks are kept with them
+            discardDetails = !addChild(current, currentChildIndex, diagnostic, &mergedCount);
+            continue;
+        }
+
+        discardDetails = false;
+        if (diagnostic.severity == Note || diagnostic.severity == Context)
+        {
+            // the context is printed before the error it belongs to
+            finishCurrent();
+            pendingContext.push_back(diagnostic);
+        }
+        else
+        {
+            finishCurrent();
+            current = diagnostic;
+            currentChildIndex.clear();
+            hasCurrent = true;
+            for (const auto &context : pendingContext)
+                addChild(current, currentChildIndex, context, &mergedCount);
+            pendingContext.clear();
+        }
+    }
+
+    // the context after the last error, like "compilation terminated."
+    for (const auto &context : pendingContext)
+    {
+        if (!hasCurrent && diagnostics.isEmpty())
+            break;
+        if (!hasCurrent)
+            addChild(diagnostics.last(), childIndices.last(), context, &mergedCount);
+        else
+            addChild(current, currentChildIndex, context, &mergedCount);
+    }
+    finishCurrent();
+
+    if (merged != nullptr)
+        *merged = mergedCount;
+    return diagnostics;
+}
+
+int CompilerDiagnostics::count(const QVector<Diagnostic> &diagnostics, Severity severity)
+{
+    int result = 0;
+    for (const auto &diagnostic : diagnostics)
+    {
+        if (diagnostic.severity == severity)
+            result += diagnostic.repeats;
+    }
+    return result;
+}
+
+QString CompilerDiagnostics::headline(const Diagnostic &diagnostic)
+{
+    QString location = diagnostic.file;
+    if (diagnostic.line > 0)
+        location += QString(":%1").arg(diagnostic.line);
+    if (diagnostic.column > 0)
+        location += QString(":%1").arg(diagnostic.column);
+
+    QString severity;
+    switch (diagnostic.severity)
+    {
+    case Error:
+        severity = "error: ";
+        break;
+    case Warning:
+        severity = "warning: ";
+        break;
+    case Note:
+        severity = "note: ";
+        break;
+    case Context:
+        break;
+    }
+
+    if (location.isEmpty())
+        return severity + diagnostic.message;
+    return location + ": " + severity + diagnostic.message;
+}
+
+} // namespace Core
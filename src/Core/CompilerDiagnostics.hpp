@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The CompilerDiagnostics parses the output of the compilers into a list of diagnostics.
+ * The text format of GCC, Clang and javac is supported, it's the format shown to the users by default.
+ * Each error or warning is a diagnostic, the context lines before it ("In instantiation of ...") and the notes
+ * after it are its children. The repeated diagnostics and the repeated children of a diagnostic are merged.
+ */
+
+#ifndef COMPILERDIAGNOSTICS_HPP
+#define COMPILERDIAGNOSTICS_HPP
+
+#include <QStringList>
+#include <QVector>
+
+namespace Core
+{
+class CompilerDiagnostics
+{
+  public:
+    enum Severity
+    {
+        Error,
+        Warning,
+        Note,
+        Context // the lines without a severity, like "In function 'int main()':"
+    };
+
+    struct Diagnostic
+    {
+        QString file;                 // the file in the output of the compiler, empty if there is no location
+        int line = 0;                 // 1-based, 0 if there is no line
+        int column = 0;               // 1-based, 0 if there is no column
+        Severity severity = Error;    // the severity of the diagnostic
+        QString message;              // the message after the severity
+        QStringList details;          // the lines after the message, like the excerpt of the code and the caret
+        QVector<Diagnostic> children; // the context and the notes of an error or a warning
+        int repeats = 1;              // the number of the merged diagnostics
+    };
+
+    /**
+     * @brief parse the output of a compiler
+     * @param output the stderr of the compiler
+     * @param merged returns the number of the merged repeated diagnostics and children, can be nullptr
+     * @returns the errors and the warnings in the order of the output, empty if nothing is recognized
+     */
+    static QVector<Diagnostic> parse(const QString &output, int *merged = nullptr);
+
+    /**
+     * @brief the number of diagnostics of a severity, including the merged ones
+     */
+    static int count(const QVector<Diagnostic> &diagnostics, Severity severity);
+
+    /**
+     * @brief the first line of a diagnostic in the format of the compilers, like "a.cpp:1:2: error: message"
+     */
+    static QString headline(const Diagnostic &diagnostic);
+};
+} // namespace Core
+
+#endif // COMPILERDIAGNOSTICS_HPP
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/IncrementalChecker.hpp"
+
+namespace Core
+{
+
+// remove the spaces at the end of a line
+static QString chopTrailingSpaces(QString line)
+{
+    while (!line.isEmpty() && line.back().isSpace())
+        line.chop(1);
+    return line;
+}
+
+IncrementalChecker::IncrementalChecker(Checker::CheckerType type, const QString &expected) : checkerType(type)
+{
+    auto ans = expected;
+    ans.replace("\r\n", "\n").replace("\r", "\n");
+    expectedLines = ans.split('\n');
+
+    if (checkerType == Checker::IgnoreTrailingSpaces)
+    {
+        // the same as Checker::checkIgnoreTrailingSpaces
+        while (!expectedLines.isEmpty() && expectedLines.back().trimmed().isEmpty())
+            expectedLines.pop_back();
+        for (auto &line : expectedLines)
+            line = chopTrailingSpaces(line);
+    }
+    else
+    {
+        // the last part is not followed by a line separator, so a complete line of the output never matches it
+        expectedLines.pop_back();
+    }
+}
+
+bool IncrementalChecker::isSupported(Checker::CheckerType type)
+{
+    return type == Checker::IgnoreTrailingSpaces || type == Checker::Strict;
+}
+
+bool IncrementalChecker::feed(const QString &chunk)
+{
+    if (mismatched)
+        return false;
+
+    pending.append(chunk);
+
+    // a '\r' at the end may be a part of "\r\n", so it's checked after the next '\n' arrives
+    int end = pending.lastIndexOf('\n');
+    if (end == -1)
+        return true;
+
+    auto text = pending.left(end + 1);
+    pending.remove(0, end + 1);
+    text.replace("\r\n", "\n").replace("\r", "\n");
+    text.chop(1); // the last '\n'
+
+    for (const auto &line : text.split('\n'))
+    {
+        if (!checkLine(line))
+        {
+            mismatched = true;
+            return false;
+        }
+        ++currentLine;
+    }
+
+    return true;
+}
+
+int IncrementalChecker::mismatchedLine() const
+{
+    return currentLine + 1;
+}
+
+void IncrementalChecker::reset()
+{
+    pending.clear();
+    currentLine = 0;
+    mismatched = false;
+}
+
+bool IncrementalChecker::checkLine(QString line) const
+{
+    if (checkerType == Checker::IgnoreTrailingSpaces)
+    {
+        line = chopTrailingSpaces(line);
+        // the lines after the expected output must be empty lines at the end
+        if (currentLine >= expectedLines.length())
+            return line.isEmpty();
+    }
+    else if (currentLine >= expectedLines.length())
+    {
+        return false;
+    }
+    return line == expectedLines[currentLine];
+}
+
+} // namespace Core
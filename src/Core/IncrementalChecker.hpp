@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The IncrementalChecker compares the output of a running program with the expected output line by line.
+ * It's used by Core::Runner to kill the program at the first definitive mismatch, so a wrong solution
+ * which prints a lot doesn't have to run to the end.
+ * Only the built-in checkers can be checked incrementally, the final verdict is still given by Core::Checker.
+ */
+
+#ifndef INCREMENTALCHECKER_HPP
+#define INCREMENTALCHECKER_HPP
+
+#include "Core/Checker.hpp"
+
+namespace Core
+{
+
+class IncrementalChecker
+{
+  public:
+    /**
+     * @brief construct an incremental checker
+     * @param type the type of the checker, it should be supported by isSupported
+     * @param expected the expected output
+     */
+    IncrementalChecker(Checker::CheckerType type, const QString &expected);
+
+    /**
+     * @brief whether a type of checkers can be checked incrementally
+     */
+    static bool isSupported(Checker::CheckerType type);
+
+    /**
+     * @brief consume a chunk of the output
+     * @param chunk the output received after the last call
+     * @returns false if the output can't be accepted no matter what is printed next
+     * @note only complete lines are checked, the rest are kept for the next call
+     */
+    bool feed(const QString &chunk);
+
+    /**
+     * @brief the line number of the first mismatched line, 1-based
+     * @note it's valid only after feed returns false
+     */
+    int mismatchedLine() const;
+
+    /**
+     * @brief forget the output fed, to check another run of the program
+     */
+    void reset();
+
+  private:
+    /**
+     * @brief check a complete line of the output
+     * @param line the line without the line separator
+     */
+    bool checkLine(QString line) const;
+
+    Checker::CheckerType checkerType;
+    QStringList expectedLines; // the expected lines, processed in the same way as the full checker
+    QString pending;           // the incomplete line at the end of the received output
+    int currentLine = 0;       // the number of lines checked
+    bool mismatched = false;
+};
+
+} // namespace Core
+
+#endif // INCREMENTALCHECKER_HPP
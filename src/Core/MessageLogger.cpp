@@ -37,9 +37,10 @@ void MessageLogger::message(const QString &head, const QString &body, const QStr
     QString newBody;
     if (htmlEscaped)
     {
+        // the escaped body is at least as long as the original one, so only the part within the limit is escaped
         // replace spaces by "&nbsp;" to avoid multiple spaces becoming one, important for compilation errors
         newHead = head.toHtmlEscaped().replace(" ", "&nbsp;");
-        newBody = body.toHtmlEscaped().replace(" ", "&nbsp;");
+        newBody = body.left(SettingsHelper::getMessageLengthLimit() + 1).toHtmlEscaped().replace(" ", "&nbsp;");
     }
     else
     {
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/PerfCounters.hpp"
+#include "Core/EventLogger.hpp"
+#include <QFile>
+#include <QStringList>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Core
+{
+
+#ifdef Q_OS_LINUX
+// the events in the same order as the members of Counts
+static const struct
+{
+    quint32 type;
+    quint64 config;
+} events[] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+#endif
+
+PerfCounters::~PerfCounters()
+{
+    close();
+}
+
+bool PerfCounters::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+QStringList PerfCounters::wrapCommand(const QString &program, const QStringList &arguments)
+{
+    // $0 is the program and $@ are the arguments, the shell is replaced by the program after it's resumed
+    return QStringList{"/bin/sh", "-c", "kill -STOP $$ && exec \"$0\" \"$@\"", program} + arguments;
+}
+
+bool PerfCounters::isStopped(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    // WNOWAIT keeps the state for the launcher, which only waits for the exit
+    siginfo_t info;
+    std::memset(&info, 0, sizeof(info));
+    return waitid(P_PID, id_t(pid), &info, WSTOPPED | WNOHANG | WNOWAIT) == 0 && info.si_pid == pid_t(pid);
+#else
+    Q_UNUSED(pid);
+    return false;
+#endif
+}
+
+bool PerfCounters::attach(qint64 pid)
+{
+    close();
+    error.clear();
+
+#ifdef Q_OS_LINUX
+    // the counters must be opened before the shell executes the program
+    bool stopped = isStopped(pid);
+
+    bool permissionDenied = false;
+    bool anyOpened = false;
+
+    for (const auto &event : events)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.inherit = 1;
+        // only the user space is counted, it's allowed with perf_event_paranoid <= 2
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // enabled when the shell executes the program
+        attr.disabled = 1;
+        attr.enable_on_exec = 1;
+
+        int fd = -1;
+        if (stopped)
+            fd = int(syscall(SYS_perf_event_open, &attr, pid_t(pid), -1, -1, PERF_FLAG_FD_CLOEXEC));
+        if (fd == -1 && (errno == EACCES || errno == EPERM))
+            permissionDenied = true;
+        anyOpened = anyOpened || fd != -1;
+        fds.push_back(fd);
+    }
+
+    ::kill(pid_t(pid), SIGCONT);
+
+    if (anyOpened)
+        return true;
+
+    if (!stopped)
+    {
+        error = "The program didn't stop before executing, so it can't be counted from the start";
+    }
+    else if (permissionDenied)
+    {
+        QFile paranoid("/proc/sys/kernel/perf_event_paranoid");
+        QString level = paranoid.open(QIODevice::ReadOnly) ? QString::fromUtf8(paranoid.readAll()).trimmed() : "?";
+        error = QString("Permission denied, /proc/sys/kernel/perf_event_paranoid is %1, it should be at most 2, "
+                        "or CP Editor should have the CAP_PERFMON capability")
+                    .arg(level);
+    }
+    else
+    {
+        error = QString("perf_event_open failed: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+    }
+#else
+    Q_UNUSED(pid);
+    error = "Performance counters are only supported on Linux";
+#endif
+
+    LOG_WARN(INFO_OF(error));
+    close();
+    return false;
+}
+
+PerfCounters::Counts PerfCounters::read() const
+{
+    QVector<qint64> values(7, -1);
+
+#ifdef Q_OS_LINUX
+    for (int i = 0; i < fds.size() && i < values.size(); ++i)
+    {
+        if (fds[i] == -1)
+            continue;
+        quint64 data[3]; // value, time enabled, time running
+        if (::read(fds[i], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+            continue;
+        // the counter only runs for a part of the time if there are more events than hardware counters
+        if (data[2] < data[1])
+            values[i] = qint64(double(data[0]) * double(data[1]) / double(data[2]));
+        else
+            values[i] = qint64(data[0]);
+    }
+#endif
+
+    Counts counts;
+    counts.cycles = values[0];
+    counts.instructions = values[1];
+    counts.cacheReferences = values[2];
+    counts.cacheMisses = values[3];
+    counts.branches = values[4];
+    counts.branchMisses = values[5];
+    counts.pageFaults = values[6];
+    return counts;
+}
+
+QString PerfCounters::errorString() const
+{
+    return error;
+}
+
+void PerfCounters::close()
+{
+#ifdef Q_OS_LINUX
+    for (int fd : fds)
+    {
+        if (fd != -1)
+            ::close(fd);
+    }
+#endif
+    fds.clear();
+}
+
+} // namespace Core
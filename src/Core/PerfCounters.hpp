@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The PerfCounters counts the hardware and software events of a running program by perf_event_open.
+ * It's used by Core::Runner in the "Run With Performance Counters" mode, and it's only supported on Linux.
+ * The program is started by a shell which stops itself before executing the program (see wrapCommand()),
+ * the counters are attached to the stopped process and enabled on exec, so the whole run is counted.
+ * They are read after the program exits.
+ * Events not supported by the CPU (e.g. in virtual machines) are left as -1, and nothing can be counted
+ * if /proc/sys/kernel/perf_event_paranoid forbids it, the reason is given by errorString() then.
+ */
+
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <QString>
+#include <QVector>
+
+namespace Core
+{
+
+class PerfCounters
+{
+  public:
+    // the counted values, -1 if the event is not available
+    struct Counts
+    {
+        qint64 cycles = -1;
+        qint64 instructions = -1;
+        qint64 cacheReferences = -1;
+        qint64 cacheMisses = -1;
+        qint64 branches = -1;
+        qint64 branchMisses = -1;
+        qint64 pageFaults = -1;
+    };
+
+    PerfCounters() = default;
+
+    PerfCounters(const PerfCounters &) = delete;
+
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    ~PerfCounters();
+
+    /**
+     * @brief whether perf_event_open is available on the current platform
+     */
+    static bool isSupported();
+
+    /**
+     * @brief the command which starts a program stopped, the counters should be attached to it by attach()
+     * @param program the program to run
+     * @param arguments the arguments of the program
+     * @returns the program and the arguments of the wrapped command
+     */
+    static QStringList wrapCommand(const QString &program, const QStringList &arguments);
+
+    /**
+     * @brief whether a process started by wrapCommand() has stopped itself, so the counters can be attached
+     * @note it doesn't block, the caller should poll it
+     */
+    static bool isStopped(qint64 pid);
+
+    /**
+     * @brief count the events of a process started by wrapCommand(), and the threads and processes it creates later
+     * @param pid the native process ID
+     * @returns false if none of the events can be counted
+     * @note The process should be stopped (see isStopped()), and it's resumed after the counters are attached.
+     *       The counting starts when the process executes the program, so the shell is not counted.
+     *       The process is resumed even if it fails, e.g. it's not stopped.
+     */
+    bool attach(qint64 pid);
+
+    /**
+     * @brief read the counters, the values are scaled if the counters are multiplexed
+     */
+    Counts read() const;
+
+    /**
+     * @brief why attach() failed
+     */
+    QString errorString() const;
+
+  private:
+    /**
+     * @brief close all counters
+     */
+    void close();
+
+    QVector<int> fds; // the counter of each event in Counts, -1 if it's not available
+    QString error;
+};
+
+} // namespace Core
+
+#endif // PERFCOUNTERS_HPP
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/QtChildProcess.hpp"
+#include <QElapsedTimer>
+
+namespace Core
+{
+QtChildProcess::QtChildProcess(QObject *parent) : ChildProcess(parent)
+{
+    process = new QProcess(this);
+    connect(process, &QProcess::started, this, &QtChildProcess::started);
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            [this](int exitCode, QProcess::ExitStatus exitStatus) {
+                QElapsedTimer now;
+                now.start();
+                emit finished(exitCode, exitStatus, now.msecsSinceReference());
+            });
+    connect(process, &QProcess::readyReadStandardOutput, this, &QtChildProcess::readyReadStandardOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &QtChildProcess::readyReadStandardError);
+    connect(process, &QProcess::errorOccurred, this, &QtChildProcess::errorOccurred);
+}
+
+void QtChildProcess::start(const QString &program, const QStringList &arguments)
+{
+    process->start(program, arguments);
+}
+
+void QtChildProcess::setWorkingDirectory(const QString &dir)
+{
+    process->setWorkingDirectory(dir);
+}
+
+void QtChildProcess::setProcessEnvironment(const QProcessEnvironment &environment)
+{
+    process->setProcessEnvironment(environment);
+}
+
+qint64 QtChildProcess::write(const QByteArray &data)
+{
+    return process->write(data);
+}
+
+void QtChildProcess::closeWriteChannel()
+{
+    process->closeWriteChannel();
+}
+
+qint64 QtChildProcess::bytesToWrite() const
+{
+    return process->bytesToWrite();
+}
+
+QByteArray QtChildProcess::readAllStandardOutput()
+{
+    return process->readAllStandardOutput();
+}
+
+QByteArray QtChildProcess::readAllStandardError()
+{
+    return process->readAllStandardError();
+}
+
+QProcess::ProcessState QtChildProcess::state() const
+{
+    return process->state();
+}
+
+qint64 QtChildProcess::processId() const
+{
+    return process->processId();
+}
+
+void QtChildProcess::kill()
+{
+    process->kill();
+}
+} // namespace Core
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#ifndef QTCHILDPROCESS_HPP
+#define QTCHILDPROCESS_HPP
+
+#include "Core/ChildProcess.hpp"
+
+namespace Core
+{
+class QtChildProcess : public ChildProcess
+{
+    Q_OBJECT
+
+  public:
+    explicit QtChildProcess(QObject *parent = nullptr);
+
+    void start(const QString &program, const QStringList &arguments) override;
+
+    void setWorkingDirectory(const QString &dir) override;
+
+    void setProcessEnvironment(const QProcessEnvironment &environment) override;
+
+    qint64 write(const QByteArray &data) override;
+
+    void closeWriteChannel() override;
+
+    qint64 bytesToWrite() const override;
+
+    QByteArray readAllStandardOutput() override;
+
+    QByteArray readAllStandardError() override;
+
+    QProcess::ProcessState state() const override;
+
+    qint64 processId() const override;
+
+    void kill() override;
+
+  private:
+    QProcess *process = nullptr;
+};
+} // namespace Core
+
+#endif // QTCHILDPROCESS_HPP
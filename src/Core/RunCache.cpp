@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/RunCache.hpp"
+#include "Core/Compiler.hpp"
+#include "Core/EventLogger.hpp"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+
+namespace Core
+{
+
+static const int MAX_RESULTS = 2000;   // the maximum number of results kept on the disk
+static const int PRUNE_INTERVAL = 100; // the number of insertions between two prunes
+
+int RunCache::insertions = 0;
+
+/**
+ * @brief add the content of a file to the hash
+ * @returns false if the file can't be read
+ */
+static bool addFile(QCryptographicHash &hash, const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    return hash.addData(&file);
+}
+
+QByteArray RunCache::programHash(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(lang.toUtf8());
+
+    if (lang == "C++" || lang == "Java")
+    {
+        if (!addFile(hash, Compiler::outputFilePath(tmpFilePath, sourceFilePath, lang, false)))
+            return QByteArray();
+    }
+    if (lang == "Java" || lang == "Python")
+    {
+        // the Java source also covers the other classes, which are not in the main class file
+        if (!addFile(hash, tmpFilePath))
+            return QByteArray();
+    }
+
+    return hash.result();
+}
+
+QString RunCache::key(const QByteArray &programHash, const QString &input, int timeLimit, const QString &runCommand,
+                      const QString &args)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(programHash);
+    // the lengths separate the fields, so different fields can't produce the same data
+    for (const auto &field : {input, QString::number(timeLimit), runCommand, args})
+    {
+        auto data = field.toUtf8();
+        hash.addData(QByteArray::number(data.length()) + ':');
+        hash.addData(data);
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+bool RunCache::find(const QString &key, Result *result)
+{
+    QFile file(QDir(cacheDirectory()).filePath(key + ".json"));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    auto json = QJsonDocument::fromJson(file.readAll()).object();
+    if (json.isEmpty())
+        return false;
+
+    result->out = json["out"].toString();
+    result->err = json["err"].toString();
+    result->exitCode = json["exitCode"].toInt();
+    result->timeUsed = json["timeUsed"].toVariant().toLongLong();
+    result->tle = json["tle"].toBool();
+    result->runTime = QDateTime::fromString(json["runTime"].toString(), Qt::ISODate);
+    return true;
+}
+
+void RunCache::insert(const QString &key, const Result &result)
+{
+    QDir dir(cacheDirectory());
+    if (!dir.mkpath("."))
+        return;
+
+    QJsonObject json;
+    json["out"] = result.out;
+    json["err"] = result.err;
+    json["exitCode"] = result.exitCode;
+    json["timeUsed"] = result.timeUsed;
+    json["tle"] = result.tle;
+    json["runTime"] = result.runTime.toString(Qt::ISODate);
+
+    QFile file(dir.filePath(key + ".json"));
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(json).toJson(QJsonDocument::Compact)) == -1)
+    {
+        LOG_WARN("Failed to save the run result. " << INFO_OF(file.fileName()) << INFO_OF(file.errorString()));
+        return;
+    }
+
+    if (++insertions % PRUNE_INTERVAL == 1)
+        prune();
+}
+
+void RunCache::clear()
+{
+    LOG_INFO("Clearing the run cache");
+    QDir(cacheDirectory()).removeRecursively();
+}
+
+QString RunCache::cacheDirectory()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("run-results");
+}
+
+void RunCache::prune()
+{
+    QDir dir(cacheDirectory());
+    auto files = dir.entryInfoList({"*.json"}, QDir::Files, QDir::Time); // the newest first
+    for (int i = MAX_RESULTS; i < files.length(); ++i)
+        QFile::remove(files[i].filePath());
+    LOG_INFO_IF(files.length() > MAX_RESULTS, "Removed " << files.length() - MAX_RESULTS << " old run results");
+}
+
+} // namespace Core
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The RunCache stores the results of the finished runs, so an unchanged program is not run again on the same input.
+ * The results are keyed by the hash of the program, the input, the time limit, the run command and the arguments.
+ * The program is the executable file for C++, the class file and the source for Java, and the source for Python.
+ * The results are saved in the cache directory of the application, so they survive restarts of the session.
+ */
+
+#ifndef RUNCACHE_HPP
+#define RUNCACHE_HPP
+
+#include <QDateTime>
+#include <QString>
+
+namespace Core
+{
+
+class RunCache
+{
+  public:
+    struct Result
+    {
+        QString out;       // the stdout of the program
+        QString err;       // the stderr of the program
+        int exitCode = 0;  // the exit code of the program
+        qint64 timeUsed{}; // the time used by the program, in milliseconds
+        bool tle = false;  // whether the time limit is exceeded
+        QDateTime runTime; // when the program ran
+    };
+
+    /**
+     * @brief get the hash of a compiled program
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     * @param lang the language of the program, one of "C++", "Java" and "Python"
+     * @returns the hash, empty if the program is not found
+     */
+    static QByteArray programHash(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang);
+
+    /**
+     * @brief get the key of a run
+     * @param programHash the hash returned by programHash()
+     * @param input the input of the run
+     * @param timeLimit the time limit of the run, in milliseconds
+     * @param runCommand the command for running the program
+     * @param args the command line arguments of the program
+     */
+    static QString key(const QByteArray &programHash, const QString &input, int timeLimit, const QString &runCommand,
+                       const QString &args);
+
+    /**
+     * @brief find the result of a run
+     * @param key the key of the run
+     * @param result the found result is stored here
+     * @returns whether the result is found
+     */
+    static bool find(const QString &key, Result *result);
+
+    /**
+     * @brief store the result of a run, the oldest results are removed when there are too many
+     */
+    static void insert(const QString &key, const Result &result);
+
+    /**
+     * @brief remove all stored results
+     */
+    static void clear();
+
+  private:
+    /**
+     * @brief the directory where the results are saved
+     */
+    static QString cacheDirectory();
+
+    /**
+     * @brief remove the oldest results if there are more than MAX_RESULTS results
+     */
+    static void prune();
+
+    static int insertions; // the number of results inserted in this session, used to prune periodically
+};
+
+} // namespace Core
+
+#endif // RUNCACHE_HPP
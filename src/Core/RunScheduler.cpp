@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/RunScheduler.hpp"
+#include "Core/EventLogger.hpp"
+#include <QCoreApplication>
+#include <QThread>
+
+namespace Core
+{
+
+RunScheduler *RunScheduler::instance()
+{
+    static auto *scheduler = new RunScheduler(qApp);
+    return scheduler;
+}
+
+RunScheduler::RunScheduler(QObject *parent) : QObject(parent)
+{
+}
+
+void RunScheduler::join(const QObject *owner)
+{
+    if (owners.contains(owner))
+        return;
+    owners.insert(owner);
+    LOG_INFO(INFO_OF(owners.size()));
+    emit sharesChanged();
+}
+
+void RunScheduler::leave(const QObject *owner)
+{
+    if (!owners.remove(owner))
+        return;
+    LOG_INFO(INFO_OF(owners.size()));
+    emit sharesChanged();
+}
+
+int RunScheduler::limit(const QObject *owner, int defaultLimit) const
+{
+    if (!owners.contains(owner))
+        return qMax(1, defaultLimit);
+    int share = qMax(1, QThread::idealThreadCount() / owners.size());
+    return qMax(1, qMin(defaultLimit, share));
+}
+
+} // namespace Core
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The RunScheduler shares the cores between the tabs which run their test cases at the same time, e.g. when all
+ * tabs are compiled and run together. Each joined tab can run at most its fair share of the cores at a time.
+ * The shares grow when a tab leaves, and the tabs are notified to start more runs.
+ * The tabs which are not joined are not limited by the scheduler.
+ */
+
+#ifndef RUNSCHEDULER_HPP
+#define RUNSCHEDULER_HPP
+
+#include <QObject>
+#include <QSet>
+
+namespace Core
+{
+class RunScheduler : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief get the global scheduler
+     */
+    static RunScheduler *instance();
+
+    /**
+     * @brief share the cores with the other joined tabs
+     * @param owner the tab, it should leave before it's destructed
+     */
+    void join(const QObject *owner);
+
+    /**
+     * @brief stop sharing the cores, it's ignored if the owner is not joined
+     */
+    void leave(const QObject *owner);
+
+    /**
+     * @brief the maximum number of runs of a tab at a time
+     * @param owner the tab
+     * @param defaultLimit the limit of the tab when it's not joined
+     * @returns the smaller one of the default limit and the fair share if the tab is joined, the default limit
+     *          otherwise. It's at least 1.
+     */
+    int limit(const QObject *owner, int defaultLimit) const;
+
+  signals:
+    /**
+     * @brief the shares are changed, the joined tabs may start more runs
+     */
+    void sharesChanged();
+
+  private:
+    explicit RunScheduler(QObject *parent = nullptr);
+
+    QSet<const QObject *> owners; // the joined tabs
+};
+} // namespace Core
+
+#endif // RUNSCHEDULER_HPP
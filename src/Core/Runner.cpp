@@ -18,19 +18,32 @@
 #include "Core/Runner.hpp"
 #include "Core/Compiler.hpp"
 #include "Core/EventLogger.hpp"
+#include "Core/IncrementalChecker.hpp"
+#include "Core/QtChildProcess.hpp"
+#include "Core/SpawnChildProcess.hpp"
+#include "Core/StableTiming.hpp"
+#include "Extensions/JavaRunServer.hpp"
+#include "Extensions/JudgeService.hpp"
+#include <QDataStream>
+#include <QDir>
 #include <QElapsedTimer>
 #include <QFileInfo>
+#include <QHostAddress>
+#include <QLocalSocket>
+#include <QTcpSocket>
 #include <QTimer>
+#include <algorithm>
 #include <generated/SettingsHelper.hpp>
 
 namespace Core
 {
 
+static const int COUNTERS_POLL_INTERVAL = 1; // the interval to check whether the wrapper shell stopped, in ms
+static const int COUNTERS_STOP_LIMIT = 1000; // the time to wait for the wrapper shell to stop itself, in ms
+
 Runner::Runner(int index) : runnerIndex(index)
 {
-    runProcess = new QProcess();
-    connect(runProcess, &QProcess::started, this, &Runner::onStarted);
-    connect(runProcess, &QProcess::errorOccurred, this, &Runner::onErrorOccurred);
+    runProcess = createProcess();
 }
 
 Runner::~Runner()
@@ -39,6 +52,24 @@ Runner::~Runner()
 
     delete killTimer;
 
+    if (javaServerSocket != nullptr)
+    {
+        // The server halts itself when it fails to send the response, so the program is killed with it
+        LOG_WARN("Runner at index:" << runnerIndex << " was running on the Java run server and forcefully killed");
+        javaServerSocket->disconnect(this);
+        delete javaServerSocket;
+        emit runKilled(runnerIndex);
+    }
+
+    if (judgeServiceSocket != nullptr)
+    {
+        // The service kills the program when the connection is closed
+        LOG_WARN("Runner at index:" << runnerIndex << " was running on the judge service and forcefully killed");
+        judgeServiceSocket->disconnect(this);
+        delete judgeServiceSocket;
+        emit runKilled(runnerIndex);
+    }
+
     if (runProcess != nullptr)
     {
         if (runProcess->state() == QProcess::Running)
@@ -52,6 +83,10 @@ Runner::~Runner()
     }
 
     delete runTimer;
+    delete incrementalChecker;
+    delete perfCounters;
+
+    releaseGovernor();
 }
 
 void Runner::run(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
@@ -68,37 +103,44 @@ void Runner::run(const QString &tmpFilePath, const QString &sourceFilePath, cons
         return;
     }
 
-    // get the command for execution
-    QStringList command = QProcess::splitCommand(getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args));
-    if (command.isEmpty())
+    processInput = input;
+
+    if (stableTimingRepeats > 0)
     {
-        emit failedToStartRun(runnerIndex, tr("Failed to get run command. It's probably a bug."));
-        return;
+        stableTimingArguments = {tmpFilePath, sourceFilePath, lang, runCommand, args};
+        stableTimingTimeLimit = timeLimit;
+        stableTimingWarmingUp = true;
+        stableTimingGovernor = StableTiming::acquirePerformanceGovernor();
     }
 
-    // connect signals and set timers
-
-    connect(runProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, &Runner::onFinished);
-    connect(runProcess, &QProcess::readyReadStandardOutput, this, &Runner::onReadyReadStandardOutput);
-    connect(runProcess, &QProcess::readyReadStandardError, this, &Runner::onReadyReadStandardError);
-
-    killTimer = new QTimer(runProcess);
-    killTimer->setSingleShot(true);
-    killTimer->setInterval(timeLimit);
-    connect(killTimer, &QTimer::timeout, this, &Runner::onTimeout);
-
-    runTimer = new QElapsedTimer();
-
-    killTimer->start();
-    runTimer->start();
-
-    QString program = command.takeFirst();
-
-    setWorkingDirectory(tmpFilePath, sourceFilePath, lang);
+    // the judge service doesn't report the process, so it's not used when the process is watched
+    if (SettingsHelper::isJudgeServiceEnable() && incrementalChecker == nullptr && !detectInputExhaustion &&
+        !profileCounters && heapProfileLibrary.isEmpty() && stableTimingRepeats == 0)
+    {
+        auto *service = Extensions::JudgeService::instance();
+        if (service->isReady())
+        {
+            runOnJudgeService(tmpFilePath, sourceFilePath, lang, runCommand, args, timeLimit);
+            return;
+        }
+        // the service is started asynchronously for the next runs, this run is run in the editor
+        service->start();
+    }
 
-    processInput = input;
+    // the Java run server can't be pinned to a CPU per run, so plain java is used for stable timing
+    if (lang == "Java" && SettingsHelper::isJavaRunServerEnable() && stableTimingRepeats == 0)
+    {
+        auto *server = Extensions::JavaRunServer::instance();
+        if (server->isReady())
+        {
+            runOnJavaServer(tmpFilePath, sourceFilePath, runCommand, args, timeLimit);
+            return;
+        }
+        // the server is started asynchronously for the next runs, this run uses plain java
+        server->start(SettingsHelper::getJavaCompileCommand(), runCommand);
+    }
 
-    runProcess->start(program, command);
+    startProcess(tmpFilePath, sourceFilePath, lang, runCommand, args, timeLimit);
 }
 
 void Runner::runDetached(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
@@ -111,21 +153,19 @@ void Runner::runDetached(const QString &tmpFilePath, const QString &sourceFilePa
     // different steps on different OSs
 #if defined(Q_OS_MACOS)
     // use apple script on Mac OS
-    runProcess->setProgram("osascript");
-    runProcess->setArguments({"-l", "AppleScript"});
     QString script = R"(tell app "Terminal" to do script ")" +
                      getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args).replace("\"", "'") + "\"";
-    runProcess->start();
+    runProcess->start("osascript", {"-l", "AppleScript"});
     LOG_INFO("Running apple script\n" << script);
     runProcess->write(script.toUtf8());
     runProcess->closeWriteChannel();
 #elif defined(Q_OS_WIN)
     // use cmd on Windows
-    runProcess->start("cmd", QProcess::splitCommand(
-                                 "/C \"start cmd /C " +
-                                 getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args).replace("\"", "^\"") +
-                                 " ^& pause\""));
-    LOG_INFO("CMD Arguemnts " << runProcess->arguments().join(" "));
+    auto cmdArgs = QProcess::splitCommand(
+        "/C \"start cmd /C " + getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args).replace("\"", "^\"") +
+        " ^& pause\"");
+    runProcess->start("cmd", cmdArgs);
+    LOG_INFO("CMD Arguemnts " << cmdArgs.join(" "));
 #elif defined(Q_OS_UNIX)
     auto terminal = SettingsHelper::getDetachedRunTerminalProgram();
     LOG_INFO("Using: " << terminal << " on UNIX");
@@ -141,25 +181,196 @@ void Runner::runDetached(const QString &tmpFilePath, const QString &sourceFilePa
 #endif
 }
 
-void Runner::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void Runner::setIncrementalChecker(Checker::CheckerType type, const QString &expected)
+{
+    delete incrementalChecker;
+    incrementalChecker = new IncrementalChecker(type, expected);
+}
+
+void Runner::setJudgeOnService(Checker::CheckerType type, const QString &expected, const QString &wholeOutputPath)
+{
+    judgeCheckerType = type;
+    judgeExpected = expected;
+    judgeWholeOutputPath = wholeOutputPath;
+}
+
+void Runner::setDetectInputExhaustion(bool detect)
+{
+    detectInputExhaustion = detect;
+}
+
+void Runner::setProfileCounters(bool profile)
+{
+    profileCounters = profile;
+}
+
+void Runner::setHeapProfile(const QString &libraryPath, const QString &reportPath)
+{
+    heapProfileLibrary = libraryPath;
+    heapProfileReport = reportPath;
+}
+
+void Runner::setStableTiming(int repeats)
 {
+    stableTimingRepeats = StableTiming::isSupported() ? qMax(repeats, 0) : 0;
+}
+
+void Runner::onFinished(int exitCode, QProcess::ExitStatus exitStatus, qint64 exitTime)
+{
+    // the exit time is taken by the launcher, so the latency of delivering the signal is not counted
+    qint64 timeUsed = qBound(0LL, exitTime - runTimer->msecsSinceReference(), runTimer->elapsed()) - inputWaitTime;
+
+    if (stableTimingRepeats > 0)
+    {
+        bool accepted = exitStatus == QProcess::NormalExit && exitCode == 0 && !timeLimitExceeded &&
+                        !outputLimitExceededEmitted && !outputMismatched;
+        if (accepted)
+        {
+            if (stableTimingWarmingUp)
+                stableTimingWarmingUp = false;
+            else
+                stableTimingTimes.push_back(timeUsed);
+
+            if (stableTimingTimes.length() < stableTimingRepeats)
+            {
+                restartForStableTiming();
+                return;
+            }
+
+            auto sorted = stableTimingTimes;
+            std::sort(sorted.begin(), sorted.end());
+            int middle = sorted.length() / 2;
+            timeUsed = sorted.length() % 2 == 1 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+            emit runTimingStats(runnerIndex, stableTimingTimes);
+        }
+        releaseGovernor();
+    }
+
+    if (countersPollTimer != nullptr)
+    {
+        // it exits before the counters are attached, e.g. the shell failed
+        countersPollTimer->stop();
+        countersPollTimer = nullptr;
+        emit runCountersUnavailable(runnerIndex, "The program exited before the counters were attached");
+        delete perfCounters;
+        perfCounters = nullptr;
+    }
+
+    if (perfCounters != nullptr)
+        emit runCounters(runnerIndex, perfCounters->read());
+
+    if (!heapProfileLibrary.isEmpty())
+        emit runHeapProfile(runnerIndex, heapProfileReport);
+
+    if (outputMismatched)
+    {
+        emit runOutputMismatched(runnerIndex, processStdout + runProcess->readAllStandardOutput(),
+                                 processStderr + runProcess->readAllStandardError(),
+                                 incrementalChecker->mismatchedLine(), timeUsed);
+        return;
+    }
+
+    // a program which reads until EOF finishes normally after stdin is closed, it's only a failure otherwise
+    if (inputExhausted && !outputLimitExceededEmitted &&
+        (exitStatus != QProcess::NormalExit || exitCode != 0 || timeLimitExceeded))
+    {
+        emit runInputExhausted(runnerIndex, processStdout + runProcess->readAllStandardOutput(),
+                               processStderr + runProcess->readAllStandardError(), timeUsed);
+        return;
+    }
+
     emit runFinished(runnerIndex, processStdout + runProcess->readAllStandardOutput(),
-                     processStderr + runProcess->readAllStandardError(), exitCode, runTimer->elapsed(),
-                     timeLimitExceeded);
+                     processStderr + runProcess->readAllStandardError(), exitCode, timeUsed, timeLimitExceeded);
 }
 
 void Runner::onStarted()
 {
     if (!isDetachedRun)
     {
+        if (profileCounters)
+        {
+            // the wrapper shell stops itself before executing the program, the counters are attached to it then,
+            // and the run is timed from that moment, see onCountersPollTimeout()
+            perfCounters = new PerfCounters();
+            killTimer->stop();
+            countersPollTimer = new QTimer(runProcess);
+            countersPollTimer->setInterval(COUNTERS_POLL_INTERVAL);
+            connect(countersPollTimer, &QTimer::timeout, this, &Runner::onCountersPollTimeout);
+            countersPollTimer->start();
+            onCountersPollTimeout(); // the shell has probably stopped already
+        }
         runProcess->write(processInput.toUtf8());
-        runProcess->closeWriteChannel();
+#ifdef Q_OS_LINUX
+        if (detectInputExhaustion)
+        {
+            // stdin is kept open, so reading past the input blocks until onInputWatchTimeout closes it
+            inputWatchTimer = new QTimer(runProcess);
+            inputWatchTimer->setInterval(20);
+            connect(inputWatchTimer, &QTimer::timeout, this, &Runner::onInputWatchTimeout);
+            inputWatchTimer->start();
+        }
+        else
+#endif
+            runProcess->closeWriteChannel();
+    }
+    if (!runStartedEmitted)
+    {
+        runStartedEmitted = true;
+        emit runStarted(runnerIndex);
+    }
+}
+
+void Runner::onCountersPollTimeout()
+{
+    auto pid = runProcess->processId();
+    // runTimer is restarted below, so until then it's the time waiting for the shell to stop
+    if (PerfCounters::isSupported() && !PerfCounters::isStopped(pid) && runTimer->elapsed() < COUNTERS_STOP_LIMIT)
+        return;
+
+    countersPollTimer->stop();
+    countersPollTimer->deleteLater(); // this is called in its slot
+    countersPollTimer = nullptr;
+
+    if (!perfCounters->attach(pid))
+    {
+        emit runCountersUnavailable(runnerIndex, perfCounters->errorString());
+        delete perfCounters;
+        perfCounters = nullptr;
     }
-    emit runStarted(runnerIndex);
+
+    // the time waiting for the wrapper shell to stop is not a part of the run
+    runTimer->start();
+    killTimer->start();
 }
 
 void Runner::onTimeout()
 {
+    if (judgeServiceSocket != nullptr)
+    {
+        // the service should have stopped the program by its own timer, it's probably stuck
+        LOG_WARN("The judge service didn't respond after the time limit was reached");
+        timeLimitExceeded = true;
+        judgeServiceSocket->disconnect(this);
+        judgeServiceSocket->abort();
+        judgeServiceSocket->deleteLater();
+        judgeServiceSocket = nullptr;
+        emit runFinished(runnerIndex, QString(), QString(), -1, runTimer->elapsed(), true);
+        return;
+    }
+
+    if (javaServerSocket != nullptr)
+    {
+        // the server should have stopped the program by its watchdog, it's probably stuck
+        LOG_WARN("The Java run server didn't respond after the time limit was reached");
+        timeLimitExceeded = true;
+        javaServerSocket->disconnect(this);
+        javaServerSocket->abort();
+        javaServerSocket->deleteLater();
+        javaServerSocket = nullptr;
+        emit runFinished(runnerIndex, QString(), QString(), -1, runTimer->elapsed(), true);
+        return;
+    }
+
     if (runProcess->state() == QProcess::Running)
     {
         LOG_INFO("Process was running, and forcefully killed it because time limit was reached");
@@ -168,9 +379,75 @@ void Runner::onTimeout()
     }
 }
 
+void Runner::onInputWatchTimeout()
+{
+#ifdef Q_OS_LINUX
+    if (runProcess->state() != QProcess::Running || runProcess->bytesToWrite() > 0)
+        return;
+
+    QString procPath = QString("/proc/%1").arg(runProcess->processId());
+
+    // the fields after the command name in /proc/<pid>/stat, utime and stime are the 12th and the 13th of them
+    QFile statFile(procPath + "/stat");
+    if (!statFile.open(QIODevice::ReadOnly))
+        return;
+    auto stat = statFile.readAll();
+    auto fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+    if (fields.length() < 13)
+        return;
+    qint64 cpuTime = fields[11].toLongLong() + fields[12].toLongLong();
+
+    // the process is waiting for input if any of its threads is sleeping in pipe_read (or pipe_wait on old kernels)
+    bool waiting = false;
+    for (const auto &task : QDir(procPath + "/task").entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        QFile wchanFile(procPath + "/task/" + task + "/wchan");
+        if (!wchanFile.open(QIODevice::ReadOnly))
+            continue;
+        auto wchan = wchanFile.readAll().trimmed();
+        if (wchan == "pipe_read" || wchan == "pipe_wait" || wchan == "pipe_wait_readable")
+        {
+            waiting = true;
+            break;
+        }
+    }
+
+    // all input is written and it's not using CPU, check it twice in case it's a short wait in the middle of input
+    if (waiting && cpuTime == lastCpuTime)
+    {
+        if (++waitingSamples == 1)
+            inputWaitStart = runTimer->elapsed();
+    }
+    else
+    {
+        waitingSamples = 0;
+    }
+    lastCpuTime = cpuTime;
+
+    if (waitingSamples >= 2)
+    {
+        // give it EOF, programs reading until EOF are correct, the others fail or time out after this
+        LOG_INFO("Process is waiting for more input, closing its stdin");
+        inputWatchTimer->stop();
+        inputExhausted = true;
+        inputWaitTime = runTimer->elapsed() - inputWaitStart;
+        runProcess->closeWriteChannel();
+    }
+#endif
+}
+
 void Runner::onReadyReadStandardOutput()
 {
-    processStdout.append(runProcess->readAllStandardOutput().replace('\0', ""));
+    auto chunk = QString::fromUtf8(runProcess->readAllStandardOutput().replace('\0', ""));
+    processStdout.append(chunk);
+    if (incrementalChecker != nullptr && !outputMismatched && !incrementalChecker->feed(chunk))
+    {
+        outputMismatched = true;
+        runProcess->kill();
+        LOG_INFO("Process was running, and forcefully killed it because stdout mismatched on line "
+                 << incrementalChecker->mismatchedLine());
+        return;
+    }
     if (!outputLimitExceededEmitted && processStdout.length() > SettingsHelper::getOutputLengthLimit())
     {
         outputLimitExceededEmitted = true;
@@ -210,6 +487,288 @@ void Runner::onErrorOccurred(QProcess::ProcessError error)
     }
 }
 
+void Runner::onJavaRunServerConnected()
+{
+    javaServerSocket->write(javaServerRequest);
+    if (!runStartedEmitted)
+    {
+        runStartedEmitted = true; // plain java doesn't emit it again if the run falls back to it
+        emit runStarted(runnerIndex);
+    }
+}
+
+void Runner::onJavaRunServerReadyRead()
+{
+    QDataStream response(javaServerSocket);
+    response.setVersion(QDataStream::Qt_5_0);
+
+    qint32 status = 0;
+    qint32 exitCode = 0;
+    qint64 loadTime = 0;
+    qint64 executionTime = 0;
+    QByteArray out;
+    QByteArray err;
+
+    response.startTransaction();
+    response >> status >> exitCode >> loadTime >> executionTime >> out >> err;
+    if (!response.commitTransaction())
+        return; // wait for the rest of the response
+
+    LOG_INFO(INFO_OF(status) << INFO_OF(exitCode) << INFO_OF(loadTime) << INFO_OF(executionTime));
+
+    if (status == Extensions::JavaRunServer::FailedToStart)
+    {
+        // let plain java report the error, e.g. the main class is not found
+        onJavaRunServerDisconnected();
+        return;
+    }
+
+    javaServerSocket->disconnect(this);
+    javaServerSocket->deleteLater();
+    javaServerSocket = nullptr;
+    killTimer->stop();
+
+    qint64 timeUsed = executionTime / 1000000;
+    qint64 startupTime = qMax(runTimer->elapsed() - timeUsed, 0LL);
+
+    processStdout = QString::fromUtf8(out).remove('\0');
+    processStderr = QString::fromUtf8(err).remove('\0');
+
+    if (status == Extensions::JavaRunServer::TimeLimitExceeded)
+    {
+        LOG_INFO("The program was stopped by the Java run server because time limit was reached");
+        timeLimitExceeded = true;
+        if (exitCode == 0)
+            exitCode = -1;
+    }
+    else if (status == Extensions::JavaRunServer::OutputLimitExceeded)
+    {
+        LOG_INFO("The program was stopped by the Java run server because output limit was reached");
+        outputLimitExceededEmitted = true;
+        if (exitCode == 0)
+            exitCode = -1;
+        emit runOutputLimitExceeded(runnerIndex,
+                                    out.length() >= SettingsHelper::getOutputLengthLimit() ? "stdout" : "stderr");
+    }
+
+    emit runTimeBreakdown(runnerIndex, startupTime, timeUsed);
+    emit runFinished(runnerIndex, processStdout, processStderr, exitCode, timeUsed, timeLimitExceeded);
+}
+
+void Runner::onJavaRunServerDisconnected()
+{
+    // the server halts itself only after the runs on it are finished, so the program hasn't run on it,
+    // unless the server crashed
+    LOG_WARN("Failed to run on the Java run server, falling back to plain java. "
+             << INFO_OF(javaServerSocket->errorString()));
+
+    javaServerSocket->disconnect(this);
+    javaServerSocket->deleteLater();
+    javaServerSocket = nullptr;
+
+    delete killTimer;
+    killTimer = nullptr;
+    delete runTimer;
+    runTimer = nullptr;
+
+    startProcess(javaFallbackArguments[0], javaFallbackArguments[1], "Java", javaFallbackArguments[2],
+                 javaFallbackArguments[3], javaFallbackTimeLimit);
+}
+
+void Runner::onJudgeServiceConnected()
+{
+    judgeServiceSocket->write(judgeServiceRequest);
+    judgeServiceRequestSent = true;
+}
+
+void Runner::onJudgeServiceReadyRead()
+{
+    QDataStream response(judgeServiceSocket);
+    response.setVersion(QDataStream::Qt_5_0);
+
+    while (judgeServiceSocket->bytesAvailable() > 0)
+    {
+        qint32 type = 0;
+        response.startTransaction();
+        response >> type;
+
+        if (type == Extensions::JudgeService::Started)
+        {
+            if (!response.commitTransaction())
+                return;
+            if (!runStartedEmitted)
+            {
+                runStartedEmitted = true;
+                emit runStarted(runnerIndex);
+            }
+            continue;
+        }
+
+        if (type == Extensions::JudgeService::FailedToStart)
+        {
+            QString error;
+            response >> error;
+            if (!response.commitTransaction())
+                return;
+            // let the editor report the error, e.g. the executable file is not found
+            LOG_WARN("The judge service failed to start the program. " << INFO_OF(error));
+            fallBackFromJudgeService();
+            return;
+        }
+
+        if (type == Extensions::JudgeService::Failed)
+        {
+            QString error;
+            response >> error;
+            if (!response.commitTransaction())
+                return;
+            failOnJudgeService(tr("The judge service failed to send the result back: %1").arg(error));
+            return;
+        }
+
+        if (type != Extensions::JudgeService::Finished)
+        {
+            response.abortTransaction();
+            failOnJudgeService(tr("Unknown response from the judge service: %1").arg(type));
+            return;
+        }
+
+        qint32 exitCode = 0;
+        qint64 timeUsed = 0;
+        bool tle = false;
+        QString outputLimitType;
+        qint32 verdict = Widgets::TestCase::UNKNOWN;
+        bool elided = false;
+
+        response >> exitCode >> timeUsed >> tle >> outputLimitType >> verdict >> elided >> processStdout >>
+            processStderr;
+        if (!response.commitTransaction())
+            return; // wait for the rest of the response
+
+        LOG_INFO(INFO_OF(type) << INFO_OF(exitCode) << INFO_OF(timeUsed) << INFO_OF(tle) << INFO_OF(verdict)
+                               << INFO_OF(elided));
+
+        judgeServiceSocket->disconnect(this);
+        judgeServiceSocket->abort();
+        judgeServiceSocket->deleteLater();
+        judgeServiceSocket = nullptr;
+        killTimer->stop();
+
+        timeLimitExceeded = tle;
+        if (!outputLimitType.isEmpty())
+        {
+            outputLimitExceededEmitted = true;
+            emit runOutputLimitExceeded(runnerIndex, outputLimitType);
+        }
+        if (verdict != Widgets::TestCase::UNKNOWN)
+            emit runChecked(runnerIndex, static_cast<Widgets::TestCase::Verdict>(verdict));
+        if (elided)
+            emit runOutputElided(runnerIndex, judgeWholeOutputPath);
+
+        emit runFinished(runnerIndex, processStdout, processStderr, exitCode, timeUsed, timeLimitExceeded);
+        return;
+    }
+}
+
+void Runner::onJudgeServiceDisconnected()
+{
+    if (judgeServiceRequestSent)
+    {
+        // the program may have run, e.g. the service crashed because of its output, so it's not run again
+        failOnJudgeService(tr("The judge service stopped while running the program: %1")
+                               .arg(judgeServiceSocket->errorString()));
+        return;
+    }
+
+    fallBackFromJudgeService();
+}
+
+void Runner::failOnJudgeService(const QString &error)
+{
+    LOG_WARN(INFO_OF(error));
+
+    judgeServiceSocket->disconnect(this);
+    judgeServiceSocket->abort();
+    judgeServiceSocket->deleteLater();
+    judgeServiceSocket = nullptr;
+    killTimer->stop();
+
+    emit failedToStartRun(runnerIndex, error);
+}
+
+void Runner::fallBackFromJudgeService()
+{
+    LOG_WARN("Failed to run on the judge service, running in the editor. "
+             << INFO_OF(judgeServiceSocket->errorString()));
+
+    judgeServiceSocket->disconnect(this);
+    judgeServiceSocket->abort();
+    judgeServiceSocket->deleteLater();
+    judgeServiceSocket = nullptr;
+
+    delete killTimer;
+    killTimer = nullptr;
+    delete runTimer;
+    runTimer = nullptr;
+
+    startProcess(judgeFallbackArguments[0], judgeFallbackArguments[1], judgeFallbackArguments[2],
+                 judgeFallbackArguments[3], judgeFallbackArguments[4], judgeFallbackTimeLimit);
+}
+
+ChildProcess *Runner::createProcess()
+{
+    ChildProcess *process = nullptr;
+#ifdef Q_OS_LINUX
+    if (SettingsHelper::isFastProcessLauncher() && SpawnChildProcess::isSupported())
+        process = new SpawnChildProcess();
+    else
+        process = new QtChildProcess();
+#else
+    process = new QtChildProcess();
+#endif
+    connect(process, &ChildProcess::started, this, &Runner::onStarted);
+    connect(process, &ChildProcess::errorOccurred, this, &Runner::onErrorOccurred);
+    return process;
+}
+
+void Runner::restartForStableTiming()
+{
+    LOG_INFO("Starting the next run of the stable timing profile. " << INFO_OF(stableTimingTimes.length()));
+
+    // the timers are children of the process, they are deleted with it
+    killTimer->stop();
+    killTimer = nullptr;
+    if (inputWatchTimer != nullptr)
+        inputWatchTimer->stop();
+    inputWatchTimer = nullptr;
+    runProcess->disconnect(this);
+    runProcess->deleteLater(); // it's emitting finished now
+    runProcess = createProcess();
+
+    delete runTimer;
+    runTimer = nullptr;
+    processStdout.clear();
+    processStderr.clear();
+    lastCpuTime = -1;
+    waitingSamples = 0;
+    inputExhausted = false;
+    inputWaitTime = 0;
+    if (incrementalChecker != nullptr)
+        incrementalChecker->reset();
+
+    startProcess(stableTimingArguments[0], stableTimingArguments[1], stableTimingArguments[2],
+                 stableTimingArguments[3], stableTimingArguments[4], stableTimingTimeLimit);
+}
+
+void Runner::releaseGovernor()
+{
+    if (stableTimingGovernor)
+    {
+        stableTimingGovernor = false;
+        StableTiming::releasePerformanceGovernor();
+    }
+}
+
 QString Runner::getCommand(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
                            const QString &runCommand, const QString &args)
 {
@@ -246,4 +805,144 @@ void Runner::setWorkingDirectory(const QString &tmpFilePath, const QString &sour
         QFileInfo(Compiler::outputFilePath(tmpFilePath, sourceFilePath, lang, false)).path());
 }
 
+void Runner::startProcess(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+                          const QString &runCommand, const QString &args, int timeLimit)
+{
+    // get the command for execution
+    QStringList command = QProcess::splitCommand(getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args));
+    if (command.isEmpty())
+    {
+        emit failedToStartRun(runnerIndex, tr("Failed to get run command. It's probably a bug."));
+        return;
+    }
+
+    // connect signals and set timers
+
+    connect(runProcess, &ChildProcess::finished, this, &Runner::onFinished);
+    connect(runProcess, &ChildProcess::readyReadStandardOutput, this, &Runner::onReadyReadStandardOutput);
+    connect(runProcess, &ChildProcess::readyReadStandardError, this, &Runner::onReadyReadStandardError);
+
+    killTimer = new QTimer(runProcess);
+    killTimer->setSingleShot(true);
+    killTimer->setInterval(timeLimit);
+    connect(killTimer, &QTimer::timeout, this, &Runner::onTimeout);
+
+    runTimer = new QElapsedTimer();
+
+    killTimer->start();
+    runTimer->start();
+
+    QString program = command.takeFirst();
+
+    setWorkingDirectory(tmpFilePath, sourceFilePath, lang);
+
+    if (!heapProfileLibrary.isEmpty())
+    {
+        QFile::remove(heapProfileReport); // the report of the last run shouldn't be read if the program is killed
+        auto environment = QProcessEnvironment::systemEnvironment();
+        environment.insert("LD_PRELOAD", heapProfileLibrary);
+        environment.insert("CPEDITOR_HEAP_PROFILE", heapProfileReport);
+        runProcess->setProcessEnvironment(environment);
+    }
+
+    if (profileCounters && PerfCounters::isSupported())
+    {
+        command = PerfCounters::wrapCommand(program, command);
+        program = command.takeFirst();
+    }
+
+    if (stableTimingRepeats > 0)
+    {
+        StableTiming::LaunchScope scope;
+        runProcess->start(program, command);
+    }
+    else
+    {
+        runProcess->start(program, command);
+    }
+}
+
+void Runner::runOnJavaServer(const QString &tmpFilePath, const QString &sourceFilePath, const QString &runCommand,
+                             const QString &args, int timeLimit)
+{
+    LOG_INFO("Running on the Java run server");
+
+    javaFallbackArguments = {tmpFilePath, sourceFilePath, runCommand, args};
+    javaFallbackTimeLimit = timeLimit;
+
+    // the protocol is described in resources/java/CPEditorRunServer.java
+    QDataStream request(&javaServerRequest, QIODevice::WriteOnly);
+    request.setVersion(QDataStream::Qt_5_0);
+    auto arguments = QProcess::splitCommand(args);
+    request << qint32(Extensions::JavaRunServer::RunRequest)
+            << Compiler::outputPath(tmpFilePath, sourceFilePath, "Java").toUtf8()
+            << SettingsHelper::getJavaClassName().toUtf8() << qint32(arguments.length());
+    for (const auto &argument : arguments)
+        request << argument.toUtf8();
+    request << processInput.toUtf8() << qint32(timeLimit) << qint32(SettingsHelper::getOutputLengthLimit());
+
+    javaServerSocket = new QTcpSocket(this);
+    connect(javaServerSocket, &QTcpSocket::connected, this, &Runner::onJavaRunServerConnected);
+    connect(javaServerSocket, &QTcpSocket::readyRead, this, &Runner::onJavaRunServerReadyRead);
+    connect(javaServerSocket, &QTcpSocket::stateChanged, this, [this](QAbstractSocket::SocketState state) {
+        if (state == QAbstractSocket::UnconnectedState)
+            onJavaRunServerDisconnected();
+    });
+
+    // the server stops the program by its watchdog, this is only used when the server doesn't respond
+    killTimer = new QTimer(this);
+    killTimer->setSingleShot(true);
+    killTimer->setInterval(timeLimit + 1000);
+    connect(killTimer, &QTimer::timeout, this, &Runner::onTimeout);
+
+    runTimer = new QElapsedTimer();
+
+    killTimer->start();
+    runTimer->start();
+
+    javaServerSocket->connectToHost(QHostAddress::LocalHost, Extensions::JavaRunServer::instance()->port());
+}
+
+void Runner::runOnJudgeService(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+                               const QString &runCommand, const QString &args, int timeLimit)
+{
+    LOG_INFO("Running on the judge service");
+
+    judgeFallbackArguments = {tmpFilePath, sourceFilePath, lang, runCommand, args};
+    judgeFallbackTimeLimit = timeLimit;
+
+    // the settings are sent with the request because the service doesn't know the changes after it's started
+    QVariantMap settings;
+    for (auto const &key : Extensions::JudgeService::forwardedSettings())
+        settings[key] = SettingsManager::get(key);
+
+    // the protocol is described in src/Extensions/JudgeService.cpp
+    QDataStream request(&judgeServiceRequest, QIODevice::WriteOnly);
+    request.setVersion(QDataStream::Qt_5_0);
+    request << qint32(Extensions::JudgeService::RunRequest) << tmpFilePath << sourceFilePath << lang << runCommand
+            << args << processInput.toUtf8() << qint32(timeLimit) << settings << qint32(judgeCheckerType)
+            << judgeExpected.toUtf8() << judgeWholeOutputPath;
+
+    judgeServiceSocket = new QLocalSocket(this);
+    connect(judgeServiceSocket, &QLocalSocket::connected, this, &Runner::onJudgeServiceConnected);
+    connect(judgeServiceSocket, &QLocalSocket::readyRead, this, &Runner::onJudgeServiceReadyRead);
+    connect(judgeServiceSocket, &QLocalSocket::stateChanged, this, [this](QLocalSocket::LocalSocketState state) {
+        if (state == QLocalSocket::UnconnectedState)
+            onJudgeServiceDisconnected();
+    });
+
+    // the service stops the program by its own timer, this is only used when the service doesn't respond
+    killTimer = new QTimer(this);
+    killTimer->setSingleShot(true);
+    killTimer->setInterval(timeLimit + 1000);
+    connect(killTimer, &QTimer::timeout, this, &Runner::onTimeout);
+
+    runTimer = new QElapsedTimer();
+
+    killTimer->start();
+    runTimer->start();
+
+    judgeServiceSocket->connectToServer(Extensions::JudgeService::instance()->serverName());
+}
+
 } // namespace Core
@@ -25,13 +25,20 @@
 #ifndef RUNNER_HPP
 #define RUNNER_HPP
 
+#include "Core/Checker.hpp"
+#include "Core/PerfCounters.hpp"
 #include <QProcess>
+#include <QVector>
 
 class QElapsedTimer;
+class QLocalSocket;
+class QTcpSocket;
 class QTimer;
 
 namespace Core
 {
+class ChildProcess;
+class IncrementalChecker;
 
 class Runner : public QObject
 {
@@ -60,6 +67,9 @@ class Runner : public QObject
      * @param input the input to the program
      * @param timeLimit the maximum time for the program to run, in milliseconds
      * @note This should be called only once. Please create multiple Runners for multiple runs.
+     *       Java programs are run on the Java run server if it's enabled and ready.
+     *       The programs are run on Extensions::JudgeService if it's enabled and ready, and none of the options
+     *       that watch the process is used.
      */
     void run(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang, const QString &runCommand,
              const QString &args, const QString &input, int timeLimit);
@@ -76,6 +86,61 @@ class Runner : public QObject
     void runDetached(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
                      const QString &runCommand, const QString &args);
 
+    /**
+     * @brief check the stdout while the program is running, and kill it at the first mismatch
+     * @param type the type of the checker, it should be supported by IncrementalChecker::isSupported
+     * @param expected the expected output
+     * @note This should be called before run(). runOutputMismatched is emitted instead of runFinished on mismatch.
+     */
+    void setIncrementalChecker(Checker::CheckerType type, const QString &expected);
+
+    /**
+     * @brief keep stdin open after writing the input, and close it when the program waits for more input
+     * @note This only works on Linux, it should be called before run().
+     *       Programs that read until EOF get EOF when stdin is closed, and finish as usual.
+     *       runInputExhausted is emitted instead of runFinished if the program then exits with a non-zero exit code,
+     *       crashes, or exceeds the time limit. The time waiting for input is not counted in the time used.
+     */
+    void setDetectInputExhaustion(bool detect);
+
+    /**
+     * @brief count the hardware events of the program by PerfCounters
+     * @note This only works on Linux, it should be called before run().
+     *       runCounters is emitted before the other signals when the program finishes.
+     *       Runs on the Java run server are not counted.
+     */
+    void setProfileCounters(bool profile);
+
+    /**
+     * @brief preload the allocation recorder of Extensions::HeapProfiler into the program
+     * @param libraryPath the path to the shared library of the recorder
+     * @param reportPath the path where the recorder writes the report
+     * @note This only works on Linux, it should be called before run().
+     *       runHeapProfile is emitted before the other signals when the program finishes.
+     */
+    void setHeapProfile(const QString &libraryPath, const QString &reportPath);
+
+    /**
+     * @brief run the program in the environment of StableTiming, and measure it several times
+     * @param repeats the number of timed runs, after an untimed warm-up run
+     * @note This only works on Linux, it should be called before run(). It shouldn't be combined with the
+     *       performance counters or the heap profile. runTimingStats is emitted before runFinished, and the time
+     *       used reported by runFinished is the median. The runs stop at the first run which doesn't finish
+     *       normally, and it's reported as the result. Java programs are not run on the Java run server.
+     */
+    void setStableTiming(int repeats);
+
+    /**
+     * @brief on Extensions::JudgeService, check the output in the service, and only send the beginning of a long stdout
+     * @param type the type of the checker, the output is checked in the service only by a built-in checker
+     * @param expected the expected output
+     * @param wholeOutputPath the file where the service saves the whole stdout if it's too long to be displayed
+     * @note This should be called before run(), and it's ignored by the runs in the editor.
+     *       runChecked and runOutputElided are emitted before runFinished. If the stdout is elided, the stdout in
+     *       runFinished is only one character longer than "Output Display Length Limit".
+     */
+    void setJudgeOnService(Checker::CheckerType type, const QString &expected, const QString &wholeOutputPath);
+
   signals:
     /**
      * @brief the execution has just started
@@ -116,13 +181,86 @@ class Runner : public QObject
      */
     void runKilled(int index);
 
+    /**
+     * @brief the time used by the start-up and the execution, emitted before runFinished
+     * @param index the index of the testcase
+     * @param startupTime the time used to start the program, e.g. to start the JVM and load the classes
+     * @param executionTime the time used to execute the program, i.e. the main method of a Java program
+     * @note this is only emitted for runs on the Java run server
+     */
+    void runTimeBreakdown(int index, qint64 startupTime, qint64 executionTime);
+
+    /**
+     * @brief the program is killed because its stdout doesn't match the expected output
+     * @param index the index of the testcase
+     * @param out the stdout of the program before it's killed
+     * @param err the stderr of the program before it's killed
+     * @param line the first mismatched line, 1-based
+     * @param timeUsed the time between the execution started and the program is killed
+     */
+    void runOutputMismatched(int index, const QString &out, const QString &err, int line, qint64 timeUsed);
+
+    /**
+     * @brief the program waited for more input than provided, and failed after getting EOF
+     * @param index the index of the testcase
+     * @param out the stdout of the program
+     * @param err the stderr of the program
+     * @param timeUsed the time between the execution started and the program finished or is killed
+     */
+    void runInputExhausted(int index, const QString &out, const QString &err, qint64 timeUsed);
+
+    /**
+     * @brief the performance counters of the finished program
+     * @param index the index of the testcase
+     * @param counts the counted events
+     */
+    void runCounters(int index, const Core::PerfCounters::Counts &counts);
+
+    /**
+     * @brief the performance counters can't be attached to the program, the program runs normally
+     * @param index the index of the testcase
+     * @param reason the reason, e.g. forbidden by perf_event_paranoid
+     */
+    void runCountersUnavailable(int index, const QString &reason);
+
+    /**
+     * @brief the program with the allocation recorder is finished
+     * @param index the index of the testcase
+     * @param reportPath the path of the report, it doesn't exist if the program didn't exit normally
+     */
+    void runHeapProfile(int index, const QString &reportPath);
+
+    /**
+     * @brief the time used by each timed run of the stable timing profile, emitted before runFinished
+     * @param index the index of the testcase
+     * @param times the time used by the runs, in milliseconds, in the order they ran
+     */
+    void runTimingStats(int index, const QVector<qint64> &times);
+
+    /**
+     * @brief the output is checked on the judge service, emitted before runFinished
+     * @param index the index of the testcase
+     * @param verdict the verdict of the built-in checker
+     * @note this is only emitted for runs set by setJudgeOnService()
+     */
+    void runChecked(int index, Widgets::TestCase::Verdict verdict);
+
+    /**
+     * @brief the stdout is too long to be displayed, only the beginning of it is in runFinished
+     * @param index the index of the testcase
+     * @param wholeOutputPath the file with the whole stdout
+     * @note this is only emitted for runs set by setJudgeOnService()
+     */
+    void runOutputElided(int index, const QString &wholeOutputPath);
+
   private slots:
     /**
      * @brief the process is finished
      * @param exitCode the exit code of the process
      * @param exitStatus the exit status of the process
+     * @param exitTime when the exit is noticed by the launcher, in QElapsedTimer::msecsSinceReference()
      */
-    void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onFinished(int exitCode, QProcess::ExitStatus exitStatus, qint64 exitTime);
 
     /**
      * @brief the process has just started
@@ -135,6 +273,17 @@ class Runner : public QObject
      */
     void onTimeout();
 
+    /**
+     * @brief sample the state of the process in /proc, and kill it if it's waiting for more input
+     */
+    void onInputWatchTimeout();
+
+    /**
+     * @brief attach the counters when the wrapper shell has stopped, then start timing the run
+     * @note if it doesn't stop in time, the program is resumed and run without the counters
+     */
+    void onCountersPollTimeout();
+
     /**
      * @brief the stdout of the process updated
      * @note kill the process if stdout is too long
@@ -152,7 +301,53 @@ class Runner : public QObject
      */
     void onErrorOccurred(QProcess::ProcessError error);
 
+    /**
+     * @brief the connection to the Java run server is established, send the request
+     */
+    void onJavaRunServerConnected();
+
+    /**
+     * @brief read the response from the Java run server
+     */
+    void onJavaRunServerReadyRead();
+
+    /**
+     * @brief the connection to the Java run server is broken before the response, fall back to plain `java`
+     */
+    void onJavaRunServerDisconnected();
+
+    /**
+     * @brief the connection to the judge service is established, send the request
+     */
+    void onJudgeServiceConnected();
+
+    /**
+     * @brief read the responses from the judge service
+     */
+    void onJudgeServiceReadyRead();
+
+    /**
+     * @brief the connection to the judge service is broken before the result
+     * @note the run is failed if the request is sent, otherwise it's run in the editor instead
+     */
+    void onJudgeServiceDisconnected();
+
   private:
+    /**
+     * @brief create the process used to run the program, and connect the signals for starting
+     */
+    ChildProcess *createProcess();
+
+    /**
+     * @brief replace runProcess with a new process and start the next run of the stable timing profile
+     */
+    void restartForStableTiming();
+
+    /**
+     * @brief restore the cpufreq governor if this runner holds it
+     */
+    void releaseGovernor();
+
     /**
      * @brief get the command to run a program
      * @param tmpFilePath the path to the temporary file which is compiled
@@ -171,8 +366,40 @@ class Runner : public QObject
      */
     void setWorkingDirectory(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang);
 
+    /**
+     * @brief start runProcess to run the program
+     * @note the arguments are the same as run()
+     */
+    void startProcess(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+                      const QString &runCommand, const QString &args, int timeLimit);
+
+    /**
+     * @brief send the run to the Java run server
+     * @note the arguments are the same as run(), they are used when falling back to plain `java`
+     */
+    void runOnJavaServer(const QString &tmpFilePath, const QString &sourceFilePath, const QString &runCommand,
+                         const QString &args, int timeLimit);
+
+    /**
+     * @brief send the run to the judge service
+     * @note the arguments are the same as run(), they are used when falling back to running in the editor
+     */
+    void runOnJudgeService(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+                           const QString &runCommand, const QString &args, int timeLimit);
+
+    /**
+     * @brief close the connection to the judge service and emit failedToStartRun
+     */
+    void failOnJudgeService(const QString &error);
+
+    /**
+     * @brief close the connection to the judge service and run the program in the editor
+     * @note it should be used only if the program has not run on the service
+     */
+    void fallBackFromJudgeService();
+
     const int runnerIndex;                   // the index of the testcase
-    QProcess *runProcess = nullptr;          // the process to run the program
+    ChildProcess *runProcess = nullptr;      // the process to run the program
     QTimer *killTimer = nullptr;             // the timer used to kill the process when the time limit is reached
     QElapsedTimer *runTimer = nullptr;       // the timer used to measure how much time did the execution use
     QString processStdout;                   // the stdout of the process
@@ -181,6 +408,39 @@ class Runner : public QObject
     bool outputLimitExceededEmitted = false; // whether runOutputLimitExceeded is emitted or not
     bool timeLimitExceeded = false;
     bool isDetachedRun = false;
+    IncrementalChecker *incrementalChecker = nullptr; // checks the stdout while running, nullptr if not used
+    bool outputMismatched = false;                    // whether the process is killed by incrementalChecker
+    QTimer *inputWatchTimer = nullptr;   // the timer used to sample the state of the process
+    bool detectInputExhaustion = false; // whether to watch the process waiting for more input
+    bool inputExhausted = false;        // whether the process waited for more input, and stdin is closed for it
+    qint64 lastCpuTime = -1;            // the CPU time of the process in the last sample, in clock ticks
+    int waitingSamples = 0;             // the number of consecutive samples the process is waiting for input
+    qint64 inputWaitStart = 0;          // the elapsed time of the first sample in which it's waiting for input
+    qint64 inputWaitTime = 0;           // the time waiting for input before stdin is closed, not counted as used
+    bool profileCounters = false;         // whether to count the hardware events of the process
+    PerfCounters *perfCounters = nullptr; // the counters attached to the process, nullptr if not used
+    QTimer *countersPollTimer = nullptr;  // polls the wrapper shell until the counters are attached
+    QString heapProfileLibrary;           // the allocation recorder preloaded, empty if not used
+    QString heapProfileReport;            // the path of the report of the allocation recorder
+    int stableTimingRepeats = 0;          // the number of timed runs of the stable timing profile, 0 if not used
+    QVector<qint64> stableTimingTimes;    // the time used by the finished timed runs
+    bool stableTimingWarmingUp = false;   // whether the running process is the untimed warm-up run
+    bool stableTimingGovernor = false;    // whether this runner holds the performance governor
+    QStringList stableTimingArguments;    // the arguments of run(), used to start the next runs
+    int stableTimingTimeLimit = 0;        // the time limit of run(), used to start the next runs
+    bool runStartedEmitted = false;       // whether runStarted is emitted, it's emitted only for the first run
+    QTcpSocket *javaServerSocket = nullptr;  // the connection to the Java run server
+    QByteArray javaServerRequest;            // the request sent to the Java run server
+    QStringList javaFallbackArguments;       // the arguments of run(), used when the Java run server fails
+    int javaFallbackTimeLimit = 0;           // the time limit of run(), used when the Java run server fails
+    QLocalSocket *judgeServiceSocket = nullptr; // the connection to the judge service
+    bool judgeServiceRequestSent = false;       // whether the request is sent, the program may have run since then
+    QByteArray judgeServiceRequest;             // the request sent to the judge service
+    QStringList judgeFallbackArguments;         // the arguments of run(), used when the judge service fails
+    int judgeFallbackTimeLimit = 0;             // the time limit of run(), used when the judge service fails
+    int judgeCheckerType = -1;                  // the checker type of setJudgeOnService(), -1 if it's not called
+    QString judgeExpected;                      // the expected output checked on the judge service
+    QString judgeWholeOutputPath;               // the file with the whole stdout of a run on the judge service
 };
 
 } // namespace Core
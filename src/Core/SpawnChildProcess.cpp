@@ -0,0 +1,488 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/SpawnChildProcess.hpp"
+#include <QElapsedTimer>
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// posix_spawn_file_actions_addchdir_np is added in glibc 2.29
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 29)
+#define SPAWN_CHILD_PROCESS_SUPPORTED
+#endif
+#endif
+
+#ifdef SPAWN_CHILD_PROCESS_SUPPORTED
+extern char **environ;
+#endif
+
+namespace Core
+{
+SpawnChildProcess::SpawnChildProcess(QObject *parent) : ChildProcess(parent)
+{
+    // the signals are emitted on the I/O thread, they are delivered to the GUI thread by queued connections
+    qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
+    qRegisterMetaType<QProcess::ProcessError>("QProcess::ProcessError");
+
+#ifdef SPAWN_CHILD_PROCESS_SUPPORTED
+    cpu_set_t affinity;
+    if (sched_getaffinity(0, sizeof(affinity), &affinity) == 0)
+        ioThreadAffinity = QByteArray(reinterpret_cast<const char *>(&affinity), sizeof(affinity));
+#endif
+}
+
+SpawnChildProcess::~SpawnChildProcess()
+{
+    kill();
+    stopRequested = true;
+    wakeUp();
+    if (ioThread.joinable())
+        ioThread.join();
+#ifdef SPAWN_CHILD_PROCESS_SUPPORTED
+    // reap the killed process, so it doesn't become a zombie
+    if (pid > 0 && !reaped)
+        waitpid(pid_t(pid), nullptr, 0);
+#endif
+    closeAll();
+}
+
+bool SpawnChildProcess::isSupported()
+{
+#ifdef SPAWN_CHILD_PROCESS_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SpawnChildProcess::start(const QString &program, const QStringList &arguments)
+{
+#ifdef SPAWN_CHILD_PROCESS_SUPPORTED
+    // the same as QProcess, a program closing its stdin shouldn't kill CP Editor
+    ::signal(SIGPIPE, SIG_IGN);
+
+    // stdin, stdout, stderr
+    int pipes[3][2] = {{-1, -1}, {-1, -1}, {-1, -1}};
+    auto closePipes = [&pipes] {
+        for (auto &p : pipes)
+        {
+            for (int fd : p)
+            {
+                if (fd != -1)
+                    ::close(fd);
+            }
+        }
+    };
+    for (auto &p : pipes)
+    {
+        if (pipe2(p, O_CLOEXEC) != 0)
+        {
+            closePipes();
+            emit errorOccurred(QProcess::FailedToStart);
+            return;
+        }
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, pipes[0][0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, pipes[1][1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, pipes[2][1], STDERR_FILENO);
+    auto dir = QFile::encodeName(workingDirectory);
+    if (!dir.isEmpty())
+        posix_spawn_file_actions_addchdir_np(&actions, dir.constData());
+
+    // SIGPIPE is ignored in CP Editor, restore it in the child, and don't inherit the signal mask
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t defaultSignals;
+    sigemptyset(&defaultSignals);
+    sigaddset(&defaultSignals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &defaultSignals);
+    sigset_t mask;
+    sigemptyset(&mask);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+
+    // argv points to the data of the QByteArrays, they should live until posix_spawnp returns
+    QList<QByteArray> argData{QFile::encodeName(program)};
+    for (const auto &arg : arguments)
+        argData.push_back(arg.toLocal8Bit());
+    std::vector<char *> argv;
+    for (auto &arg : argData)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    QList<QByteArray> envData;
+    for (const auto &variable : environmentVariables)
+        envData.push_back(variable.toLocal8Bit());
+    std::vector<char *> envp;
+    for (auto &variable : envData)
+        envp.push_back(variable.data());
+    envp.push_back(nullptr);
+
+    pid_t childPid = 0;
+    int error = posix_spawnp(&childPid, argv.front(), &actions, &attr, argv.data(),
+                             environmentVariables.isEmpty() ? environ : envp.data());
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    // close the ends used by the child
+    for (int *fd : {&pipes[0][0], &pipes[1][1], &pipes[2][1]})
+    {
+        ::close(*fd);
+        *fd = -1;
+    }
+
+    if (error != 0)
+    {
+        closePipes();
+        emit errorOccurred(QProcess::FailedToStart);
+        return;
+    }
+
+    stdinFd = pipes[0][1];
+    stdoutFd = pipes[1][0];
+    stderrFd = pipes[2][0];
+    for (int fd : {stdinFd, stdoutFd, stderrFd})
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+#ifdef SYS_pidfd_open
+    pidFd = int(syscall(SYS_pidfd_open, childPid, 0)); // -1 on Linux older than 5.3, the process is polled then
+#endif
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+    pid = childPid;
+
+    if (wakeFd == -1 || epollFd == -1)
+    {
+        ::kill(childPid, SIGKILL);
+        waitpid(childPid, nullptr, 0);
+        reaped = true;
+        closeAll();
+        emit errorOccurred(QProcess::FailedToStart);
+        return;
+    }
+
+    // stdin is watched only when there is pending data, see flushStdin()
+    for (int fd : {stdinFd, stdoutFd, stderrFd, wakeFd, pidFd})
+    {
+        if (fd == -1)
+            continue;
+        epoll_event event{};
+        event.events = fd == stdinFd ? 0U : uint32_t(EPOLLIN);
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    running = true;
+    ioThread = std::thread(&SpawnChildProcess::ioLoop, this);
+
+    emit started();
+#else
+    Q_UNUSED(program);
+    Q_UNUSED(arguments);
+    emit errorOccurred(QProcess::FailedToStart);
+#endif
+}
+
+void SpawnChildProcess::setWorkingDirectory(const QString &dir)
+{
+    workingDirectory = dir;
+}
+
+void SpawnChildProcess::setProcessEnvironment(const QProcessEnvironment &environment)
+{
+    environmentVariables = environment.toStringList();
+}
+
+qint64 SpawnChildProcess::write(const QByteArray &data)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stdinFd == -1 || stdinCloseRequested)
+            return -1;
+        stdinBuffer.append(data);
+    }
+    wakeUp();
+    return data.size();
+}
+
+void SpawnChildProcess::closeWriteChannel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stdinCloseRequested = true;
+    }
+    wakeUp();
+}
+
+qint64 SpawnChildProcess::bytesToWrite() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stdinBuffer.size() - stdinWritten;
+}
+
+QByteArray SpawnChildProcess::readAllStandardOutput()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    QByteArray result;
+    result.swap(stdoutBuffer);
+    return result;
+}
+
+QByteArray SpawnChildProcess::readAllStandardError()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    QByteArray result;
+    result.swap(stderrBuffer);
+    return result;
+}
+
+QProcess::ProcessState SpawnChildProcess::state() const
+{
+    return running ? QProcess::Running : QProcess::NotRunning;
+}
+
+qint64 SpawnChildProcess::processId() const
+{
+    return running ? pid : 0;
+}
+
+void SpawnChildProcess::kill()
+{
+#ifdef SPAWN_CHILD_PROCESS_SUPPORTED
+    // pid is reused by the system after the process is reaped, so it's checked under the lock
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pid <= 0 || reaped)
+        return;
+#ifdef SYS_pidfd_send_signal
+    if (pidFd != -1 && syscall(SYS_pidfd_send_signal, pidFd, SIGKILL, nullptr, 0) == 0)
+        return;
+#endif
+    ::kill(pid_t(pid), SIGKILL);
+#endif
+}
+
+void SpawnChildProcess::ioLoop()
+{
+#ifdef SPAWN_CHILD_PROCESS_SUPPORTED
+    int status = 0;
+    bool exited = false;
+    QElapsedTimer exitTimer; // started when the exit is noticed, before the queued signal reaches the GUI thread
+
+    // the thread inherits the affinity of start(), which may be pinned to the CPU of the program by StableTiming
+    if (!ioThreadAffinity.isEmpty())
+    {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                               reinterpret_cast<const cpu_set_t *>(ioThreadAffinity.constData()));
+    }
+
+    while (!stopRequested && !exited)
+    {
+        flushStdin();
+
+        epoll_event events[5];
+        // without pidfd, the process is polled every millisecond
+        int count = epoll_wait(epollFd, events, 5, pidFd == -1 ? 1 : -1);
+        if (count < 0 && errno != EINTR)
+            break;
+
+        bool checkExit = pidFd == -1;
+        for (int i = 0; i < count; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd)
+            {
+                quint64 value = 0;
+                ::read(wakeFd, &value, sizeof(value));
+            }
+            else if (fd == stdoutFd)
+            {
+                if (readPipe(stdoutFd, stdoutBuffer))
+                    emit readyReadStandardOutput();
+            }
+            else if (fd == stderrFd)
+            {
+                if (readPipe(stderrFd, stderrBuffer))
+                    emit readyReadStandardError();
+            }
+            else if (fd == stdinFd && (events[i].events & (EPOLLERR | EPOLLHUP)))
+            {
+                // the program closed its stdin, the pending data is discarded
+                std::lock_guard<std::mutex> lock(mutex);
+                stdinBuffer.clear();
+                stdinWritten = 0;
+                stdinCloseRequested = true;
+            }
+            else if (fd == pidFd)
+            {
+                checkExit = true;
+            }
+        }
+
+        if (checkExit)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (waitpid(pid_t(pid), &status, WNOHANG) == pid)
+            {
+                exitTimer.start();
+                reaped = true;
+                exited = true;
+            }
+        }
+    }
+
+    if (!exited)
+        return;
+
+    // the output written before the exit is still in the pipes
+    if (stdoutFd != -1 && readPipe(stdoutFd, stdoutBuffer))
+        emit readyReadStandardOutput();
+    if (stderrFd != -1 && readPipe(stderrFd, stderrBuffer))
+        emit readyReadStandardError();
+
+    running = false;
+
+    // the same as QProcess, the exit code is the signal number if the process crashed
+    qint64 exitTime = exitTimer.msecsSinceReference();
+    if (WIFEXITED(status))
+        emit finished(WEXITSTATUS(status), QProcess::NormalExit, exitTime);
+    else
+        emit finished(WIFSIGNALED(status) ? WTERMSIG(status) : -1, QProcess::CrashExit, exitTime);
+#endif
+}
+
+void SpawnChildProcess::flushStdin()
+{
+#ifdef SPAWN_CHILD_PROCESS_SUPPORTED
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stdinFd == -1)
+        return;
+
+    while (stdinWritten < stdinBuffer.size())
+    {
+        auto written =
+            ::write(stdinFd, stdinBuffer.constData() + stdinWritten, size_t(stdinBuffer.size() - stdinWritten));
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN)
+            {
+                // EPIPE, the program closed its stdin
+                stdinBuffer.clear();
+                stdinWritten = 0;
+                stdinCloseRequested = true;
+            }
+            break;
+        }
+        stdinWritten += int(written);
+    }
+
+    if (stdinWritten == stdinBuffer.size())
+    {
+        stdinBuffer.clear();
+        stdinWritten = 0;
+        if (stdinCloseRequested)
+        {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, stdinFd, nullptr);
+            ::close(stdinFd);
+            stdinFd = -1;
+            return;
+        }
+    }
+
+    epoll_event event{};
+    event.events = stdinBuffer.isEmpty() ? 0U : uint32_t(EPOLLOUT);
+    event.data.fd = stdinFd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, stdinFd, &event);
+#endif
+}
+
+bool SpawnChildProcess::readPipe(int &fd, QByteArray &buffer)
+{
+#ifdef SPAWN_CHILD_PROCESS_SUPPORTED
+    bool hasData = false;
+    char data[65536];
+    while (true)
+    {
+        auto length = ::read(fd, data, sizeof(data));
+        if (length > 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffer.append(data, int(length));
+            hasData = true;
+            continue;
+        }
+        if (length < 0 && errno == EINTR)
+            continue;
+        if (length == 0 || errno != EAGAIN)
+        {
+            // EOF, it won't be readable any more
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            ::close(fd);
+            fd = -1;
+        }
+        break;
+    }
+    return hasData;
+#else
+    Q_UNUSED(fd);
+    Q_UNUSED(buffer);
+    return false;
+#endif
+}
+
+void SpawnChildProcess::wakeUp() const
+{
+#ifdef SPAWN_CHILD_PROCESS_SUPPORTED
+    if (wakeFd != -1)
+    {
+        quint64 value = 1;
+        ::write(wakeFd, &value, sizeof(value));
+    }
+#endif
+}
+
+void SpawnChildProcess::closeAll()
+{
+#ifdef SPAWN_CHILD_PROCESS_SUPPORTED
+    for (int *fd : {&stdinFd, &stdoutFd, &stderrFd, &pidFd, &wakeFd, &epollFd})
+    {
+        if (*fd != -1)
+            ::close(*fd);
+        *fd = -1;
+    }
+#endif
+}
+} // namespace Core
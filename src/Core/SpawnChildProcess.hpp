@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The SpawnChildProcess is a low-overhead process launcher on Linux.
+ * The program is started by posix_spawnp, which doesn't copy the page tables of CP Editor like fork.
+ * The pipes and the pidfd of the process are handled by epoll on a dedicated I/O thread,
+ * and the signals are delivered to the GUI thread by queued connections.
+ * It's not supported on other platforms or with glibc older than 2.29, check isSupported() before using it.
+ */
+
+#ifndef SPAWNCHILDPROCESS_HPP
+#define SPAWNCHILDPROCESS_HPP
+
+#include "Core/ChildProcess.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace Core
+{
+class SpawnChildProcess : public ChildProcess
+{
+    Q_OBJECT
+
+  public:
+    explicit SpawnChildProcess(QObject *parent = nullptr);
+
+    /**
+     * @brief destruct the process
+     * @note the program will be killed if it's still running
+     */
+    ~SpawnChildProcess() override;
+
+    /**
+     * @brief whether this launcher can be used on the current platform
+     */
+    static bool isSupported();
+
+    void start(const QString &program, const QStringList &arguments) override;
+
+    void setWorkingDirectory(const QString &dir) override;
+
+    void setProcessEnvironment(const QProcessEnvironment &environment) override;
+
+    qint64 write(const QByteArray &data) override;
+
+    void closeWriteChannel() override;
+
+    qint64 bytesToWrite() const override;
+
+    QByteArray readAllStandardOutput() override;
+
+    QByteArray readAllStandardError() override;
+
+    QProcess::ProcessState state() const override;
+
+    qint64 processId() const override;
+
+    void kill() override;
+
+  private:
+    /**
+     * @brief the event loop of the I/O thread, it returns after the program exits or stop is requested
+     */
+    void ioLoop();
+
+    /**
+     * @brief write the pending stdin data, and close stdin if requested, should be called on the I/O thread
+     */
+    void flushStdin();
+
+    /**
+     * @brief read all available data from a pipe, should be called on the I/O thread
+     * @returns whether any data is read
+     * @note the pipe is closed and fd is set to -1 when EOF is reached
+     */
+    bool readPipe(int &fd, QByteArray &buffer);
+
+    /**
+     * @brief wake up the I/O thread
+     */
+    void wakeUp() const;
+
+    /**
+     * @brief close all file descriptors
+     */
+    void closeAll();
+
+    QString workingDirectory;
+    QStringList environmentVariables; // "NAME=value", empty to use the environment of CP Editor
+    std::thread ioThread;
+    QByteArray ioThreadAffinity;      // the cpu_set_t of the thread creating the launcher, used by the I/O thread
+    mutable std::mutex mutex;         // protects the buffers, the flags and pid below
+    QByteArray stdinBuffer;           // the data waiting to be written to stdin
+    int stdinWritten = 0;             // the number of bytes at the front of stdinBuffer which are written
+    QByteArray stdoutBuffer;          // the data read from stdout
+    QByteArray stderrBuffer;          // the data read from stderr
+    bool stdinCloseRequested = false; // close stdin after the pending data is written
+    bool reaped = false;              // whether the process is waited, pid can't be used after that
+    qint64 pid = 0;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopRequested{false}; // stop the I/O thread without waiting for the process
+    int stdinFd = -1;                       // the write end of the stdin pipe
+    int stdoutFd = -1;                      // the read end of the stdout pipe
+    int stderrFd = -1;                      // the read end of the stderr pipe
+    int pidFd = -1;                         // the pidfd of the process, -1 if pidfd_open is not supported
+    int wakeFd = -1;                        // the eventfd used to wake up the I/O thread
+    int epollFd = -1;
+};
+} // namespace Core
+
+#endif // SPAWNCHILDPROCESS_HPP
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/StableTiming.hpp"
+#include "Core/EventLogger.hpp"
+#include <QFile>
+#include <QFileInfo>
+#include <QVector>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#include <sys/personality.h>
+#endif
+
+namespace Core
+{
+
+static int governorHolders = 0; // the number of runs holding the performance governor
+static QByteArray oldGovernor;  // the governor before it's set to performance
+
+#ifdef Q_OS_LINUX
+/**
+ * @brief parse a CPU list in sysfs, like "2-3,5"
+ */
+static QVector<int> parseCpuList(const QByteArray &list)
+{
+    QVector<int> cpus;
+    for (const auto &range : list.trimmed().split(','))
+    {
+        if (range.isEmpty())
+            continue;
+        auto bounds = range.split('-');
+        int first = bounds.front().toInt();
+        int last = bounds.back().toInt();
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+static QString governorPath(int cpu)
+{
+    return QString("/sys/devices/system/cpu/cpu%1/cpufreq/scaling_governor").arg(cpu);
+}
+#endif
+
+StableTiming::LaunchScope::LaunchScope()
+{
+#ifdef Q_OS_LINUX
+    int old = personality(0xffffffff);
+    if (old != -1 && personality(static_cast<unsigned long>(old) | ADDR_NO_RANDOMIZE) != -1)
+    {
+        oldPersonality = static_cast<unsigned long>(old);
+        personalityChanged = true;
+    }
+
+    int cpu = pinnedCpu();
+    cpu_set_t affinity;
+    if (cpu != -1 && sched_getaffinity(0, sizeof(affinity), &affinity) == 0)
+    {
+        cpu_set_t pinned;
+        CPU_ZERO(&pinned);
+        CPU_SET(cpu, &pinned);
+        if (sched_setaffinity(0, sizeof(pinned), &pinned) == 0)
+            oldAffinity = QByteArray(reinterpret_cast<const char *>(&affinity), sizeof(affinity));
+    }
+#endif
+}
+
+StableTiming::LaunchScope::~LaunchScope()
+{
+#ifdef Q_OS_LINUX
+    if (personalityChanged)
+        personality(oldPersonality);
+    if (!oldAffinity.isEmpty())
+        sched_setaffinity(0, sizeof(cpu_set_t), reinterpret_cast<const cpu_set_t *>(oldAffinity.constData()));
+#endif
+}
+
+bool StableTiming::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+int StableTiming::pinnedCpu()
+{
+#ifdef Q_OS_LINUX
+    // it's chosen once, LaunchScope calls this before changing the affinity for the first time
+    static int cpu = [] {
+        cpu_set_t available;
+        if (sched_getaffinity(0, sizeof(available), &available) != 0)
+            return -1;
+
+        QFile isolatedFile("/sys/devices/system/cpu/isolated");
+        if (isolatedFile.open(QIODevice::ReadOnly))
+        {
+            for (int isolated : parseCpuList(isolatedFile.readAll()))
+            {
+                if (isolated < CPU_SETSIZE && CPU_ISSET(isolated, &available))
+                    return isolated;
+            }
+        }
+
+        for (int i = CPU_SETSIZE - 1; i >= 0; --i)
+        {
+            if (CPU_ISSET(i, &available))
+                return i;
+        }
+        return -1;
+    }();
+    return cpu;
+#else
+    return -1;
+#endif
+}
+
+bool StableTiming::acquirePerformanceGovernor()
+{
+#ifdef Q_OS_LINUX
+    if (governorHolders > 0)
+    {
+        ++governorHolders;
+        return true;
+    }
+
+    int cpu = pinnedCpu();
+    if (cpu == -1)
+        return false;
+
+    QFile governor(governorPath(cpu));
+    if (!QFileInfo(governor).isWritable() || !governor.open(QIODevice::ReadOnly))
+        return false; // only root can change the governor on most systems
+    oldGovernor = governor.readAll().trimmed();
+    governor.close();
+
+    if (oldGovernor != "performance")
+    {
+        if (!governor.open(QIODevice::WriteOnly) || governor.write("performance") == -1)
+            return false;
+        LOG_INFO("The cpufreq governor of CPU " << cpu << " is changed from " << oldGovernor << " to performance");
+    }
+    ++governorHolders;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void StableTiming::releasePerformanceGovernor()
+{
+#ifdef Q_OS_LINUX
+    if (governorHolders == 0 || --governorHolders > 0)
+        return;
+
+    if (oldGovernor.isEmpty() || oldGovernor == "performance")
+        return;
+
+    QFile governor(governorPath(pinnedCpu()));
+    if (governor.open(QIODevice::WriteOnly))
+        governor.write(oldGovernor);
+#endif
+}
+
+} // namespace Core
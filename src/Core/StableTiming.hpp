@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The StableTiming makes the running time of the programs reproducible, for the "Stable Timing" profile of the tabs.
+ * The programs are started with ASLR disabled and pinned to a single CPU, preferably an isolated one, and the CPU
+ * is asked to run at its highest frequency if the cpufreq governor is writable by the user.
+ * Core::Runner also runs the program once untimed before the timed runs, so that the binary is faulted in.
+ * It's only supported on Linux, the functions do nothing on other platforms.
+ */
+
+#ifndef STABLETIMING_HPP
+#define STABLETIMING_HPP
+
+#include <QByteArray>
+
+namespace Core
+{
+
+class StableTiming
+{
+  public:
+    /**
+     * @brief disable ASLR and pin to the CPU for the processes started in the scope
+     * @note The personality and the CPU affinity of the calling thread are inherited by the child processes,
+     *       and they are restored when the scope ends. The processes should be started synchronously in the scope.
+     *       The threads created in the scope inherit them too, so the launchers should restore their own threads.
+     */
+    class LaunchScope
+    {
+      public:
+        LaunchScope();
+
+        LaunchScope(const LaunchScope &) = delete;
+
+        LaunchScope &operator=(const LaunchScope &) = delete;
+
+        ~LaunchScope();
+
+      private:
+        unsigned long oldPersonality = 0; // the personality before the scope
+        bool personalityChanged = false;
+        QByteArray oldAffinity; // the cpu_set_t before the scope, empty if the affinity is not changed
+    };
+
+    /**
+     * @brief whether the stable timing profile is supported on the current platform
+     */
+    static bool isSupported();
+
+    /**
+     * @brief the CPU which the programs are pinned to, -1 if it's not supported
+     * @note An isolated CPU (the isolcpus kernel parameter) is preferred. Otherwise it's the last CPU available,
+     *       because CPU 0 usually handles most of the interrupts.
+     */
+    static int pinnedCpu();
+
+    /**
+     * @brief set the cpufreq governor of the pinned CPU to "performance" if it's writable
+     * @returns whether the governor is set
+     * @note each successful call should be paired with a call of releasePerformanceGovernor()
+     */
+    static bool acquirePerformanceGovernor();
+
+    /**
+     * @brief restore the cpufreq governor when no run holds it
+     */
+    static void releasePerformanceGovernor();
+};
+
+} // namespace Core
+
+#endif // STABLETIMING_HPP
@@ -36,7 +36,7 @@ QString ClangFormatter::settingKey() const
 
 QStringList ClangFormatter::arguments() const
 {
-    return {"--style=file", QString("--cursor=%1").arg(anchorPos())};
+    return {"--style=file", "--assume-filename=" + assumedFilePath(), QString("--cursor=%1").arg(anchorPos())};
 }
 
 QStringList ClangFormatter::rangeArgs() const
@@ -45,35 +45,48 @@ QStringList ClangFormatter::rangeArgs() const
             QString("--length=%1").arg(qAbs(cursorPos() - anchorPos()))};
 }
 
+QStringList ClangFormatter::lineRangeArgs(const QList<QPair<int, int>> &ranges) const
+{
+    QStringList args;
+    for (const auto &range : ranges)
+        args.append(QString("--lines=%1:%2").arg(range.first).arg(range.second));
+    return args;
+}
+
 QString ClangFormatter::styleFileName() const
 {
     return ".clang-format";
 }
 
+QList<QStringList> ClangFormatter::runArguments(const QStringList &args) const
+{
+    if (cursorPos() == anchorPos())
+        return {args};
+
+    // change the `--cursor` argument and format again to get the position of the other end of the selection
+
+    QStringList newArgs;
+
+    for (const auto &arg : qAsConst(args))
+        if (!arg.startsWith("--cursor"))
+            newArgs.append(arg);
+    newArgs.append(QString("--cursor=%1").arg(cursorPos()));
+
+    return {args, newArgs};
+}
+
 QString ClangFormatter::newSource(const QString &out) const
 {
     return out.mid(out.indexOf('\n') + 1);
 }
 
-QTextCursor ClangFormatter::newCursor(const QString &out, const QStringList &args) const
+QTextCursor ClangFormatter::newCursor(const QStringList &outs) const
 {
     auto cursor = editor()->textCursor();
-    cursor.setPosition(newCursorPos(out));
-
-    if (cursorPos() != anchorPos())
-    {
-        // change the `--cursor` argument and format again to get the position of the other end of the selection
-
-        QStringList newArgs;
-
-        for (const auto &arg : qAsConst(args))
-            if (!arg.startsWith("--cursor"))
-                newArgs.append(arg);
-        newArgs.append(QString("--cursor=%1").arg(cursorPos()));
+    cursor.setPosition(newCursorPos(outs.front()));
 
-        auto res = runProcess(newArgs);
-        cursor.setPosition(newCursorPos(res), QTextCursor::KeepAnchor);
-    }
+    if (outs.length() > 1)
+        cursor.setPosition(newCursorPos(outs[1]), QTextCursor::KeepAnchor);
 
     return cursor;
 }
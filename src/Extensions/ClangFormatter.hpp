@@ -17,8 +17,8 @@
 
 /*
  * The Formatter is used to format codes.
- * It runs synchronously, so the event loop is blocked while formatting.
- * The time limit for formatting is 2 seconds.
+ * It runs asynchronously, the time limit for each format process is 2 seconds.
+ * When there's a selection, clang-format runs twice to get the new positions of both ends of the selection.
  */
 
 #ifndef FORMATTER_HPP
@@ -43,11 +43,15 @@ class ClangFormatter : public CodeFormatter
 
     QStringList rangeArgs() const override;
 
+    QStringList lineRangeArgs(const QList<QPair<int, int>> &ranges) const override;
+
     QString styleFileName() const override;
 
+    QList<QStringList> runArguments(const QStringList &args) const override;
+
     QString newSource(const QString &out) const override;
 
-    QTextCursor newCursor(const QString &out, const QStringList &args) const override;
+    QTextCursor newCursor(const QStringList &outs) const override;
 
   private:
     int newCursorPos(const QString &out) const;
@@ -21,12 +21,36 @@
 #include "Settings/SettingsManager.hpp"
 #include "Util/FileUtil.hpp"
 #include "third_party/QCodeEditor/include/QCodeEditor"
-#include <QProcess>
+#include <QCache>
+#include <QCryptographicHash>
 #include <QTemporaryDir>
+#include <QTimer>
 
 namespace Extensions
 {
 
+static const int FORMAT_TIME_LIMIT = 2000; // the time limit of a format process, in milliseconds
+static const int MAX_CACHED_OUTPUTS = 64;  // the maximum number of outputs kept in the cache
+static const int MAX_DIFF_CELLS = 4000000; // the maximum size of the table used to find the changed lines
+
+/**
+ * @brief the outputs of the finished format processes, keyed by CodeFormatter::cacheKey()
+ */
+static QCache<QByteArray, QString> &outputCache()
+{
+    static QCache<QByteArray, QString> cache(MAX_CACHED_OUTPUTS);
+    return cache;
+}
+
+/**
+ * @brief the directory of the style files, shared by all formatters in this session
+ */
+static QTemporaryDir &styleDirectory()
+{
+    static QTemporaryDir dir;
+    return dir;
+}
+
 CodeFormatter::CodeFormatter(QCodeEditor *editor, const QString &lang, bool selectionOnly, bool logOnNoChange,
                              MessageLogger *log, QObject *parent)
     : QObject(parent), m_editor(editor), m_lang(lang), m_selectionOnly(selectionOnly), m_logOnNoChange(logOnNoChange),
@@ -44,111 +68,337 @@ CodeFormatter::CodeFormatter(QCodeEditor *editor, const QString &lang, bool sele
     m_anchorCol = cursor.columnNumber();
 
     LOG_INFO(INFO_OF(m_cursorPos) << INFO_OF(m_cursorLine) << INFO_OF(m_anchorPos) << INFO_OF(m_anchorLine));
+
+    timeoutTimer = new QTimer(this);
+    timeoutTimer->setSingleShot(true);
+    timeoutTimer->setInterval(FORMAT_TIME_LIMIT);
+    connect(timeoutTimer, &QTimer::timeout, this, &CodeFormatter::onTimeout);
 }
 
-void CodeFormatter::format() const
+void CodeFormatter::format()
 {
+    deleteProcess();
+
     QStringList args = arguments() << QProcess::splitCommand(getSetting("Arguments").toString());
 
-    if (formatSelectionOnly())
+    if (!lines.isEmpty())
+        args.append(lineRangeArgs(lines));
+    else if (formatSelectionOnly())
         args.append(rangeArgs());
 
-    QTemporaryDir tmpDir;
-    if (!tmpDir.isValid())
+    source = m_editor->toPlainText();
+    style = getSetting("Style").toString();
+    runs = runArguments(args);
+    outs.clear();
+
+    startNextRun();
+}
+
+bool CodeFormatter::isRunning() const
+{
+    return process != nullptr;
+}
+
+void CodeFormatter::setLineRanges(const QList<QPair<int, int>> &ranges)
+{
+    lines = ranges;
+}
+
+QList<QPair<int, int>> CodeFormatter::changedLines(const QString &before, const QString &after)
+{
+    auto oldLines = before.split('\n');
+    auto newLines = after.split('\n');
+    int oldCount = oldLines.length();
+    int newCount = newLines.length();
+
+    // only diff the lines between the common prefix and the common suffix
+
+    int prefix = 0;
+    while (prefix < oldCount && prefix < newCount && oldLines[prefix] == newLines[prefix])
+        ++prefix;
+    int suffix = 0;
+    while (suffix < oldCount - prefix && suffix < newCount - prefix &&
+           oldLines[oldCount - 1 - suffix] == newLines[newCount - 1 - suffix])
+        ++suffix;
+
+    int n = oldCount - prefix - suffix;
+    int m = newCount - prefix - suffix;
+
+    QVector<bool> changed(newCount, false);
+
+    // a removed line marks the line which takes its place, so the blank lines and the joined lines are formatted
+    auto markRemoved = [&changed, newCount](int index) { changed[qMin(index, newCount - 1)] = true; };
+
+    if (qint64(n + 1) * (m + 1) > MAX_DIFF_CELLS)
     {
-        log->error(tr("Formatter"), tr("Failed to create temporary directory"));
-        return;
+        LOG_INFO("Too many lines are changed, treat all lines in between as changed. " << INFO_OF(n) << INFO_OF(m));
+        for (int j = prefix; j < prefix + m; ++j)
+            changed[j] = true;
+        if (n > 0)
+            markRemoved(prefix + m);
     }
+    else
+    {
+        // lcs[i * (m + 1) + j] is the length of the longest common subsequence of the i-th and the j-th suffixes
+        QVector<int> lcs((n + 1) * (m + 1), 0);
+        for (int i = n - 1; i >= 0; --i)
+        {
+            for (int j = m - 1; j >= 0; --j)
+            {
+                if (oldLines[prefix + i] == newLines[prefix + j])
+                    lcs[i * (m + 1) + j] = lcs[(i + 1) * (m + 1) + j + 1] + 1;
+                else
+                    lcs[i * (m + 1) + j] = qMax(lcs[(i + 1) * (m + 1) + j], lcs[i * (m + 1) + j + 1]);
+            }
+        }
 
-    auto tmpPath = tmpDir.filePath(Util::fileNameWithSuffix("tmp", m_lang));
-    args.append(tmpPath);
+        int i = 0;
+        int j = 0;
+        while (i < n || j < m)
+        {
+            if (i < n && j < m && oldLines[prefix + i] == newLines[prefix + j])
+            {
+                ++i;
+                ++j;
+            }
+            else if (j == m || (i < n && lcs[(i + 1) * (m + 1) + j] >= lcs[i * (m + 1) + j + 1]))
+            {
+                markRemoved(prefix + j);
+                ++i;
+            }
+            else
+            {
+                changed[prefix + j] = true;
+                ++j;
+            }
+        }
+    }
 
-    if (!Util::saveFile(tmpPath, m_editor->toPlainText(), tr("Formatter"), true, log))
-        return;
+    QList<QPair<int, int>> ranges;
+    for (int j = 0; j < newCount; ++j)
+    {
+        if (!changed[j])
+            continue;
+        if (!ranges.isEmpty() && ranges.back().second == j)
+            ranges.back().second = j + 1;
+        else
+            ranges.push_back({j + 1, j + 1});
+    }
+    return ranges;
+}
 
-    if (!Util::saveFile(tmpDir.filePath(styleFileName()), getSetting("Style").toString(), tr("Formatter"), true, log))
-        return;
+QList<QStringList> CodeFormatter::runArguments(const QStringList &args) const
+{
+    return {args};
+}
 
-    auto res = runProcess(args);
-    if (res.isEmpty())
-        return;
+QString CodeFormatter::assumedFilePath() const
+{
+    return styleDirectory().filePath(Util::fileNameWithSuffix("tmp", m_lang));
+}
+
+bool CodeFormatter::formatSelectionOnly() const
+{
+    return m_selectionOnly && m_cursorPos != m_anchorPos;
+}
 
-    auto source = newSource(res);
+QVariant CodeFormatter::getSetting(const QString &key) const
+{
+    return SettingsManager::get(settingKey() + "/" + key);
+}
 
-    if (source == m_editor->toPlainText())
+QByteArray CodeFormatter::cacheKey(const QStringList &args) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    // the lengths separate the fields, so different fields can't produce the same data
+    for (const auto &field : {getSetting("Program").toString(), args.join('\n'), style, source})
     {
-        if (m_logOnNoChange)
-            log->info(tr("Formatter"), tr("Formatting completed"));
-        return;
+        auto data = field.toUtf8();
+        hash.addData(QByteArray::number(data.length()) + ':');
+        hash.addData(data);
     }
+    return hash.result();
+}
 
-    auto cursor = m_editor->textCursor();
-    cursor.select(QTextCursor::Document);
-    cursor.insertText(source);
+bool CodeFormatter::prepareStyleFile() const
+{
+    static QHash<QString, QString> writtenStyles; // the style written to each style file
 
-    m_editor->setTextCursor(newCursor(res, args));
+    if (!styleDirectory().isValid())
+    {
+        log->error(tr("Formatter"), tr("Failed to create temporary directory"));
+        return false;
+    }
 
-    log->info(tr("Formatter"), tr("Formatting completed"));
+    auto it = writtenStyles.constFind(styleFileName());
+    if (it != writtenStyles.constEnd() && *it == style)
+        return true;
+
+    if (!Util::saveFile(styleDirectory().filePath(styleFileName()), style, tr("Formatter"), true, log))
+    {
+        writtenStyles.remove(styleFileName());
+        return false;
+    }
+
+    writtenStyles[styleFileName()] = style;
+    return true;
 }
 
-QString CodeFormatter::runProcess(const QStringList &args) const
+void CodeFormatter::startNextRun()
 {
-    QProcess formatProcess;
-    formatProcess.start(getSetting("Program").toString(), args);
-    LOG_INFO(INFO_OF(formatProcess.program()) << INFO_OF(formatProcess.arguments().join(' ')));
+    while (outs.length() < runs.length())
+    {
+        auto *cached = outputCache().object(cacheKey(runs[outs.length()]));
+        if (cached == nullptr)
+            break;
+        outs.append(*cached);
+    }
 
-    bool finished = formatProcess.waitForFinished(2000); // blocks main Thread
-    if (!finished)
+    if (outs.length() == runs.length())
     {
-        formatProcess.kill();
-        log->error(tr("Formatter"),
-                   tr("The format process didn't finish in 2 seconds. This is probably because the %1 program is not "
-                      "found by CP Editor. You can set the path to the program at %2.")
-                       .arg(settingKey())
-                       .arg(SettingsManager::getPathText(settingKey() + "/Program")),
-                   false);
-        return QString();
+        applyResult();
+        return;
     }
 
-    auto exitCode = formatProcess.exitCode();
+    if (!prepareStyleFile())
+        return;
+
+    process = new QProcess(this);
+    process->setWorkingDirectory(styleDirectory().path());
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &CodeFormatter::onProcessFinished);
+    connect(process, &QProcess::errorOccurred, this, &CodeFormatter::onProcessErrorOccurred);
+
+    process->start(getSetting("Program").toString(), runs[outs.length()]);
+    LOG_INFO(INFO_OF(process->program()) << INFO_OF(process->arguments().join(' ')));
 
-    if (exitCode != 0)
+    process->write(source.toUtf8());
+    process->closeWriteChannel();
+    timeoutTimer->start();
+}
+
+void CodeFormatter::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (sender() != process)
+        return;
+
+    timeoutTimer->stop();
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0)
     {
-        LOG_WARN(INFO_OF(exitCode));
+        LOG_WARN(INFO_OF(exitCode) << INFO_OF(exitStatus));
 
         log->warn(tr("Formatter"), tr("The format command [%1 %2] finished with exit code %3.")
-                                       .arg(formatProcess.program())
-                                       .arg(formatProcess.arguments().join(' '))
+                                       .arg(process->program())
+                                       .arg(process->arguments().join(' '))
                                        .arg(exitCode));
-        auto stdOut = formatProcess.readAllStandardOutput();
+        auto stdOut = process->readAllStandardOutput();
         if (!stdOut.isEmpty())
             log->warn(tr("Formatter[stdout]"), stdOut);
-        auto stdError = formatProcess.readAllStandardError();
+        auto stdError = process->readAllStandardError();
         if (!stdError.isEmpty())
             log->error(tr("Formatter[stderr]"), stdError);
-        return QString();
+        deleteProcess();
+        return;
     }
 
-    auto out = formatProcess.readAllStandardOutput();
+    QString out = process->readAllStandardOutput();
+    deleteProcess();
 
     if (out.isEmpty())
     {
         LOG_WARN("Output is empty");
         log->warn(tr("Formatter"), tr("The output of the format process is empty. Please ensure there is no in-place "
                                       "modification option in the formatting arguments."));
+        return;
     }
 
-    return out;
+    outputCache().insert(cacheKey(runs[outs.length()]), new QString(out));
+    outs.append(out);
+
+    startNextRun();
 }
 
-bool CodeFormatter::formatSelectionOnly() const
+void CodeFormatter::onProcessErrorOccurred(QProcess::ProcessError error)
 {
-    return m_selectionOnly && m_cursorPos != m_anchorPos;
+    if (sender() != process || error != QProcess::FailedToStart)
+        return;
+
+    LOG_WARN(INFO_OF(error));
+    deleteProcess();
+
+    log->error(tr("Formatter"),
+               tr("Failed to start the format process. This is probably because the %1 program is not found by CP "
+                  "Editor. You can set the path to the program at %2.")
+                   .arg(settingKey())
+                   .arg(SettingsManager::getPathText(settingKey() + "/Program")),
+               false);
 }
 
-QVariant CodeFormatter::getSetting(const QString &key) const
+void CodeFormatter::onTimeout()
 {
-    return SettingsManager::get(settingKey() + "/" + key);
+    LOG_WARN("The format process timed out");
+    deleteProcess();
+
+    log->error(tr("Formatter"),
+               tr("The format process didn't finish in 2 seconds. This is probably because the %1 program is not "
+                  "found by CP Editor. You can set the path to the program at %2.")
+                   .arg(settingKey())
+                   .arg(SettingsManager::getPathText(settingKey() + "/Program")),
+               false);
+}
+
+void CodeFormatter::applyResult()
+{
+    if (m_editor->toPlainText() != source)
+    {
+        LOG_INFO("The code is changed while formatting, the result is dropped");
+        return;
+    }
+
+    auto newCode = newSource(outs.front());
+
+    if (newCode == source)
+    {
+        if (m_logOnNoChange)
+            log->info(tr("Formatter"), tr("Formatting completed"));
+        emit completed();
+        return;
+    }
+
+    // only replace the changed part, so the undo history and the highlighting of the other parts are kept
+
+    int commonLength = qMin(source.length(), newCode.length());
+    int prefix = 0;
+    while (prefix < commonLength && source[prefix] == newCode[prefix])
+        ++prefix;
+    int suffix = 0;
+    while (suffix < commonLength - prefix &&
+           source[source.length() - 1 - suffix] == newCode[newCode.length() - 1 - suffix])
+        ++suffix;
+
+    auto cursor = m_editor->textCursor();
+    cursor.setPosition(prefix);
+    cursor.setPosition(source.length() - suffix, QTextCursor::KeepAnchor);
+    cursor.insertText(newCode.mid(prefix, newCode.length() - prefix - suffix));
+
+    m_editor->setTextCursor(newCursor(outs));
+
+    log->info(tr("Formatter"), tr("Formatting completed"));
+
+    emit formatted();
+    emit completed();
+}
+
+void CodeFormatter::deleteProcess()
+{
+    timeoutTimer->stop();
+    if (process == nullptr)
+        return;
+    process->disconnect(this);
+    process->kill();
+    process->deleteLater();
+    process = nullptr;
 }
 
 } // namespace Extensions
@@ -15,14 +15,24 @@
  *
  */
 
+/*
+ * The CodeFormatter formats the code in an editor by an external formatter, e.g. clang-format and yapf.
+ * The code is fed to the format process via stdin, and the process runs asynchronously.
+ * If the code is changed before the process finishes, the result is dropped.
+ * The outputs are cached by the program, the arguments, the style and the code in this session,
+ * so an unchanged code is formatted without starting the process again.
+ * It can format only the lines changed since the last format, see changedLines().
+ */
+
 #ifndef CODEFORMATTER_HPP
 #define CODEFORMATTER_HPP
 
-#include <QObject>
+#include <QProcess>
 
 class MessageLogger;
 class QCodeEditor;
 class QTextCursor;
+class QTimer;
 
 namespace Extensions
 {
@@ -34,7 +44,43 @@ class CodeFormatter : public QObject
     explicit CodeFormatter(QCodeEditor *editor, const QString &lang, bool selectionOnly, bool logOnNoChange,
                            MessageLogger *log, QObject *parent = nullptr);
 
-    void format() const;
+    /**
+     * @brief start formatting
+     * @note If all the outputs are cached, the code is formatted before this function returns.
+     *       Otherwise, it's formatted when the format processes finish.
+     */
+    void format();
+
+    /**
+     * @brief whether the format processes are running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief format the given lines only, instead of the selection or the whole code
+     * @param ranges the 1-based inclusive line ranges, should be called before format()
+     */
+    void setLineRanges(const QList<QPair<int, int>> &ranges);
+
+    /**
+     * @brief get the lines which are changed or inserted in a code
+     * @param before the code before the changes
+     * @param after the code after the changes
+     * @returns the 1-based inclusive line ranges in @p after, the lines around removed lines are included
+     */
+    static QList<QPair<int, int>> changedLines(const QString &before, const QString &after);
+
+  signals:
+    /**
+     * @brief the code in the editor is replaced by the formatted code
+     */
+    void formatted();
+
+    /**
+     * @brief the code in the editor is formatted, whether it's changed or not
+     * @note it's not emitted if the format processes failed or the result is dropped
+     */
+    void completed();
 
   protected:
     /**
@@ -54,42 +100,87 @@ class CodeFormatter : public QObject
      */
     virtual QStringList rangeArgs() const = 0;
 
+    /**
+     * @brief the arguments used to format some lines only
+     * @param ranges the 1-based inclusive line ranges
+     */
+    virtual QStringList lineRangeArgs(const QList<QPair<int, int>> &ranges) const = 0;
+
     /**
      * @brief the name of the style file, e.g. .clang-format
      */
     virtual QString styleFileName() const = 0;
 
+    /**
+     * @brief the arguments of each format process
+     * @param args the arguments used when formatting, including the range args and the args set by the user
+     * @note the new source is got from the output of the first process
+     */
+    virtual QList<QStringList> runArguments(const QStringList &args) const;
+
     /**
      * @brief the new source code after formatting
-     * @param out the stdout of the format process
+     * @param out the stdout of the first format process
      */
     virtual QString newSource(const QString &out) const = 0;
 
     /**
      * @brief the new text cursor after formatting
-     * @param out the stdout of the format process
-     * @param args the arguments used when formatting
+     * @param outs the stdout of the format processes, in the order of runArguments()
      */
-    virtual QTextCursor newCursor(const QString &out, const QStringList &args) const = 0;
+    virtual QTextCursor newCursor(const QStringList &outs) const = 0;
 
     /**
-     * @brief run the format process and get the result
-     * @param args the arguments of the format process
-     * @returns the stdout of the format process, or an empty QString if error occurred
+     * @brief the path of a source file in the directory of the style file
+     * @note The file doesn't exist, it's used by the formatters which find the style by the path of the source.
+     *       The format processes are started in this directory as well.
      */
-    QString runProcess(const QStringList &args) const;
+    QString assumedFilePath() const;
 
     /**
      * @brief check whether only the selection is formatted
      */
     bool formatSelectionOnly() const;
 
+  private slots:
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void onProcessErrorOccurred(QProcess::ProcessError error);
+
+    void onTimeout();
+
   private:
     /**
      * @brief get settingKey()/key
      */
     QVariant getSetting(const QString &key) const;
 
+    /**
+     * @brief get the key of an output in the cache
+     */
+    QByteArray cacheKey(const QStringList &args) const;
+
+    /**
+     * @brief write the style file if it's not written with the current style
+     * @returns whether the style file is ready
+     */
+    bool prepareStyleFile() const;
+
+    /**
+     * @brief start the next format process, or apply the result if all outputs are got
+     */
+    void startNextRun();
+
+    /**
+     * @brief replace the code in the editor by the formatted code
+     */
+    void applyResult();
+
+    /**
+     * @brief delete the current format process, it's killed if it's running
+     */
+    void deleteProcess();
+
   private:
     QCodeEditor *m_editor;
     QString m_lang;
@@ -141,6 +232,13 @@ class CodeFormatter : public QObject
 
   private:
     MessageLogger *log = nullptr;
+    QString source;                 // the code when formatting is started
+    QString style;                  // the style when formatting is started
+    QList<QPair<int, int>> lines;   // the lines to format, empty if the selection or the whole code is formatted
+    QList<QStringList> runs;        // the arguments of each format process
+    QStringList outs;               // the outputs of the finished format processes
+    QProcess *process = nullptr;    // the running format process
+    QTimer *timeoutTimer = nullptr; // kills the format process if it runs for too long
 };
 } // namespace Extensions
 
@@ -23,8 +23,13 @@
 #include "third_party/qhttp/src/qhttpserverconnection.hpp"
 #include "third_party/qhttp/src/qhttpserverrequest.hpp"
 #include "third_party/qhttp/src/qhttpserverresponse.hpp"
+#include <QHostAddress>
 #include <QJsonArray>
+#include <QJsonDocument>
 #include <QJsonObject>
+#include <QUrl>
+#include <QUuid>
+#include <generated/SettingsHelper.hpp>
 
 #define USER_INFO(x)                                                                                                   \
     if (log)                                                                                                           \
@@ -38,6 +43,14 @@
     if (log)                                                                                                           \
         log->error("Companion", x);
 
+static void rejectApiRequest(qhttp::server::QHttpResponse *res, qhttp::TStatusCode status, const QString &error)
+{
+    LOG_WARN("An API request is rejected. " << INFO_OF(error));
+    res->setStatusCode(status);
+    res->addHeader("content-type", "application/json");
+    res->end(QJsonDocument(QJsonObject{{"error", error}}).toJson(QJsonDocument::Compact));
+}
+
 namespace Extensions
 {
 CompanionServer::CompanionServer(int port, QObject *parent) : QObject(parent)
@@ -67,6 +80,12 @@ bool CompanionServer::startListeningOn(int port)
         req->collectData();
 
         req->onEnd([=] {
+            if (req->url().path().startsWith("/api/"))
+            {
+                handleApiRequest(req, res);
+                return;
+            }
+
             res->addHeader("connection", "close");
             res->addHeader("pragma", "no-cache");
 
@@ -122,6 +141,62 @@ void CompanionServer::updatePort(int port)
     }
 }
 
+void CompanionServer::handleApiRequest(qhttp::server::QHttpRequest *req, qhttp::server::QHttpResponse *res)
+{
+    res->addHeader("connection", "close");
+    res->addHeader("pragma", "no-cache");
+
+    // the server listens on all interfaces for Competitive Companion, but the API only serves this computer
+    QHostAddress address(req->remoteAddress());
+    bool isIPv4 = false;
+    auto ipv4 = address.toIPv4Address(&isIPv4);
+    bool isLocal = isIPv4 ? (ipv4 >> 24) == 127 : address == QHostAddress(QHostAddress::LocalHostIPv6);
+
+    // a web page can reach the server through the browser, even with the Host header of a DNS rebinding domain
+    auto host = QUrl("http://" + QString::fromUtf8(req->headers().value("host"))).host();
+    bool isLocalHost = host == "localhost" || host == "127.0.0.1" || host == "::1";
+
+    // POST requests with JSON can't be sent cross-origin without a CORS preflight, which is never allowed
+    auto contentType = req->headers().value("content-type").toLower();
+    bool isJson = contentType == "application/json" || contentType.startsWith("application/json;");
+
+    auto token = SettingsHelper::getCompetitiveCompanionLocalAPIToken();
+
+    if (!SettingsHelper::isCompetitiveCompanionLocalAPI())
+    {
+        res->setStatusCode(qhttp::ESTATUS_NOT_FOUND);
+        res->end();
+    }
+    else if (!isLocal)
+    {
+        LOG_WARN("An API request from another computer is rejected. " << INFO_OF(req->remoteAddress()));
+        res->setStatusCode(qhttp::ESTATUS_FORBIDDEN);
+        res->end();
+    }
+    else if (req->headers().has("origin") || !isLocalHost)
+    {
+        rejectApiRequest(res, qhttp::ESTATUS_FORBIDDEN, "The API can't be used by web pages");
+    }
+    else if (req->methodString() == "POST" && !isJson)
+    {
+        rejectApiRequest(res, qhttp::ESTATUS_UNSUPPORTED_MEDIA_TYPE, "The Content-Type should be application/json");
+    }
+    else if (token.isEmpty())
+    {
+        SettingsHelper::setCompetitiveCompanionLocalAPIToken(QUuid::createUuid().toString().mid(1, 36));
+        USER_INFO(tr("A token of the local API is generated, please copy it from the preferences to the tool"));
+        rejectApiRequest(res, qhttp::ESTATUS_UNAUTHORIZED, "A token is generated, find it in the preferences");
+    }
+    else if (req->headers().value("authorization") != "Bearer " + token.toUtf8())
+    {
+        rejectApiRequest(res, qhttp::ESTATUS_UNAUTHORIZED, "The Authorization should be \"Bearer <token>\"");
+    }
+    else
+    {
+        emit apiRequestArrived(req->methodString(), req->url().path(), req->collectedData(), res);
+    }
+}
+
 void CompanionServer::parseAndEmit(QByteArray &data)
 {
     QJsonParseError error{};
@@ -28,8 +28,10 @@ namespace qhttp
 {
 namespace server
 {
+class QHttpRequest;
+class QHttpResponse;
 class QHttpServer;
-}
+} // namespace server
 } // namespace qhttp
 
 namespace Extensions
@@ -63,9 +65,26 @@ class CompanionServer : public QObject
   signals:
     void onRequestArrived(const CompanionData &data);
 
+    /**
+     * @brief a request to the local API is received from this computer
+     * @param method the HTTP method, e.g. "GET"
+     * @param path the path of the URL, e.g. "/api/v1/tabs"
+     * @param body the body of the request
+     * @param response the response, it's not ended, and it's deleted when the connection is closed
+     */
+    void apiRequestArrived(const QString &method, const QString &path, const QByteArray &body,
+                           qhttp::server::QHttpResponse *response);
+
   private:
     bool startListeningOn(int port);
     void parseAndEmit(QByteArray &data);
+
+    /**
+     * @brief reject the API requests from other computers or web pages, or when the API is disabled, emit the others
+     * @note The requests should have the Host localhost or 127.0.0.1 and no Origin, the POST requests should be
+     *       application/json, and the Authorization should be the token in the settings.
+     */
+    void handleApiRequest(qhttp::server::QHttpRequest *req, qhttp::server::QHttpResponse *res);
     qhttp::server::QHttpServer *server = nullptr;
     int lastListeningPort = -1;
     MessageLogger *log = nullptr;
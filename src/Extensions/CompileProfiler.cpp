@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Extensions/CompileProfiler.hpp"
+#include "Core/EventLogger.hpp"
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <algorithm>
+
+namespace Extensions
+{
+
+// at most this number of entries are kept in each list of the result
+static const int MAX_ENTRIES = 100;
+
+/**
+ * @brief sort the entries by time in descending order, and keep the slowest ones
+ */
+static QVector<CompileProfiler::Entry> slowest(const QHash<QString, CompileProfiler::Entry> &entries)
+{
+    QVector<CompileProfiler::Entry> result;
+    for (const auto &entry : entries)
+        result.push_back(entry);
+    std::sort(result.begin(), result.end(),
+              [](const CompileProfiler::Entry &a, const CompileProfiler::Entry &b) { return a.time > b.time; });
+    if (result.size() > MAX_ENTRIES)
+        result.resize(MAX_ENTRIES);
+    return result;
+}
+
+CompileProfiler::CompileProfiler(QObject *parent) : QObject(parent)
+{
+}
+
+CompileProfiler::~CompileProfiler()
+{
+    if (process != nullptr)
+    {
+        process->disconnect(this);
+        delete process; // the process is killed in the destructor of QProcess
+    }
+    delete workDir;
+}
+
+void CompileProfiler::start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &compileCommand)
+{
+    workDir = new QTemporaryDir();
+    if (!workDir->isValid())
+    {
+        fail(tr("Failed to create the temporary directory"));
+        return;
+    }
+
+    compileArguments = QProcess::splitCommand(compileCommand);
+    if (compileArguments.isEmpty())
+    {
+        fail(tr("The compile command is empty"));
+        return;
+    }
+    compiler = compileArguments.takeFirst();
+
+    // only the compilation is profiled, the object file is not linked
+    compileArguments << QFileInfo(tmpFilePath).canonicalFilePath() << "-c" << "-o" << workDir->filePath("sol.o");
+    if (QFile::exists(sourceFilePath))
+        compileArguments << "-I" << QFileInfo(sourceFilePath).canonicalPath();
+
+    startStep(Detecting, {"--version"});
+}
+
+void CompileProfiler::startStep(Step step, const QStringList &arguments)
+{
+    LOG_INFO(INFO_OF(step) << INFO_OF(compiler) << INFO_OF(arguments.join(' ')));
+
+    currentStep = step;
+
+    if (process != nullptr)
+        process->deleteLater(); // this is called in the slots of the last process
+    process = new QProcess(this);
+    process->setWorkingDirectory(workDir->path());
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &CompileProfiler::onProcessFinished);
+    connect(process, &QProcess::errorOccurred, this, &CompileProfiler::onProcessErrorOccurred);
+
+    compileTimer.start();
+    process->start(compiler, arguments);
+}
+
+void CompileProfiler::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    auto error = QString::fromLocal8Bit(process->readAllStandardError());
+
+    switch (currentStep)
+    {
+    case Detecting:
+    {
+        // Apple Clang and the Clang distributions all print "clang" in their versions
+        bool isClang = QString::fromLocal8Bit(process->readAllStandardOutput()).contains("clang", Qt::CaseInsensitive);
+        LOG_INFO(INFO_OF(isClang));
+        auto arguments = compileArguments;
+        arguments << (isClang ? "-ftime-trace" : "-ftime-report");
+        startStep(Compiling, arguments);
+        break;
+    }
+
+    case Compiling:
+    {
+        if (exitStatus != QProcess::NormalExit || exitCode != 0)
+        {
+            fail(tr("Compilation with the profiling flags failed:\n%1").arg(error.trimmed()));
+            return;
+        }
+
+        Result result;
+        result.totalTime = compileTimer.nsecsElapsed() / 1000;
+
+        // Clang writes the time trace next to the object file, GCC prints the time report to stderr
+        QFile trace(workDir->filePath("sol.json"));
+        if (trace.open(QIODevice::ReadOnly))
+        {
+            result.compiler = "Clang";
+            parseTimeTrace(trace.readAll(), &result);
+        }
+        else
+        {
+            result.compiler = "GCC";
+            parseTimeReport(error, &result);
+        }
+
+        process->deleteLater();
+        process = nullptr;
+
+        if (result.headers.isEmpty() && result.instantiations.isEmpty() && result.phases.isEmpty())
+            fail(tr("The compiler didn't report the time of the compilation"));
+        else
+            emit finished(result);
+        break;
+    }
+    }
+}
+
+void CompileProfiler::onProcessErrorOccurred(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart)
+        fail(tr("Failed to start the compiler [%1]").arg(compiler));
+}
+
+void CompileProfiler::parseTimeTrace(const QByteArray &json, Result *result)
+{
+    QHash<QString, Entry> headers;
+    QHash<QString, Entry> instantiations;
+    QHash<QString, Entry> phases;
+
+    // each event is like {"ph": "X", "name": "Source", "dur": 1234, "args": {"detail": "/usr/include/vector"}}
+    // and the totals are like {"ph": "X", "name": "Total Source", "dur": 5678, "args": {"count": 42}}
+    auto events = QJsonDocument::fromJson(json).object()["traceEvents"].toArray();
+    for (const auto &value : events)
+    {
+        auto event = value.toObject();
+        if (event["ph"].toString() != "X")
+            continue;
+
+        auto name = event["name"].toString();
+        auto args = event["args"].toObject();
+        auto time = qint64(event["dur"].toDouble());
+
+        QHash<QString, Entry> *entries = nullptr;
+        QString key;
+        int count = 1;
+        if (name == "Source")
+        {
+            entries = &headers;
+            key = args["detail"].toString();
+        }
+        else if (name == "InstantiateClass" || name == "InstantiateFunction")
+        {
+            entries = &instantiations;
+            key = args["detail"].toString();
+        }
+        else if (name.startsWith("Total ") && name != "Total ExecuteCompiler")
+        {
+            entries = &phases;
+            key = name.mid(6);
+            count = args["count"].toInt();
+        }
+
+        if (entries == nullptr || key.isEmpty())
+            continue;
+
+        auto &entry = (*entries)[key];
+        entry.name = key;
+        entry.time += time;
+        entry.count += count;
+    }
+
+    result->headers = slowest(headers);
+    result->instantiations = slowest(instantiations);
+    result->phases = slowest(phases);
+}
+
+void CompileProfiler::parseTimeReport(const QString &output, Result *result)
+{
+    // each line is like " template instantiation  :   0.77 ( 33%)   0.27 ( 22%)   1.01 ( 28%)    63M ( 32%)",
+    // the columns are the user time, the system time, the wall time and the memory
+    static const QRegularExpression lineRegex(
+        R"(^\s*\|?(.+?)\s*:\s*[\d.]+\s*\(\s*\d+%\)\s*[\d.]+\s*\(\s*\d+%\)\s*([\d.]+)\s*\()");
+
+    QHash<QString, Entry> phases;
+    for (const auto &line : output.split('\n'))
+    {
+        auto match = lineRegex.match(line);
+        if (!match.hasMatch())
+            continue;
+        auto time = qint64(match.captured(2).toDouble() * 1000000);
+        if (time == 0)
+            continue;
+        auto &entry = phases[match.captured(1)];
+        entry.name = match.captured(1);
+        entry.time += time;
+        ++entry.count;
+    }
+
+    result->phases = slowest(phases);
+}
+
+void CompileProfiler::fail(const QString &reason)
+{
+    LOG_WARN(INFO_OF(reason));
+    if (process != nullptr)
+    {
+        process->disconnect(this);
+        process->deleteLater();
+        process = nullptr;
+    }
+    emit failed(reason);
+}
+
+} // namespace Extensions
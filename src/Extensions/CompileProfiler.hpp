@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The CompileProfiler finds out where the compiler spends its time on a C++ solution.
+ * It asks the compiler for its version first, then compiles the solution again with `-ftime-trace` for Clang,
+ * which records the time of each header and template instantiation, or `-ftime-report` for GCC, which only
+ * reports the time of each phase of the compiler, like parsing and template instantiation.
+ * Each step is an asynchronous process, the result is returned by the finished signal.
+ */
+
+#ifndef COMPILEPROFILER_HPP
+#define COMPILEPROFILER_HPP
+
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QVector>
+
+class QTemporaryDir;
+
+namespace Extensions
+{
+class CompileProfiler : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // the total time of the events with the same name, in microseconds
+    struct Entry
+    {
+        QString name;
+        qint64 time = 0; // inclusive, the time of a header includes the headers included by it
+        int count = 0;
+    };
+
+    struct Result
+    {
+        QString compiler;              // "Clang" or "GCC"
+        qint64 totalTime = 0;          // the wall time of the compilation, in microseconds
+        QVector<Entry> headers;        // sorted by time in descending order, only reported by Clang
+        QVector<Entry> instantiations; // sorted by time in descending order, only reported by Clang
+        QVector<Entry> phases;         // sorted by time in descending order
+    };
+
+    explicit CompileProfiler(QObject *parent = nullptr);
+
+    /**
+     * @brief destruct the profiler
+     * @note the running process is killed
+     */
+    ~CompileProfiler() override;
+
+    /**
+     * @brief profile the compilation of a C++ program
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     * @param compileCommand the command used to compile the program, the profiling flags are appended
+     * @note This should be called only once. Either finished or failed will be emitted.
+     */
+    void start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &compileCommand);
+
+    /**
+     * @brief parse the JSON file written by -ftime-trace of Clang
+     */
+    static void parseTimeTrace(const QByteArray &json, Result *result);
+
+    /**
+     * @brief parse the output of -ftime-report of GCC
+     */
+    static void parseTimeReport(const QString &output, Result *result);
+
+  signals:
+    void finished(const Extensions::CompileProfiler::Result &result);
+
+    void failed(const QString &reason);
+
+  private slots:
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void onProcessErrorOccurred(QProcess::ProcessError error);
+
+  private:
+    enum Step
+    {
+        Detecting,
+        Compiling
+    };
+
+    /**
+     * @brief start the process of a step
+     */
+    void startStep(Step step, const QStringList &arguments);
+
+    /**
+     * @brief emit failed and stop
+     */
+    void fail(const QString &reason);
+
+    QProcess *process = nullptr;      // the process of the current step
+    QTemporaryDir *workDir = nullptr; // the directory of the object file and the time trace
+    Step currentStep = Detecting;     // the step of the running process
+    QString compiler;                 // the program in the compile command
+    QStringList compileArguments;     // the arguments to compile the solution, without the profiling flags
+    QElapsedTimer compileTimer;       // measures the wall time of the compilation
+};
+} // namespace Extensions
+
+#endif // COMPILEPROFILER_HPP
@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Extensions/ComplexityEstimator.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/Runner.hpp"
+#include <QFileInfo>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+namespace Extensions
+{
+
+// the generator is killed if it doesn't finish in this time, in milliseconds
+static const int GENERATOR_TIMEOUT = 10000;
+
+// at least this number of sizes are needed to tell the models apart
+static const int MINIMUM_SAMPLES = 3;
+
+// the typical noise of the running time measured by Core::Runner, in milliseconds
+static const double NOISE_FLOOR = 5;
+
+/**
+ * @brief the natural logarithm of a model at a size, so that the exponential model doesn't overflow
+ */
+static double logModel(ComplexityEstimator::Model model, double size)
+{
+    size = std::max(size, 2.0);
+    switch (model)
+    {
+    case ComplexityEstimator::Linear:
+        return std::log(size);
+    case ComplexityEstimator::Linearithmic:
+        return std::log(size) + std::log(std::log2(size));
+    case ComplexityEstimator::Quadratic:
+        return 2 * std::log(size);
+    case ComplexityEstimator::Cubic:
+        return 3 * std::log(size);
+    case ComplexityEstimator::Exponential:
+        return size * std::log(2.0);
+    }
+    return 0;
+}
+
+ComplexityEstimator::ComplexityEstimator(QObject *parent) : QObject(parent)
+{
+}
+
+ComplexityEstimator::~ComplexityEstimator()
+{
+    if (generator != nullptr)
+    {
+        generator->disconnect(this);
+        delete generator; // the process is killed in the destructor of QProcess
+    }
+    if (runner != nullptr)
+    {
+        runner->disconnect(this);
+        delete runner;
+    }
+}
+
+void ComplexityEstimator::start(const Options &options, const QString &tmpFilePath, const QString &sourceFilePath,
+                                const QString &lang, const QString &runCommand, const QString &args)
+{
+    LOG_INFO(INFO_OF(options.generator) << INFO_OF(options.startSize) << INFO_OF(options.maxConstraint)
+                                        << INFO_OF(options.repeats) << INFO_OF(options.timeLimit));
+
+    this->options = options;
+    tmpPath = tmpFilePath;
+    sourcePath = sourceFilePath;
+    language = lang;
+    solutionRunCommand = runCommand;
+    solutionArgs = args;
+
+    if (QProcess::splitCommand(options.generator).isEmpty())
+    {
+        emit failed(tr("The generator command is empty"));
+        return;
+    }
+
+    generatorTimer = new QTimer(this);
+    generatorTimer->setSingleShot(true);
+    connect(generatorTimer, &QTimer::timeout, this, [this] {
+        if (generator != nullptr)
+            generator->kill();
+    });
+
+    currentSize = std::min<qint64>(std::max(options.startSize, 1), options.maxConstraint);
+    generate();
+}
+
+void ComplexityEstimator::generate()
+{
+    LOG_INFO(INFO_OF(currentSize));
+
+    auto args = QProcess::splitCommand(options.generator);
+    auto program = args.takeFirst();
+    args << QString::number(currentSize);
+
+    generator = new QProcess(this);
+    if (QFile::exists(sourcePath))
+        generator->setWorkingDirectory(QFileInfo(sourcePath).path());
+    else
+        generator->setWorkingDirectory(QFileInfo(tmpPath).path());
+    connect(generator, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &ComplexityEstimator::onGeneratorFinished);
+    connect(generator, &QProcess::errorOccurred, this, &ComplexityEstimator::onGeneratorErrorOccurred);
+    generator->start(program, args);
+    generatorTimer->start(GENERATOR_TIMEOUT);
+}
+
+void ComplexityEstimator::onGeneratorFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    generatorTimer->stop();
+    input = QString::fromUtf8(generator->readAllStandardOutput());
+    auto error = QString::fromLocal8Bit(generator->readAllStandardError()).trimmed();
+    generator->deleteLater();
+    generator = nullptr;
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0)
+    {
+        stop(tr("The generator failed at n = %1 (exit code %2)\n%3").arg(currentSize).arg(exitCode).arg(error));
+        return;
+    }
+
+    finishedRepeats = 0;
+    fastestTime = 0;
+    runSolution();
+}
+
+void ComplexityEstimator::onGeneratorErrorOccurred(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart)
+        return;
+    generatorTimer->stop();
+    generator->deleteLater();
+    generator = nullptr;
+    emit failed(tr("Failed to start the generator [%1]").arg(options.generator));
+}
+
+void ComplexityEstimator::runSolution()
+{
+    runner = new Core::Runner(0);
+    connect(runner, &Core::Runner::runFinished, this, &ComplexityEstimator::onRunFinished);
+    connect(runner, &Core::Runner::failedToStartRun, this, &ComplexityEstimator::onFailedToStartRun);
+    connect(runner, &Core::Runner::runOutputLimitExceeded, this, &ComplexityEstimator::onRunOutputLimitExceeded);
+    runner->run(tmpPath, sourcePath, language, solutionRunCommand, solutionArgs, input, options.timeLimit);
+}
+
+void ComplexityEstimator::onRunFinished(int /*index*/, const QString & /*out*/, const QString & /*err*/, int exitCode,
+                                        qint64 timeUsed, bool tle)
+{
+    runner->deleteLater();
+    runner = nullptr;
+
+    if (tle)
+    {
+        stop(tr("The time limit is exceeded at n = %1").arg(currentSize));
+        return;
+    }
+    if (exitCode != 0)
+    {
+        stop(tr("The solution exited with code %1 at n = %2").arg(exitCode).arg(currentSize));
+        return;
+    }
+
+    if (finishedRepeats == 0 || timeUsed < fastestTime)
+        fastestTime = timeUsed;
+    if (++finishedRepeats < options.repeats)
+    {
+        runSolution();
+        return;
+    }
+
+    Sample sample{currentSize, fastestTime};
+    samples.push_back(sample);
+    emit sampleMeasured(sample);
+
+    if (currentSize >= options.maxConstraint)
+        stop(QString());
+    else if (fastestTime * 2 > options.timeLimit)
+        stop(tr("Half of the time limit is used at n = %1").arg(currentSize));
+    else
+    {
+        currentSize = std::min<qint64>(currentSize * 2, options.maxConstraint);
+        generate();
+    }
+}
+
+void ComplexityEstimator::onFailedToStartRun(int /*index*/, const QString &error)
+{
+    runner->deleteLater();
+    runner = nullptr;
+    emit failed(error);
+}
+
+void ComplexityEstimator::onRunOutputLimitExceeded(int /*index*/, const QString &type)
+{
+    // the runner is killed, and runFinished is not emitted after this
+    runner->disconnect(this);
+    runner->deleteLater();
+    runner = nullptr;
+    stop(tr("The output limit of %1 is exceeded at n = %2").arg(type).arg(currentSize));
+}
+
+void ComplexityEstimator::stop(const QString &reason)
+{
+    LOG_INFO(INFO_OF(samples.size()) << INFO_OF(reason));
+
+    if (samples.size() < MINIMUM_SAMPLES)
+    {
+        emit failed(tr("At least %1 sizes are needed to estimate the complexity, but only %2 are measured. %3")
+                        .arg(MINIMUM_SAMPLES)
+                        .arg(samples.size())
+                        .arg(reason.isEmpty() ? tr("Please use a smaller start size.") : reason));
+        return;
+    }
+
+    Result result;
+    result.samples = samples;
+    result.fits = fit(samples, options.maxConstraint);
+    result.stopReason = reason;
+    emit finished(result);
+}
+
+QVector<ComplexityEstimator::Fit> ComplexityEstimator::fit(const QVector<Sample> &samples, qint64 maxConstraint)
+{
+    QVector<Fit> fits;
+    if (samples.size() < 2)
+        return fits;
+
+    qint64 largestSize = 0;
+    for (const auto &sample : samples)
+        largestSize = std::max(largestSize, sample.size);
+
+    for (auto model : {Linear, Linearithmic, Quadratic, Cubic, Exponential})
+    {
+        // The models are normalized by their values at the largest size to keep the sums in range.
+        // The relative errors are minimized, with a noise floor so that the runs of a few milliseconds don't dominate.
+        double base = logModel(model, largestSize);
+        auto value = [&](qint64 size) { return std::exp(logModel(model, size) - base); };
+        auto time = [](const Sample &sample) { return double(sample.time); };
+
+        double sw = 0, swf = 0, swff = 0, swt = 0, swft = 0;
+        for (const auto &sample : samples)
+        {
+            double f = value(sample.size);
+            double t = time(sample);
+            double w = 1 / ((t + NOISE_FLOOR) * (t + NOISE_FLOOR));
+            sw += w;
+            swf += w * f;
+            swff += w * f * f;
+            swt += w * t;
+            swft += w * f * t;
+        }
+
+        double det = sw * swff - swf * swf;
+        double coefficient = det > 0 ? (sw * swft - swf * swt) / det : 0;
+        double constant = (swt - coefficient * swf) / sw;
+        if (constant < 0)
+        {
+            constant = 0;
+            coefficient = swft / swff;
+        }
+        if (coefficient < 0)
+        {
+            coefficient = 0;
+            constant = swt / sw;
+        }
+
+        double squaredError = 0;
+        for (const auto &sample : samples)
+        {
+            double relativeError =
+                (constant + coefficient * value(sample.size) - time(sample)) / (time(sample) + NOISE_FLOOR);
+            squaredError += relativeError * relativeError;
+        }
+
+        Fit fit;
+        fit.model = model;
+        fit.constant = constant;
+        fit.coefficient = coefficient * std::exp(-base);
+        fit.error = std::sqrt(squaredError / samples.size());
+        fit.predictedTime = coefficient > 0 ? constant + coefficient * value(maxConstraint) : constant;
+        fits.push_back(fit);
+    }
+
+    std::stable_sort(fits.begin(), fits.end(), [](const Fit &a, const Fit &b) { return a.error < b.error; });
+
+    // the measurements are noisy, so a simpler model wins if it's almost as good as the best one
+    auto simplest = std::min_element(fits.begin(), fits.end(), [&fits](const Fit &a, const Fit &b) {
+        bool aGood = a.error <= fits.front().error * 1.1 + 0.01;
+        bool bGood = b.error <= fits.front().error * 1.1 + 0.01;
+        return aGood != bGood ? aGood : a.model < b.model;
+    });
+    std::rotate(fits.begin(), simplest, simplest + 1);
+
+    return fits;
+}
+
+QString ComplexityEstimator::modelName(Model model)
+{
+    switch (model)
+    {
+    case Linear:
+        return "O(n)";
+    case Linearithmic:
+        return "O(n log n)";
+    case Quadratic:
+        return "O(n^2)";
+    case Cubic:
+        return "O(n^3)";
+    case Exponential:
+        return "O(2^n)";
+    }
+    return QString();
+}
+
+} // namespace Extensions
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The ComplexityEstimator measures how the running time of a solution grows with the size of the input.
+ * A generator is run on a geometric series of sizes, and the solution is run on each generated input several times
+ * by Core::Runner. The fastest run of each size is fitted against the common complexity models, and the best model
+ * is used to extrapolate the running time at the maximum constraint of the problem.
+ * The solution should be compiled before start() is called.
+ */
+
+#ifndef COMPLEXITYESTIMATOR_HPP
+#define COMPLEXITYESTIMATOR_HPP
+
+#include <QProcess>
+#include <QVector>
+
+class QTimer;
+
+namespace Core
+{
+class Runner;
+}
+
+namespace Extensions
+{
+class ComplexityEstimator : public QObject
+{
+    Q_OBJECT
+
+  public:
+    enum Model
+    {
+        Linear,
+        Linearithmic,
+        Quadratic,
+        Cubic,
+        Exponential
+    };
+
+    struct Options
+    {
+        QString generator;        // the command of the generator, the size is appended as the last argument
+        int startSize = 16;       // the first size to measure
+        int maxConstraint = 1000; // the maximum size in the problem statement
+        int repeats = 3;          // the number of runs of each size
+        int timeLimit = 5000;     // the time limit of each run, the sizes stop growing when half of it is used
+    };
+
+    // the running time of a size, the fastest of the repeated runs
+    struct Sample
+    {
+        qint64 size = 0;
+        qint64 time = 0;
+    };
+
+    // the running time is modeled as constant + coefficient * model(size)
+    struct Fit
+    {
+        Model model = Linear;
+        double constant = 0;
+        double coefficient = 0;
+        double error = 0;         // the root mean square of the relative errors of the samples
+        double predictedTime = 0; // the predicted running time at the maximum constraint, in milliseconds
+    };
+
+    struct Result
+    {
+        QVector<Sample> samples;
+        QVector<Fit> fits;  // the best fit comes first
+        QString stopReason; // why the sizes stopped growing before the maximum constraint, empty if they didn't
+    };
+
+    explicit ComplexityEstimator(QObject *parent = nullptr);
+
+    /**
+     * @brief destruct the estimator
+     * @note the running generator or solution is killed
+     */
+    ~ComplexityEstimator() override;
+
+    /**
+     * @brief start measuring the solution
+     * @param options the generator and the sizes
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     * @param lang the language of the solution, one of "C++", "Java" and "Python"
+     * @param runCommand the command for running the solution
+     * @param args the command line arguments of the solution
+     * @note This should be called only once. Either finished or failed will be emitted.
+     */
+    void start(const Options &options, const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+               const QString &runCommand, const QString &args);
+
+    /**
+     * @brief fit the samples against all models
+     * @param samples the measured samples, at least two different sizes are required
+     * @param maxConstraint the size where the running time is predicted
+     * @returns the fits sorted from the best to the worst, a simpler model is preferred if it's almost as good
+     */
+    static QVector<Fit> fit(const QVector<Sample> &samples, qint64 maxConstraint);
+
+    /**
+     * @brief the big O notation of a model, like "O(n log n)"
+     */
+    static QString modelName(Model model);
+
+  signals:
+    /**
+     * @brief the running time of a size is measured
+     */
+    void sampleMeasured(const Extensions::ComplexityEstimator::Sample &sample);
+
+    void finished(const Extensions::ComplexityEstimator::Result &result);
+
+    void failed(const QString &reason);
+
+  private slots:
+    void onGeneratorFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void onGeneratorErrorOccurred(QProcess::ProcessError error);
+
+    void onRunFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed, bool tle);
+
+    void onFailedToStartRun(int index, const QString &error);
+
+    void onRunOutputLimitExceeded(int index, const QString &type);
+
+  private:
+    /**
+     * @brief generate the input of the current size
+     */
+    void generate();
+
+    /**
+     * @brief run the solution on the current input once
+     */
+    void runSolution();
+
+    /**
+     * @brief stop growing the sizes, and fit the samples if there are enough of them
+     * @param reason why it stops before the maximum constraint, empty if it reaches the maximum constraint
+     */
+    void stop(const QString &reason);
+
+    Options options;
+    QString tmpPath;
+    QString sourcePath;
+    QString language;
+    QString solutionRunCommand;
+    QString solutionArgs;
+
+    QProcess *generator = nullptr;    // the generator of the current size
+    QTimer *generatorTimer = nullptr; // kills the generator when it runs for too long
+    Core::Runner *runner = nullptr;   // the current run of the solution
+    QString input;                    // the generated input of the current size
+    qint64 currentSize = 0;
+    int finishedRepeats = 0;
+    qint64 fastestTime = 0; // the fastest run of the current size
+    QVector<Sample> samples;
+};
+} // namespace Extensions
+
+#endif // COMPLEXITYESTIMATOR_HPP
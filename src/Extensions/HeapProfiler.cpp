@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Extensions/HeapProfiler.hpp"
+#include "Core/EventLogger.hpp"
+#include "Util/FileUtil.hpp"
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <algorithm>
+
+namespace Extensions
+{
+static const int COMPILE_TIME_LIMIT = 30000;  // the time limit of compiling the recorder, in milliseconds
+static const int ADDR2LINE_TIME_LIMIT = 5000; // the time limit of resolving the addresses of a report, in milliseconds
+
+HeapProfiler *HeapProfiler::instance()
+{
+    static auto *profiler = new HeapProfiler(qApp);
+    return profiler;
+}
+
+HeapProfiler::HeapProfiler(QObject *parent) : QObject(parent)
+{
+}
+
+HeapProfiler::~HeapProfiler()
+{
+    delete libraryDir;
+}
+
+bool HeapProfiler::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+void HeapProfiler::prepare(const QString &compiler)
+{
+    if (!libraryCompiler.isEmpty() && libraryCompiler == compiler && QFile::exists(libraryPath()))
+    {
+        emit prepared(compiler, QString());
+        return;
+    }
+
+    if (compileProcess != nullptr)
+    {
+        if (compilingCompiler == compiler)
+            return; // prepared is emitted when it finishes
+        failCompilation(tr("The compilation is stopped to compile with %1").arg(compiler));
+    }
+
+    LOG_INFO(INFO_OF(compiler));
+
+    libraryCompiler.clear();
+    delete libraryDir;
+    libraryDir = new QTemporaryDir();
+    if (!libraryDir->isValid())
+    {
+        emit prepared(compiler, tr("Failed to create the temporary directory"));
+        return;
+    }
+
+    auto source = Util::readFile(":/native/CPEditorHeapProfiler.cpp", "Heap Profiler");
+    auto sourcePath = libraryDir->filePath("CPEditorHeapProfiler.cpp");
+    if (source.isNull() || !Util::saveFile(sourcePath, source, "Heap Profiler", false))
+    {
+        emit prepared(compiler, tr("Failed to save the source file of the allocation recorder"));
+        return;
+    }
+
+    compilingCompiler = compiler;
+    auto *process = new QProcess(this);
+    compileProcess = process;
+    connect(compileProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &HeapProfiler::onCompileFinished);
+    connect(compileProcess, &QProcess::errorOccurred, this, &HeapProfiler::onCompileErrorOccurred);
+    QTimer::singleShot(COMPILE_TIME_LIMIT, compileProcess, [this, process] {
+        if (process != compileProcess)
+            return; // it's finished and waiting to be deleted
+        failCompilation(tr("Failed to compile the allocation recorder with %1: the time limit is exceeded")
+                            .arg(compilingCompiler));
+    });
+    compileProcess->start(compiler, {"-shared", "-fPIC", "-O2", "-o", libraryPath(), sourcePath, "-ldl"});
+}
+
+void HeapProfiler::onCompileFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (exitStatus != QProcess::NormalExit || exitCode != 0)
+    {
+        failCompilation(tr("Failed to compile the allocation recorder with %1:\n%2")
+                            .arg(compilingCompiler)
+                            .arg(QString::fromLocal8Bit(compileProcess->readAllStandardError())));
+        return;
+    }
+
+    compileProcess->deleteLater(); // this is called in the slot of the process
+    compileProcess = nullptr;
+    libraryCompiler = compilingCompiler;
+    emit prepared(libraryCompiler, QString());
+}
+
+void HeapProfiler::onCompileErrorOccurred(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart)
+        failCompilation(tr("Failed to start the compiler %1").arg(compilingCompiler));
+}
+
+void HeapProfiler::failCompilation(const QString &error)
+{
+    LOG_WARN(INFO_OF(error));
+    compileProcess->disconnect(this);
+    compileProcess->kill();
+    compileProcess->deleteLater();
+    compileProcess = nullptr;
+    emit prepared(compilingCompiler, error);
+}
+
+QString HeapProfiler::libraryPath() const
+{
+    return libraryDir == nullptr ? QString() : libraryDir->filePath("libcpeditorheapprofiler.so");
+}
+
+void HeapProfiler::readReport(const QString &reportPath, const QString &sourcePath)
+{
+    QFile file(reportPath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        emit reportRead(reportPath, QJsonObject(),
+                        tr("No report is written, the program may be killed or linked statically"));
+        return;
+    }
+
+    QJsonParseError parseError;
+    auto report = QJsonDocument::fromJson(file.readAll(), &parseError).object();
+    if (parseError.error != QJsonParseError::NoError)
+    {
+        emit reportRead(reportPath, QJsonObject(), tr("Failed to parse the report: %1").arg(parseError.errorString()));
+        return;
+    }
+
+    // resolve all addresses in one run of addr2line, -i prints the inlined functions from the innermost one
+    QStringList addresses;
+    for (const auto &site : report["sites"].toArray())
+    {
+        for (const auto &frame : site.toObject()["frames"].toArray())
+        {
+            if (!addresses.contains(frame.toString()))
+                addresses.push_back(frame.toString());
+        }
+    }
+
+    if (addresses.isEmpty())
+    {
+        emit reportRead(reportPath, mergeSites(report, Locations(), sourcePath), QString());
+        return;
+    }
+
+    // the report is still useful without the locations, so it's emitted even if addr2line fails
+    auto *addr2line = new QProcess(this);
+    auto finish = [this, addr2line, report, reportPath, sourcePath](bool resolved) {
+        addr2line->disconnect(this);
+        addr2line->deleteLater();
+        Locations locations;
+        if (resolved)
+            locations = parseLocations(QString::fromLocal8Bit(addr2line->readAllStandardOutput()));
+        else
+            LOG_WARN("addr2line failed, the allocation sites are not resolved");
+        emit reportRead(reportPath, mergeSites(report, locations, sourcePath), QString());
+    };
+    connect(addr2line, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            [finish](int exitCode, QProcess::ExitStatus exitStatus) {
+                finish(exitStatus == QProcess::NormalExit && exitCode == 0);
+            });
+    connect(addr2line, &QProcess::errorOccurred, this, [finish](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            finish(false);
+    });
+    QTimer::singleShot(ADDR2LINE_TIME_LIMIT, addr2line, [addr2line] { addr2line->kill(); });
+    addr2line->start("addr2line",
+                     QStringList{"-a", "-i", "-C", "-f", "-e", report["executable"].toString()} + addresses);
+}
+
+HeapProfiler::Locations HeapProfiler::parseLocations(const QString &output)
+{
+    static const QRegularExpression locationRegex(R"(^(.*):(\d+))");
+
+    Locations locations;
+    auto lines = output.split('\n');
+    quint64 current = 0;
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        if (lines[i].startsWith("0x"))
+        {
+            current = lines[i].toULongLong(nullptr, 16);
+        }
+        else if (i + 1 < lines.size() && !lines[i].isEmpty())
+        {
+            auto match = locationRegex.match(lines[i + 1]);
+            locations[current].push_back({lines[i], match.captured(1), match.captured(2)});
+            ++i;
+        }
+    }
+    return locations;
+}
+
+QJsonObject HeapProfiler::mergeSites(QJsonObject report, const Locations &locations, const QString &sourcePath)
+{
+    auto canonicalSource = QFileInfo(sourcePath).canonicalFilePath();
+
+    // a site is the first line in the source file on the call stack, or the first function if there is none
+    struct Site
+    {
+        QString location;
+        qint64 count = 0;
+        qint64 bytes = 0;
+    };
+    QVector<Site> sites;
+    for (const auto &siteValue : report["sites"].toArray())
+    {
+        auto siteObject = siteValue.toObject();
+        QString location;
+        QString fallback;
+        for (const auto &frame : siteObject["frames"].toArray())
+        {
+            for (const auto &entry : locations.value(frame.toString().toULongLong(nullptr, 16)))
+            {
+                if (fallback.isEmpty())
+                    fallback = entry[0];
+                if (!entry[1].isEmpty() && QFileInfo(entry[1]).canonicalFilePath() == canonicalSource)
+                {
+                    location = tr("line %1 in %2").arg(entry[2]).arg(entry[0]);
+                    break;
+                }
+            }
+            if (!location.isEmpty())
+                break;
+        }
+        if (location.isEmpty())
+            location = fallback.isEmpty() ? tr("unknown") : fallback;
+
+        auto it = std::find_if(sites.begin(), sites.end(), [&](const Site &site) { return site.location == location; });
+        if (it == sites.end())
+            it = sites.insert(sites.end(), Site{location, 0, 0});
+        it->count += siteObject["count"].toVariant().toLongLong();
+        it->bytes += siteObject["bytes"].toVariant().toLongLong();
+    }
+
+    std::stable_sort(sites.begin(), sites.end(), [](const Site &a, const Site &b) { return a.count > b.count; });
+
+    QJsonArray siteArray;
+    for (const auto &site : sites)
+        siteArray.push_back(QJsonObject{{"location", site.location}, {"count", site.count}, {"bytes", site.bytes}});
+    report["sites"] = siteArray;
+    report.remove("executable");
+    return report;
+}
+} // namespace Extensions
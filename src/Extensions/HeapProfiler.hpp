@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The HeapProfiler supports the heap profiling run mode of C++ programs.
+ * The allocation recorder is saved in the Qt Resources, and it's compiled into a shared library on the first use.
+ * Core::Runner preloads the library into the program by LD_PRELOAD, and the library writes a JSON report at exit.
+ * The report is read back here, and the call stacks are mapped to the lines of the source file by addr2line.
+ * Both the compilation and addr2line are asynchronous processes, the results are returned by the signals.
+ * It only works on Linux with glibc, and not for programs linked statically.
+ */
+
+#ifndef HEAPPROFILER_HPP
+#define HEAPPROFILER_HPP
+
+#include <QHash>
+#include <QJsonObject>
+#include <QProcess>
+#include <QStringList>
+#include <QVector>
+
+class QTemporaryDir;
+
+namespace Extensions
+{
+class HeapProfiler : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief get the global heap profiler
+     */
+    static HeapProfiler *instance();
+
+    ~HeapProfiler() override;
+
+    /**
+     * @brief whether heap profiling is supported on the current platform
+     */
+    static bool isSupported();
+
+    /**
+     * @brief compile the allocation recorder if it's not compiled by the same compiler
+     * @param compiler the C++ compiler, the first part of the C++ compile command
+     * @note prepared is emitted when the recorder is ready or it fails, it's emitted immediately if it's ready.
+     *       The compilation with another compiler is stopped, and prepared is emitted with an error for it.
+     */
+    void prepare(const QString &compiler);
+
+    /**
+     * @brief the path to the compiled shared library, used as LD_PRELOAD
+     */
+    QString libraryPath() const;
+
+    /**
+     * @brief read a report written by the recorder, and map the call stacks to the source file
+     * @param reportPath the path of the report
+     * @param sourcePath the path to the compiled source file, the lines in it are used as the allocation sites
+     * @note reportRead is emitted when it finishes, it may be emitted before this returns
+     */
+    void readReport(const QString &reportPath, const QString &sourcePath);
+
+  signals:
+    /**
+     * @param compiler the compiler passed to prepare()
+     * @param error the reason if it fails, empty if the recorder is ready
+     */
+    void prepared(const QString &compiler, const QString &error);
+
+    /**
+     * @param reportPath the report path passed to readReport()
+     * @param report the report with the sites merged by their locations, or an empty object if it fails
+     * @param error the reason if it fails
+     */
+    void reportRead(const QString &reportPath, const QJsonObject &report, const QString &error);
+
+  private slots:
+    void onCompileFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void onCompileErrorOccurred(QProcess::ProcessError error);
+
+  private:
+    // address -> [(function, file, line)], from the innermost inlined function to the real function
+    using Locations = QHash<quint64, QVector<QStringList>>;
+
+    explicit HeapProfiler(QObject *parent = nullptr);
+
+    /**
+     * @brief stop the compilation and emit prepared with the error
+     */
+    void failCompilation(const QString &error);
+
+    /**
+     * @brief parse the output of addr2line -a -i -f
+     */
+    static Locations parseLocations(const QString &output);
+
+    /**
+     * @brief merge the sites of a report by their locations in the source file
+     */
+    static QJsonObject mergeSites(QJsonObject report, const Locations &locations, const QString &sourcePath);
+
+    QTemporaryDir *libraryDir = nullptr; // the directory of the source and the library of the recorder
+    QString libraryCompiler;            // the compiler used to compile the library, empty if it's not compiled
+    QProcess *compileProcess = nullptr; // the running compilation of the library
+    QString compilingCompiler;          // the compiler of compileProcess
+};
+} // namespace Extensions
+
+#endif // HEAPPROFILER_HPP
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Extensions/JavaRunServer.hpp"
+#include "Core/EventLogger.hpp"
+#include "Util/FileUtil.hpp"
+#include <QCoreApplication>
+#include <QTemporaryDir>
+
+namespace Extensions
+{
+
+JavaRunServer *JavaRunServer::instance()
+{
+    static auto *server = new JavaRunServer(qApp);
+    return server;
+}
+
+JavaRunServer::JavaRunServer(QObject *parent) : QObject(parent)
+{
+}
+
+JavaRunServer::~JavaRunServer()
+{
+    stop();
+}
+
+void JavaRunServer::start(const QString &compileCommand, const QString &runCommand)
+{
+    if (state != NotStarted && (compileCommand != currentCompileCommand || runCommand != currentRunCommand))
+    {
+        LOG_INFO("The Java commands are changed, restarting the Java run server");
+        stop();
+    }
+
+    if (state != NotStarted)
+        return;
+
+    LOG_INFO(INFO_OF(compileCommand) << INFO_OF(runCommand));
+
+    currentCompileCommand = compileCommand;
+    currentRunCommand = runCommand;
+
+    classDir = new QTemporaryDir();
+    if (!classDir->isValid())
+    {
+        setUnavailable("Failed to create the temporary directory");
+        return;
+    }
+
+    auto source = Util::readFile(":/java/CPEditorRunServer.java", "Java Run Server");
+    auto sourcePath = classDir->filePath("CPEditorRunServer.java");
+    if (source.isNull() || !Util::saveFile(sourcePath, source, "Java Run Server", false))
+    {
+        setUnavailable("Failed to save the source file of the server");
+        return;
+    }
+
+    auto args = QProcess::splitCommand(compileCommand);
+    if (args.isEmpty())
+    {
+        setUnavailable("The compile command is empty");
+        return;
+    }
+    auto program = args.takeFirst();
+    args << "-d" << classDir->path() << sourcePath;
+
+    state = Compiling;
+
+    compileProcess = new QProcess(this);
+    connect(compileProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &JavaRunServer::onCompileFinished);
+    connect(compileProcess, &QProcess::errorOccurred, this, &JavaRunServer::onProcessErrorOccurred);
+    compileProcess->start(program, args);
+}
+
+void JavaRunServer::stop()
+{
+    LOG_INFO_IF(state != NotStarted, "Stopping the Java run server");
+
+    // the processes are killed in the destructor of QProcess
+    delete compileProcess;
+    compileProcess = nullptr;
+    delete serverProcess;
+    serverProcess = nullptr;
+    delete classDir;
+    classDir = nullptr;
+
+    state = NotStarted;
+    allowSecurityManager = true;
+    serverPort = 0;
+}
+
+bool JavaRunServer::isReady() const
+{
+    return state == Ready;
+}
+
+quint16 JavaRunServer::port() const
+{
+    return serverPort;
+}
+
+qint64 JavaRunServer::startupTime() const
+{
+    return serverStartupTime;
+}
+
+void JavaRunServer::onCompileFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (exitStatus != QProcess::NormalExit || exitCode != 0)
+    {
+        setUnavailable("Failed to compile the server: " + compileProcess->readAllStandardError());
+        return;
+    }
+
+    compileProcess->deleteLater();
+    compileProcess = nullptr;
+
+    launch();
+}
+
+void JavaRunServer::launch()
+{
+    auto args = QProcess::splitCommand(currentRunCommand);
+    if (args.isEmpty())
+    {
+        setUnavailable("The run command is empty");
+        return;
+    }
+    auto program = args.takeFirst();
+    if (allowSecurityManager)
+        args << "-Djava.security.manager=allow"; // the server intercepts System.exit by a SecurityManager
+    args << "-classpath" << classDir->path() << "CPEditorRunServer";
+
+    LOG_INFO(INFO_OF(program) << INFO_OF(args.join(' ')));
+
+    state = Starting;
+    serverStdout.clear();
+
+    serverProcess = new QProcess(this);
+    connect(serverProcess, &QProcess::readyReadStandardOutput, this, &JavaRunServer::onServerReadyReadStandardOutput);
+    connect(serverProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &JavaRunServer::onServerFinished);
+    connect(serverProcess, &QProcess::errorOccurred, this, &JavaRunServer::onProcessErrorOccurred);
+
+    startupTimer.start();
+    serverProcess->start(program, args);
+}
+
+void JavaRunServer::setUnavailable(const QString &reason)
+{
+    LOG_WARN("The Java run server is unavailable, plain java will be used. " << INFO_OF(reason));
+    state = Unavailable;
+}
+
+void JavaRunServer::onServerReadyReadStandardOutput()
+{
+    auto *process = qobject_cast<QProcess *>(sender());
+    if (process == nullptr)
+        return;
+
+    if (process != serverProcess || state != Starting)
+    {
+        process->readAllStandardOutput(); // the server prints nothing after it's ready
+        return;
+    }
+
+    serverStdout.append(process->readAllStandardOutput());
+    int lineEnd = serverStdout.indexOf('\n');
+    if (lineEnd == -1)
+        return;
+
+    auto line = QString::fromUtf8(serverStdout.left(lineEnd)).trimmed();
+
+    if (line.startsWith("READY "))
+    {
+        serverPort = line.mid(6).toUShort();
+        serverStartupTime = startupTimer.elapsed();
+        state = Ready;
+        LOG_INFO("The Java run server is ready. " << INFO_OF(serverPort) << INFO_OF(serverStartupTime));
+        emit ready();
+    }
+    else
+    {
+        setUnavailable(line);
+    }
+}
+
+void JavaRunServer::onServerFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    auto *process = qobject_cast<QProcess *>(sender());
+    if (process != serverProcess)
+        return;
+
+    LOG_INFO(INFO_OF(exitCode) << INFO_OF(exitStatus) << INFO_OF(state));
+
+    serverProcess->deleteLater();
+    serverProcess = nullptr;
+
+    if (state == Starting && allowSecurityManager)
+    {
+        // Java 11 and earlier versions don't accept "allow" as the security manager, try again without it
+        allowSecurityManager = false;
+        launch();
+    }
+    else if (state == Starting)
+    {
+        setUnavailable(QString("The server exited with exit code %1 during start-up").arg(exitCode));
+    }
+    else if (state == Ready)
+    {
+        // the server halts itself when a run can't be stopped safely, start a new one for the next runs
+        launch();
+    }
+}
+
+void JavaRunServer::onProcessErrorOccurred(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart)
+        setUnavailable(QString("Failed to start %1").arg(qobject_cast<QProcess *>(sender())->program()));
+}
+
+} // namespace Extensions
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The JavaRunServer manages a long-lived JVM which runs compiled Java solutions in isolated class loaders.
+ * The source of the server is saved in the Qt Resources, and is compiled during the runtime.
+ * Core::Runner sends runs to it when it's ready, and falls back to plain `java` otherwise.
+ * Core::Compiler can also send Java compilations to it, which are compiled by javax.tools.JavaCompiler.
+ * There is only one server in a session, it's shared by all tabs.
+ */
+
+#ifndef JAVARUNSERVER_HPP
+#define JAVARUNSERVER_HPP
+
+#include <QElapsedTimer>
+#include <QProcess>
+
+class QTemporaryDir;
+
+namespace Extensions
+{
+class JavaRunServer : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // the type of a request, sent at the beginning of each request
+    enum RequestType
+    {
+        RunRequest = 0,
+        CompileRequest = 1
+    };
+
+    // the status of a run or a compilation, sent by the server
+    enum RunStatus
+    {
+        Finished = 0,
+        TimeLimitExceeded = 1,
+        OutputLimitExceeded = 2,
+        FailedToStart = 3
+    };
+
+    /**
+     * @brief get the global server
+     * @note the server is not started until start() is called
+     */
+    static JavaRunServer *instance();
+
+    ~JavaRunServer() override;
+
+    /**
+     * @brief compile and start the server if it's not started
+     * @param compileCommand the command used to compile Java
+     * @param runCommand the command used to start Java programs
+     * @note The server is restarted if the commands are changed.
+     *       It's asynchronous, runs before the server is ready should fall back to plain `java`.
+     */
+    void start(const QString &compileCommand, const QString &runCommand);
+
+    /**
+     * @brief stop the server, it can be started again by start()
+     */
+    void stop();
+
+    /**
+     * @brief whether the server is ready to accept runs
+     */
+    bool isReady() const;
+
+    /**
+     * @brief the TCP port on localhost that the server listens on
+     */
+    quint16 port() const;
+
+    /**
+     * @brief the time used to start the JVM of the server, in milliseconds
+     */
+    qint64 startupTime() const;
+
+  signals:
+    /**
+     * @brief the server is ready to accept runs
+     */
+    void ready();
+
+  private slots:
+    void onCompileFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void onServerReadyReadStandardOutput();
+
+    void onServerFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void onProcessErrorOccurred(QProcess::ProcessError error);
+
+  private:
+    enum State
+    {
+        NotStarted,
+        Compiling,
+        Starting,
+        Ready,
+        Unavailable // failed to compile or start the server, plain `java` is used in this session
+    };
+
+    explicit JavaRunServer(QObject *parent = nullptr);
+
+    /**
+     * @brief start the JVM of the server, the server class should be compiled
+     */
+    void launch();
+
+    /**
+     * @brief mark the server as unavailable
+     * @param reason the reason, written in the event logs
+     */
+    void setUnavailable(const QString &reason);
+
+    State state = NotStarted;
+    QProcess *compileProcess = nullptr;   // the javac process which compiles the server
+    QProcess *serverProcess = nullptr;    // the JVM of the server
+    QTemporaryDir *classDir = nullptr;    // the directory of the source and the class files of the server
+    QString currentCompileCommand;        // the compile command used to compile the running server
+    QString currentRunCommand;            // the run command used to start the running server
+    QByteArray serverStdout;              // the stdout of the server before it is ready
+    bool allowSecurityManager = true;     // whether to add -Djava.security.manager=allow, required since Java 18
+    quint16 serverPort = 0;               // the port the server listens on
+    QElapsedTimer startupTimer;           // the timer to measure the start-up time of the JVM
+    qint64 serverStartupTime = 0;         // the start-up time of the JVM
+};
+} // namespace Extensions
+
+#endif // JAVARUNSERVER_HPP
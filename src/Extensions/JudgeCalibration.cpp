@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Extensions/JudgeCalibration.hpp"
+#include "Core/EventLogger.hpp"
+#include "Util/FileUtil.hpp"
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <generated/SettingsHelper.hpp>
+
+namespace Extensions
+{
+
+// the fastest of several runs is used, to reduce the noise of other programs running at the same time
+static const int BENCHMARK_RUNS = 3;
+
+JudgeCalibration::JudgeCalibration(QObject *parent) : QObject(parent)
+{
+}
+
+JudgeCalibration::~JudgeCalibration()
+{
+    if (process != nullptr)
+    {
+        process->disconnect(this);
+        delete process; // the process is killed in the destructor of QProcess
+    }
+    delete workDir;
+}
+
+void JudgeCalibration::start(const QString &compileCommand)
+{
+    LOG_INFO(INFO_OF(compileCommand));
+
+    workDir = new QTemporaryDir();
+    if (!workDir->isValid())
+    {
+        fail(tr("Failed to create the temporary directory"));
+        return;
+    }
+
+    auto sourcePath = workDir->filePath("CPEditorCalibration.cpp");
+    if (!Util::saveFile(sourcePath, benchmarkSource(), "Judge Calibration", false))
+    {
+        fail(tr("Failed to save the source file of the benchmark"));
+        return;
+    }
+
+    auto args = QProcess::splitCommand(compileCommand);
+    if (args.isEmpty())
+    {
+        fail(tr("The compile command is empty"));
+        return;
+    }
+    auto program = args.takeFirst();
+    args << sourcePath << "-o" << workDir->filePath("calibration");
+
+    compiling = true;
+    process = new QProcess(this);
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &JudgeCalibration::onProcessFinished);
+    connect(process, &QProcess::errorOccurred, this, &JudgeCalibration::onProcessErrorOccurred);
+    process->start(program, args);
+}
+
+QString JudgeCalibration::benchmarkSource()
+{
+    return Util::readFile(":/native/CPEditorCalibration.cpp", "Judge Calibration");
+}
+
+int JudgeCalibration::scaledTimeLimit(int timeLimit, const QString &problemURL, QString *judge)
+{
+    if (judge != nullptr)
+        judge->clear();
+
+    int localScore = SettingsHelper::getJudgeSpeedLocalScore();
+    if (!SettingsHelper::isJudgeSpeedEnable() || localScore <= 0 || problemURL.isEmpty())
+        return timeLimit;
+
+    for (auto const &rule : SettingsHelper::getJudgeSpeedJudges())
+    {
+        auto columns = rule.toStringList();
+        if (columns.size() < 3 || columns[0].isEmpty())
+            continue;
+        if (!QRegularExpression(columns[0]).match(problemURL).hasMatch())
+            continue;
+        int judgeScore = columns[2].toInt();
+        if (judgeScore <= 0)
+            continue;
+        if (judge != nullptr)
+            *judge = columns[1];
+        // a judge with a higher score is slower, so the local machine has less time
+        return std::max(1, qRound(double(timeLimit) * localScore / judgeScore));
+    }
+
+    return timeLimit;
+}
+
+void JudgeCalibration::runBenchmark()
+{
+    compiling = false;
+    process->start(workDir->filePath("calibration"), QStringList());
+}
+
+void JudgeCalibration::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    auto error = QString::fromLocal8Bit(process->readAllStandardError()).trimmed();
+
+    if (compiling)
+    {
+        if (exitStatus != QProcess::NormalExit || exitCode != 0)
+        {
+            fail(tr("Failed to compile the benchmark:\n%1").arg(error));
+            return;
+        }
+        runBenchmark();
+        return;
+    }
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0)
+    {
+        fail(tr("The benchmark exited with code %1:\n%2").arg(exitCode).arg(error));
+        return;
+    }
+
+    // each line is like "sorting 397", and the last line is the total
+    auto lines = QString::fromUtf8(process->readAllStandardOutput()).split('\n');
+    QVector<Kernel> kernels;
+    for (const auto &line : lines)
+    {
+        auto parts = line.trimmed().split(' ');
+        if (parts.size() == 2 && parts[0] != "total")
+            kernels.push_back(Kernel{parts[0], parts[1].toLongLong()});
+    }
+
+    if (kernels.isEmpty() || (!result.kernels.isEmpty() && kernels.size() != result.kernels.size()))
+    {
+        fail(tr("Unexpected output of the benchmark"));
+        return;
+    }
+
+    if (result.kernels.isEmpty())
+        result.kernels = kernels;
+    for (int i = 0; i < kernels.size(); ++i)
+        result.kernels[i].time = std::min(result.kernels[i].time, kernels[i].time);
+
+    emit progress(++finishedRuns, BENCHMARK_RUNS);
+
+    if (finishedRuns < BENCHMARK_RUNS)
+    {
+        runBenchmark();
+        return;
+    }
+
+    result.score = 0;
+    for (const auto &kernel : result.kernels)
+        result.score += kernel.time;
+
+    LOG_INFO(INFO_OF(result.score));
+
+    process->deleteLater();
+    process = nullptr;
+    emit finished(result);
+}
+
+void JudgeCalibration::onProcessErrorOccurred(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart)
+        return;
+
+    if (compiling)
+        fail(tr("Failed to start the compiler"));
+    else
+        fail(tr("Failed to start the benchmark"));
+}
+
+void JudgeCalibration::fail(const QString &reason)
+{
+    LOG_WARN(INFO_OF(reason));
+    if (process != nullptr)
+    {
+        process->deleteLater(); // this is called in the slots of the process
+        process = nullptr;
+    }
+    emit failed(reason);
+}
+
+} // namespace Extensions
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The JudgeCalibration compares the speed of the local machine with the speed of the online judges.
+ * The benchmark is saved in the Qt Resources, compiled with the C++ compile command, and run several times.
+ * The total time of the benchmark is the score of the machine, and the score of a judge can be measured by running
+ * the same benchmark on its custom invocation. The time limit of a problem is scaled by the ratio of the scores,
+ * and the judge of a problem is found by its URL.
+ */
+
+#ifndef JUDGECALIBRATION_HPP
+#define JUDGECALIBRATION_HPP
+
+#include <QProcess>
+#include <QVector>
+
+class QTemporaryDir;
+
+namespace Extensions
+{
+class JudgeCalibration : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // a kernel of the benchmark and its fastest time in milliseconds
+    struct Kernel
+    {
+        QString name;
+        qint64 time = 0;
+    };
+
+    struct Result
+    {
+        QVector<Kernel> kernels;
+        qint64 score = 0; // the total time of the kernels
+    };
+
+    explicit JudgeCalibration(QObject *parent = nullptr);
+
+    /**
+     * @brief destruct the calibration
+     * @note the running benchmark is killed
+     */
+    ~JudgeCalibration() override;
+
+    /**
+     * @brief compile and run the benchmark
+     * @param compileCommand the C++ compile command, the same command used to compile the solutions
+     * @note This should be called only once. Either finished or failed will be emitted.
+     */
+    void start(const QString &compileCommand);
+
+    /**
+     * @brief the source of the benchmark, to be run on the judges
+     */
+    static QString benchmarkSource();
+
+    /**
+     * @brief scale the time limit of a problem to the local machine
+     * @param timeLimit the time limit on the judge, in milliseconds
+     * @param problemURL the URL of the problem, used to find the judge
+     * @param judge the name of the matched judge, set to empty if no judge is matched
+     * @returns the effective time limit on the local machine, the same as timeLimit if it's not calibrated
+     */
+    static int scaledTimeLimit(int timeLimit, const QString &problemURL, QString *judge = nullptr);
+
+  signals:
+    /**
+     * @brief a run of the benchmark is finished
+     */
+    void progress(int finishedRuns, int totalRuns);
+
+    void finished(const Extensions::JudgeCalibration::Result &result);
+
+    void failed(const QString &reason);
+
+  private slots:
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void onProcessErrorOccurred(QProcess::ProcessError error);
+
+  private:
+    /**
+     * @brief run the compiled benchmark once
+     */
+    void runBenchmark();
+
+    /**
+     * @brief emit failed and stop
+     */
+    void fail(const QString &reason);
+
+    QProcess *process = nullptr;      // the compiler or the benchmark
+    QTemporaryDir *workDir = nullptr; // the directory of the source and the executable of the benchmark
+    bool compiling = true;
+    int finishedRuns = 0;
+    Result result;
+};
+} // namespace Extensions
+
+#endif // JUDGECALIBRATION_HPP
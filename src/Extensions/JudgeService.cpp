@@ -0,0 +1,386 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Extensions/JudgeService.hpp"
+#include "Core/Checker.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/Runner.hpp"
+#include "Settings/SettingsInfo.hpp"
+#include "Settings/SettingsManager.hpp"
+#include "generated/SettingsHelper.hpp"
+#include "generated/version.hpp"
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QFile>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTimer>
+#include <iostream>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+static const QString SERVICE_ARGUMENT = "--judge-service";
+static const int MAX_RESTARTS = 3;             // the service is unavailable after crashing too many times
+static const int PARENT_WATCH_INTERVAL = 1000; // the interval to check whether the editor is still alive
+
+namespace
+{
+/*
+ * A Session serves the run of one connection in the service process.
+ * The request is a QDataStream of the type, the arguments of Core::Runner::run, the forwarded settings, and the
+ * arguments of Core::Runner::setJudgeOnService, whose checker type is -1 if it's not called.
+ * The response of a finished run is the result, the verdict, and the stdout and the stderr. If the checker type is set,
+ * the output is checked by the built-in checker here, and a stdout too long to be displayed is saved to the file of
+ * the whole output, only the beginning of it is sent. Otherwise, the whole stdout and stderr are sent.
+ * The program is killed when the editor disconnects before it finishes.
+ */
+class Session : public QObject
+{
+  public:
+    explicit Session(QLocalSocket *socket) : QObject(socket), socket(socket)
+    {
+        connect(socket, &QLocalSocket::readyRead, this, &Session::onReadyRead);
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    }
+
+    ~Session() override
+    {
+        if (runner != nullptr)
+        {
+            runner->disconnect(this);
+            delete runner;
+        }
+    }
+
+  private:
+    void onReadyRead()
+    {
+        QDataStream request(socket);
+        request.setVersion(QDataStream::Qt_5_0);
+
+        qint32 type = 0;
+        QString tmpFilePath, sourceFilePath, lang, runCommand, args;
+        QByteArray input;
+        qint32 timeLimit = 0;
+        QVariantMap settings;
+        QByteArray expectedBytes;
+
+        request.startTransaction();
+        request >> type >> tmpFilePath >> sourceFilePath >> lang >> runCommand >> args >> input >> timeLimit >>
+            settings >> checkerType >> expectedBytes >> wholeOutputPath;
+        if (!request.commitTransaction())
+            return; // wait for the rest of the request
+
+        if (runner != nullptr || type != Extensions::JudgeService::RunRequest)
+        {
+            socket->abort();
+            return;
+        }
+
+        for (auto it = settings.constBegin(); it != settings.constEnd(); ++it)
+            SettingsManager::set(it.key(), it.value());
+        expected = QString::fromUtf8(expectedBytes);
+
+        runner = new Core::Runner(0);
+        connect(runner, &Core::Runner::runStarted, this, [this] { send(Extensions::JudgeService::Started); });
+        connect(runner, &Core::Runner::runOutputLimitExceeded, this,
+                [this](int, const QString &type) { outputLimitExceeded = type; });
+        connect(runner, &Core::Runner::failedToStartRun, this, [this](int, const QString &error) {
+            QByteArray message;
+            QDataStream response(&message, QIODevice::WriteOnly);
+            response.setVersion(QDataStream::Qt_5_0);
+            response << qint32(Extensions::JudgeService::FailedToStart) << error;
+            socket->write(message);
+        });
+        connect(runner, &Core::Runner::runFinished, this, &Session::onRunFinished);
+        runner->run(tmpFilePath, sourceFilePath, lang, runCommand, args, QString::fromUtf8(input), timeLimit);
+    }
+
+    void onRunFinished(int /* index */, const QString &out, const QString &err, int exitCode, qint64 timeUsed,
+                       bool tle)
+    {
+        auto stdoutToSend = out;
+        auto stderrToSend = err;
+        auto verdict = Widgets::TestCase::UNKNOWN;
+        bool elided = false;
+
+        if (checkerType != -1)
+        {
+            auto type = static_cast<Core::Checker::CheckerType>(checkerType);
+            // the same condition as the check in the editor
+            if (exitCode == 0 &&
+                ((!out.isEmpty() && !expected.isEmpty()) || SettingsHelper::isCheckOnTestcasesWithEmptyOutput()))
+                verdict = Core::Checker::checkBuiltIn(type, out, expected);
+
+            // one more character than displayed, so the editor shows that it's elided
+            int limit = SettingsHelper::getOutputDisplayLengthLimit();
+            if (out.length() > limit + 1)
+            {
+                QFile file(wholeOutputPath);
+                if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(out.toUtf8()) == -1)
+                {
+                    LOG_WARN("Failed to save the whole output. " << INFO_OF(wholeOutputPath)
+                                                                 << INFO_OF(file.errorString()));
+                    // the program has run, so it's not run again in the editor
+                    QByteArray message;
+                    QDataStream response(&message, QIODevice::WriteOnly);
+                    response.setVersion(QDataStream::Qt_5_0);
+                    response << qint32(Extensions::JudgeService::Failed) << file.errorString();
+                    socket->write(message);
+                    return;
+                }
+                stdoutToSend = out.left(limit + 1);
+                elided = true;
+            }
+            // the stderr is shown in the message logger, only its beginning is sent
+            if (err.length() > limit)
+                stderrToSend = err.left(limit) + "...";
+        }
+
+        QByteArray message;
+        QDataStream response(&message, QIODevice::WriteOnly);
+        response.setVersion(QDataStream::Qt_5_0);
+        response << qint32(Extensions::JudgeService::Finished) << qint32(exitCode) << timeUsed << tle
+                 << outputLimitExceeded << qint32(verdict) << elided << stdoutToSend << stderrToSend;
+        socket->write(message);
+    }
+
+    void send(Extensions::JudgeService::ResponseType type)
+    {
+        QByteArray message;
+        QDataStream response(&message, QIODevice::WriteOnly);
+        response.setVersion(QDataStream::Qt_5_0);
+        response << qint32(type);
+        socket->write(message);
+    }
+
+    QLocalSocket *socket;           // the connection to the editor
+    Core::Runner *runner = nullptr; // the runner of the run, nullptr before the request is received
+    QString outputLimitExceeded;    // the type of the exceeded output, empty if the output limit is not exceeded
+    qint32 checkerType = -1;        // the checker type of Core::Runner::setJudgeOnService, -1 if it's not set
+    QString expected;               // the expected output checked by the built-in checker
+    QString wholeOutputPath;        // the file where a long stdout is saved
+};
+} // namespace
+
+namespace Extensions
+{
+
+JudgeService *JudgeService::instance()
+{
+    static auto *service = new JudgeService(qApp);
+    return service;
+}
+
+JudgeService::JudgeService(QObject *parent) : QObject(parent)
+{
+}
+
+JudgeService::~JudgeService()
+{
+    stop();
+}
+
+void JudgeService::start()
+{
+    if (state != NotStarted)
+        return;
+
+    name = QString("cpeditor-judge-%1").arg(QCoreApplication::applicationPid());
+    launch();
+}
+
+void JudgeService::stop()
+{
+    LOG_INFO_IF(state != NotStarted, "Stopping the judge service");
+
+    // the process is killed in the destructor of QProcess
+    delete process;
+    process = nullptr;
+
+    state = NotStarted;
+}
+
+bool JudgeService::isReady() const
+{
+    return state == Ready;
+}
+
+QString JudgeService::serverName() const
+{
+    return name;
+}
+
+QStringList JudgeService::forwardedSettings()
+{
+    return {"Output Length Limit", "Output Display Length Limit", "Check On Testcases With Empty Output",
+            "Java/Class Name", "Fast Process Launcher"};
+}
+
+bool JudgeService::isServiceRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (QString(argv[i]) == SERVICE_ARGUMENT) // NOLINT: Pointer arithmetics?
+            return true;
+    }
+    return false;
+}
+
+int JudgeService::execService(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("CP Editor");
+    QCoreApplication::setApplicationVersion(DISPLAY_VERSION);
+
+    auto arguments = QCoreApplication::arguments();
+    int nameIndex = arguments.indexOf(SERVICE_ARGUMENT) + 1;
+    if (nameIndex >= arguments.length())
+    {
+        std::cout << "The name of the local server is missing" << std::endl;
+        return 2;
+    }
+    auto serverName = arguments[nameIndex];
+
+    Core::Log::init(static_cast<unsigned int>(QCoreApplication::applicationPid()));
+
+    SettingsInfo::updateSettingInfo();
+    SettingsManager::init();
+    // the service runs the programs itself
+    SettingsManager::set("Judge Service/Enable", false);
+    SettingsManager::set("Java Run Server/Enable", false);
+
+    QLocalServer server;
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    QLocalServer::removeServer(serverName);
+    if (!server.listen(serverName))
+    {
+        std::cout << "Failed to listen on " << serverName.toStdString() << ": " << server.errorString().toStdString()
+                  << std::endl;
+        return 1;
+    }
+
+    QObject::connect(&server, &QLocalServer::newConnection, &server, [&server] {
+        while (server.hasPendingConnections())
+            new Session(server.nextPendingConnection());
+    });
+
+#ifdef Q_OS_UNIX
+    // the service is killed when the editor exits normally, this handles the crashes of the editor
+    auto parent = getppid();
+    auto *parentWatch = new QTimer(&app);
+    QObject::connect(parentWatch, &QTimer::timeout, &app, [parent] {
+        if (getppid() != parent)
+            QCoreApplication::exit(0);
+    });
+    parentWatch->start(PARENT_WATCH_INTERVAL);
+#endif
+
+    LOG_INFO("The judge service is listening. " << INFO_OF(serverName));
+    std::cout << "READY" << std::endl;
+
+    return QCoreApplication::exec();
+}
+
+void JudgeService::launch()
+{
+    LOG_INFO(INFO_OF(name));
+
+    state = Starting;
+    serviceStdout.clear();
+
+    process = new QProcess(this);
+    process->setStandardErrorFile(QProcess::nullDevice());
+    connect(process, &QProcess::readyReadStandardOutput, this, &JudgeService::onReadyReadStandardOutput);
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, &JudgeService::onFinished);
+    connect(process, &QProcess::errorOccurred, this, &JudgeService::onErrorOccurred);
+    process->start(QCoreApplication::applicationFilePath(), {SERVICE_ARGUMENT, name});
+}
+
+void JudgeService::setUnavailable(const QString &reason)
+{
+    LOG_WARN("The judge service is unavailable, the programs will be run in the editor. " << INFO_OF(reason));
+    state = Unavailable;
+}
+
+void JudgeService::onReadyReadStandardOutput()
+{
+    auto *service = qobject_cast<QProcess *>(sender());
+    if (service == nullptr)
+        return;
+
+    if (service != process || state != Starting)
+    {
+        service->readAllStandardOutput(); // the service prints nothing after it's ready
+        return;
+    }
+
+    serviceStdout.append(service->readAllStandardOutput());
+    int lineEnd = serviceStdout.indexOf('\n');
+    if (lineEnd == -1)
+        return;
+
+    auto line = QString::fromUtf8(serviceStdout.left(lineEnd)).trimmed();
+
+    if (line == "READY")
+    {
+        state = Ready;
+        LOG_INFO("The judge service is ready");
+        emit ready();
+    }
+    else
+    {
+        setUnavailable(line);
+    }
+}
+
+void JudgeService::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    auto *service = qobject_cast<QProcess *>(sender());
+    if (service != process)
+        return;
+
+    LOG_INFO(INFO_OF(exitCode) << INFO_OF(exitStatus) << INFO_OF(state));
+
+    process->deleteLater();
+    process = nullptr;
+
+    if (state == Starting)
+    {
+        setUnavailable(QString("The service exited with exit code %1 during start-up").arg(exitCode));
+    }
+    else if (state == Ready && restarts < MAX_RESTARTS)
+    {
+        // the runs on the crashed service are failed, start a new one for the next runs
+        ++restarts;
+        launch();
+    }
+    else if (state == Ready)
+    {
+        setUnavailable("The service crashed too many times");
+    }
+}
+
+void JudgeService::onErrorOccurred(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart)
+        setUnavailable(QString("Failed to start %1").arg(qobject_cast<QProcess *>(sender())->program()));
+}
+
+} // namespace Extensions
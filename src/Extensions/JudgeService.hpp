@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The JudgeService runs the programs in a separate process, so a crash while running or checking a program can't lose
+ * the unsaved code.
+ * The service is the same executable started with --judge-service, it runs the programs by Core::Runner and talks
+ * to the editor over a local socket. For the runs of the test cases, the built-in checkers run in the service too, and
+ * only the verdict and the beginning of a long output are sent back. The whole output is saved to a file in the
+ * temporary directory of the tab, and the editor reads it only when it's needed, e.g. by the diff viewer.
+ * Core::Runner sends runs to it when it's enabled and ready, and runs the programs itself otherwise.
+ * There is only one service in a session, it's shared by all tabs, and it's restarted when it crashes.
+ * The runs interrupted by a crash are reported as failed, they are not run again because the programs may have run.
+ */
+
+#ifndef JUDGESERVICE_HPP
+#define JUDGESERVICE_HPP
+
+#include <QProcess>
+
+namespace Extensions
+{
+class JudgeService : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // the type of a request, sent at the beginning of each request
+    enum RequestType
+    {
+        RunRequest = 0
+    };
+
+    // the type of a message sent by the service for a run
+    enum ResponseType
+    {
+        Started = 0,       // the program is started
+        Finished = 1,      // the program is finished, followed by the result
+        FailedToStart = 2, // the program can't be started, followed by the error
+        Failed = 3         // the program has run but the result can't be sent, followed by the error
+    };
+
+    /**
+     * @brief get the global service
+     * @note the service is not started until start() is called
+     */
+    static JudgeService *instance();
+
+    ~JudgeService() override;
+
+    /**
+     * @brief start the service process if it's not started
+     * @note It's asynchronous, runs before the service is ready should be run in the editor process.
+     */
+    void start();
+
+    /**
+     * @brief stop the service, it can be started again by start()
+     */
+    void stop();
+
+    /**
+     * @brief whether the service is ready to accept runs
+     */
+    bool isReady() const;
+
+    /**
+     * @brief the name of the local server of the service
+     */
+    QString serverName() const;
+
+    /**
+     * @brief the settings used by Core::Runner, they are sent with each run because the service doesn't reload them
+     */
+    static QStringList forwardedSettings();
+
+    /**
+     * @brief whether the command line arguments request the service process
+     * @note this is checked before any QCoreApplication is created
+     */
+    static bool isServiceRequested(int argc, char *argv[]);
+
+    /**
+     * @brief run the service process in a QCoreApplication and return the exit code
+     * @note It listens on the local server named by the argument after --judge-service, and prints "READY" when
+     *       it's listening. It exits when the editor process exits.
+     */
+    static int execService(int argc, char *argv[]);
+
+  signals:
+    /**
+     * @brief the service is ready to accept runs
+     */
+    void ready();
+
+  private slots:
+    void onReadyReadStandardOutput();
+
+    void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void onErrorOccurred(QProcess::ProcessError error);
+
+  private:
+    enum State
+    {
+        NotStarted,
+        Starting,
+        Ready,
+        Unavailable // failed to start the service, the programs are run in the editor process in this session
+    };
+
+    explicit JudgeService(QObject *parent = nullptr);
+
+    /**
+     * @brief start the service process
+     */
+    void launch();
+
+    /**
+     * @brief mark the service as unavailable
+     * @param reason the reason, written in the event logs
+     */
+    void setUnavailable(const QString &reason);
+
+    State state = NotStarted;
+    QProcess *process = nullptr; // the service process
+    QString name;                // the name of the local server
+    QByteArray serviceStdout;    // the stdout of the service before it's ready
+    int restarts = 0;            // the number of restarts after crashes in this session
+};
+} // namespace Extensions
+
+#endif // JUDGESERVICE_HPP
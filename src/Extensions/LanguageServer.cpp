@@ -24,6 +24,9 @@
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QUrl>
 
 namespace Extensions
 {
@@ -52,15 +55,26 @@ LanguageServer::~LanguageServer()
 
 void LanguageServer::openDocument(QString const &path, QCodeEditor *editor, MessageLogger *log)
 {
-    if (isDocumentOpen())
+    logger = log;
+
+    if (documents.contains(editor))
     {
-        LOG_WARN("openDocument called without closing the previous document. Closing it now");
-        closeDocument();
+        updatePath(editor, path);
+        return;
     }
 
-    m_editor = editor;
-    openFile = path;
-    logger = log;
+    LOG_INFO(INFO_OF(path) << INFO_OF(language));
+
+    auto &document = documents[editor];
+    document.path = path;
+    document.contentsChangeConnection =
+        connect(editor->document(), &QTextDocument::contentsChange, this,
+                [this, editor](int position, int charsRemoved, int charsAdded) {
+                    onContentsChange(editor, position, charsRemoved, charsAdded);
+                });
+    // the tabs are not closed in a single place, so close the document when its editor is gone
+    document.destroyedConnection =
+        connect(editor, &QObject::destroyed, this, [this, editor] { closeDocument(editor); });
 
     if (lsp == nullptr)
         return;
@@ -71,54 +85,76 @@ void LanguageServer::openDocument(QString const &path, QCodeEditor *editor, Mess
         isInitialized = true;
     }
 
-    std::string uri = "file://" + path.toStdString();
-    std::string code = m_editor->toPlainText().toStdString();
-    std::string lang;
-
-    if (language == "Java")
-        lang = "java";
-    else if (language == "Python")
-        lang = "python";
-    else
-    {
-        LOG_WARN_IF(language != "C++", "Unknown language " << language);
-        lang = "cpp";
-    }
-
-    lsp->didOpen(uri, code, lang);
+    sendOpen(editor, document);
 }
 
-void LanguageServer::closeDocument()
+void LanguageServer::closeDocument(QCodeEditor *editor)
 {
-    LOG_WARN_IF(!isDocumentOpen(), "Cannot close the document, No document was open");
-    if (!isDocumentOpen())
+    auto it = documents.find(editor);
+    if (it == documents.end())
         return;
 
-    std::string uri = "file://" + openFile.toStdString();
-    lsp->didClose(uri);
+    if (lsp != nullptr)
+        lsp->didClose(uriOf(it->path));
+
+    // the editor may be being destroyed, so it's not used here
+    disconnect(it->contentsChangeConnection);
+    disconnect(it->destroyedConnection);
+    documents.erase(it);
 
-    openFile = "";
-    logger = nullptr;
-    m_editor = nullptr;
+    if (documents.isEmpty())
+        logger = nullptr;
 }
 
-void LanguageServer::requestLinting()
+void LanguageServer::requestLinting(QCodeEditor *editor)
 {
-    if (m_editor == nullptr || !isDocumentOpen())
+    if (!isDocumentOpen(editor))
         return;
 
+    auto &document = documents[editor];
+    auto text = editor->toPlainText();
+
     std::vector<TextDocumentContentChangeEvent> changes;
-    TextDocumentContentChangeEvent e;
-    e.text = m_editor->toPlainText().toStdString();
-    changes.push_back(e);
 
-    std::string uri = "file://" + openFile.toStdString();
-    lsp->didChange(uri, changes, true);
+    if (text == document.syncedText)
+    {
+        // the server already has the text, e.g. when switching back to a tab
+        if (syncKind != IncrementalSync || document.pendingChanges.isEmpty())
+            return;
+
+        for (const auto &change : qAsConst(document.pendingChanges))
+        {
+            Range range;
+            range.start.line = change.startLine;
+            range.start.character = change.startCharacter;
+            range.end.line = change.endLine;
+            range.end.character = change.endCharacter;
+
+            TextDocumentContentChangeEvent e;
+            e.range = range;
+            e.text = change.text.toStdString();
+            changes.push_back(e);
+        }
+    }
+    else
+    {
+        // the tracked changes can't be used if they don't produce the current text, send the full text instead
+        LOG_WARN_IF(syncKind == IncrementalSync, "The tracked changes are out of sync, sending the full text");
+
+        TextDocumentContentChangeEvent e;
+        e.text = text.toStdString();
+        changes.push_back(e);
+        document.syncedText = text;
+    }
+
+    document.pendingChanges.clear();
+
+    lsp->didChange(uriOf(document.path), changes, true);
 }
 
-bool LanguageServer::isDocumentOpen() const
+bool LanguageServer::isDocumentOpen(QCodeEditor *editor) const
 {
-    return !openFile.isEmpty() && lsp != nullptr;
+    return lsp != nullptr && documents.contains(editor);
 }
 
 void LanguageServer::updateSettings()
@@ -132,38 +168,41 @@ void LanguageServer::updateSettings()
         lsp = nullptr;
     }
 
-    if (m_editor != nullptr)
-        m_editor->clearSquiggle();
+    for (auto it = documents.begin(); it != documents.end(); ++it)
+        it.key()->clearSquiggle();
 
     if (shouldCreateClient())
     {
         createClient();
 
         performConnection();
-        initializeLSP(openFile);
+        initializeLSP(documents.isEmpty() ? QString() : documents.first().path);
+        isInitialized = true;
 
         LOG_INFO("Recreated Language server Process");
-        if (m_editor != nullptr)
-        {
-            auto *tmpEditor = m_editor;
-            auto tmpPath = openFile;
-            auto *tmpLog = logger;
-            if (isDocumentOpen())
-                closeDocument();
-            openDocument(tmpPath, tmpEditor, tmpLog);
-            LOG_INFO("Reopened document after restart");
-        }
+
+        for (auto it = documents.begin(); it != documents.end(); ++it)
+            sendOpen(it.key(), it.value());
+
+        LOG_INFO_IF(!documents.isEmpty(), "Reopened " << documents.size() << " documents after restart");
     }
 }
 
-void LanguageServer::updatePath(QString const &newPath)
+void LanguageServer::updatePath(QCodeEditor *editor, QString const &newPath)
 {
-    if (lsp == nullptr || (openFile == newPath))
+    auto it = documents.find(editor);
+    if (it == documents.end() || it->path == newPath)
         return;
-    auto *tmpLogger = logger;
-    auto *tmpEditor = m_editor;
-    closeDocument();
-    openDocument(newPath, tmpEditor, tmpLogger);
+
+    LOG_INFO(INFO_OF(it->path) << INFO_OF(newPath));
+
+    if (lsp != nullptr)
+        lsp->didClose(uriOf(it->path));
+
+    it->path = newPath;
+
+    if (lsp != nullptr)
+        sendOpen(editor, it.value());
 }
 
 // Private methods
@@ -179,6 +218,7 @@ void LanguageServer::createClient()
     auto program = SettingsManager::get("LSP/Path " + language).toString();
     auto args = QProcess::splitCommand(SettingsManager::get("LSP/Args " + language).toString().trimmed());
     lsp = new LSPClient(program, args);
+    syncKind = FullSync;
 }
 
 void LanguageServer::performConnection()
@@ -223,13 +263,64 @@ void LanguageServer::initializeLSP(QString const &filePath)
     option<DocumentUri> rootUri(uri);
     lsp->initialize(rootUri);
 }
+
+void LanguageServer::sendOpen(QCodeEditor *editor, Document &document)
+{
+    std::string lang;
+
+    if (language == "Java")
+        lang = "java";
+    else if (language == "Python")
+        lang = "python";
+    else
+    {
+        LOG_WARN_IF(language != "C++", "Unknown language " << language);
+        lang = "cpp";
+    }
+
+    document.syncedText = editor->toPlainText();
+    document.pendingChanges.clear();
+
+    lsp->didOpen(uriOf(document.path), document.syncedText.toStdString(), lang);
+}
+
+QCodeEditor *LanguageServer::editorOfUri(QString const &uri) const
+{
+    // the server may percent-encode the URI, and add a slash before the drive letter on Windows
+    auto path = QUrl::fromPercentEncoding(uri.toUtf8());
+    if (path.startsWith("file://"))
+        path.remove(0, 7);
+    if (path.length() > 2 && path[0] == '/' && path[2] == ':')
+        path.remove(0, 1);
+    path = QDir::cleanPath(path);
+
+    for (auto it = documents.begin(); it != documents.end(); ++it)
+    {
+        if (QString::fromStdString(uriOf(it->path)) == uri || QDir::cleanPath(it->path) == path)
+            return it.key();
+    }
+    return nullptr;
+}
+
+std::string LanguageServer::uriOf(QString const &path)
+{
+    return "file://" + path.toStdString();
+}
 // ---------------------------- LSP SLOTS ------------------------
 
 void LanguageServer::onLSPServerNotificationArrived(QString const &method, QJsonObject const &param)
 {
-    if (method == "textDocument/publishDiagnostics" && m_editor != nullptr) // Linting
+    if (method == "textDocument/publishDiagnostics") // Linting
     {
-        m_editor->clearSquiggle();
+        // the diagnostics of all open documents are sent, including the ones in the background tabs
+        auto *editor = editorOfUri(param["uri"].toString());
+        if (editor == nullptr)
+        {
+            LOG_INFO("Diagnostics of a closed document arrived. " << INFO_OF(param["uri"].toString()));
+            return;
+        }
+
+        editor->clearSquiggle();
         QJsonArray doc = QJsonDocument::fromVariant(param.toVariantMap()).object()["diagnostics"].toArray();
         for (auto e : doc)
         {
@@ -248,16 +339,27 @@ void LanguageServer::onLSPServerNotificationArrived(QString const &method, QJson
             stop.first = end["line"].toInt() + 1;
             stop.second = end["character"].toInt();
 
-            m_editor->squiggle(level, start, stop,
+            editor->squiggle(level, start, stop,
                                tooltip.remove(" (fix available)")); // We do not provide quick fix so remove this text.
         }
     }
 }
 
-void LanguageServer::onLSPServerResponseArrived(QJsonObject const &method, // NOLINT: It can be made static.
-                                                QJsonObject const &param)
+void LanguageServer::onLSPServerResponseArrived(QJsonObject const &method, QJsonObject const &param)
 {
     LOG_INFO("Response from Server has arrived");
+
+    auto result = param.contains("result") ? param["result"].toObject() : param;
+    auto capabilities = result["capabilities"].toObject();
+    if (capabilities.isEmpty())
+        return;
+
+    // textDocumentSync is either a TextDocumentSyncKind or TextDocumentSyncOptions
+    auto sync = capabilities["textDocumentSync"];
+    auto kind = sync.isObject() ? sync.toObject()["change"].toInt(FullSync) : sync.toInt(FullSync);
+    syncKind = kind == IncrementalSync ? IncrementalSync : FullSync;
+
+    LOG_INFO("The server is initialized. " << INFO_OF(language) << INFO_OF(kind));
 }
 
 void LanguageServer::onLSPServerRequestArrived(QString const &method, // NOLINT: It can be made static.
@@ -322,4 +424,48 @@ void LanguageServer::onLSPServerNewStderr(const QString &content) // NOLINT: It
 {
     LOG_INFO(content);
 }
+
+void LanguageServer::onContentsChange(QCodeEditor *editor, int position, int charsRemoved, int charsAdded)
+{
+    auto it = documents.find(editor);
+    if (syncKind != IncrementalSync || it == documents.end() || position > it->syncedText.length())
+        return;
+
+    auto &syncedText = it->syncedText;
+    auto *document = editor->document();
+
+    // the counts may include the last paragraph separator, which is not a part of the plain text
+    int removedEnd = qMin(position + charsRemoved, syncedText.length());
+    int addedEnd = qMin(position + charsAdded, document->characterCount() - 1);
+
+    QTextCursor cursor(document);
+    cursor.setPosition(position);
+    cursor.setPosition(addedEnd, QTextCursor::KeepAnchor);
+
+    // convert the text in the same way as QTextDocument::toPlainText()
+    auto text = cursor.selectedText();
+    for (auto &c : text)
+    {
+        if (c == QChar::ParagraphSeparator || c == QChar::LineSeparator)
+            c = '\n';
+        else if (c == QChar::Nbsp)
+            c = ' ';
+    }
+
+    if (syncedText.midRef(position, removedEnd - position) == text)
+        return; // e.g. only the highlighting is changed
+
+    auto lineAndCharacter = [&syncedText](int pos, int *line, int *character) {
+        *line = syncedText.leftRef(pos).count('\n');
+        *character = pos == 0 ? 0 : pos - syncedText.lastIndexOf('\n', pos - 1) - 1;
+    };
+
+    ContentChange change;
+    lineAndCharacter(position, &change.startLine, &change.startCharacter);
+    lineAndCharacter(removedEnd, &change.endLine, &change.endCharacter);
+    change.text = text;
+    it->pendingChanges.push_back(change);
+
+    syncedText.replace(position, removedEnd - position, text);
+}
 } // namespace Extensions
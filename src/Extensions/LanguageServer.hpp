@@ -20,7 +20,9 @@
 
 #include <QCodeEditor>
 #include <QJsonObject>
+#include <QMap>
 #include <QProcess>
+#include <QVector>
 
 class MessageLogger;
 class LSPClient;
@@ -35,14 +37,22 @@ class LanguageServer : public QObject
     explicit LanguageServer(QString const &lang);
     ~LanguageServer() override;
 
+    /**
+     * @brief open the document of an editor, it's kept open until closeDocument() or the editor is destroyed
+     * @note it does nothing except updating the logger if the document is already open
+     */
     void openDocument(QString const &path, QCodeEditor *editor, MessageLogger *log);
-    void closeDocument();
-    void requestLinting();
 
-    bool isDocumentOpen() const;
+    /**
+     * @brief close the document of an editor, it does nothing if the document is not open
+     */
+    void closeDocument(QCodeEditor *editor);
+    void requestLinting(QCodeEditor *editor);
+
+    bool isDocumentOpen(QCodeEditor *editor) const;
 
     void updateSettings();
-    void updatePath(QString const &);
+    void updatePath(QCodeEditor *editor, QString const &newPath);
 
   private slots:
     void onLSPServerNotificationArrived(QString const &method, QJsonObject const &param);
@@ -54,6 +64,31 @@ class LanguageServer : public QObject
     void onLSPServerNewStderr(const QString &content);
 
   private:
+    // the TextDocumentSyncKind in the capabilities of the server
+    enum SyncKind
+    {
+        NoSync = 0,
+        FullSync = 1,
+        IncrementalSync = 2
+    };
+
+    // a change of the document, the range is in the text before the change, in UTF-16 code units
+    struct ContentChange
+    {
+        int startLine, startCharacter, endLine, endCharacter;
+        QString text;
+    };
+
+    // an open document, there is one for each tab in the language of the server
+    struct Document
+    {
+        QString path;                                     // the path of the file, or the temporary file if untitled
+        QString syncedText;                               // the text after the pending changes are applied
+        QVector<ContentChange> pendingChanges;            // the changes which are not sent to the server yet
+        QMetaObject::Connection contentsChangeConnection; // tracks the changes for incremental sync
+        QMetaObject::Connection destroyedConnection;      // closes the document when the editor is destroyed
+    };
+
     void performConnection();
     void createClient();
     bool shouldCreateClient();
@@ -61,12 +96,30 @@ class LanguageServer : public QObject
     static QCodeEditor::SeverityLevel lspSeverity(int in);
     void initializeLSP(QString const &filePath);
 
-    QCodeEditor *m_editor = nullptr;
-    MessageLogger *logger = nullptr;
+    /**
+     * @brief send the full text of a document to the server by didOpen
+     */
+    void sendOpen(QCodeEditor *editor, Document &document);
+
+    /**
+     * @brief record a change of a document, for incremental sync
+     */
+    void onContentsChange(QCodeEditor *editor, int position, int charsRemoved, int charsAdded);
+
+    /**
+     * @brief find the editor of a document by the URI sent by the server
+     * @returns nullptr if the document is not open
+     */
+    QCodeEditor *editorOfUri(QString const &uri) const;
+
+    static std::string uriOf(QString const &path);
+
+    MessageLogger *logger = nullptr; // the logger of the latest opened document, i.e. the current tab
     LSPClient *lsp = nullptr;
     bool isInitialized = false;
     QString language;
-    QString openFile;
+    QMap<QCodeEditor *, Document> documents; // the open documents, kept when the server is restarted
+    SyncKind syncKind = FullSync;            // the full text is sent until the server advertises incremental sync
 };
 } // namespace Extensions
 
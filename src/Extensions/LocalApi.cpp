@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Extensions/LocalApi.hpp"
+#include "../../ui/ui_appwindow.h"
+#include "Core/EventLogger.hpp"
+#include "appwindow.hpp"
+#include "generated/version.hpp"
+#include "mainwindow.hpp"
+#include "third_party/qhttp/src/qhttpfwd.hpp"
+#include "third_party/qhttp/src/qhttpserverresponse.hpp"
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QTabWidget>
+
+static const int API_VERSION = 1;
+
+static void reply(qhttp::server::QHttpResponse *response, qhttp::TStatusCode status, const QJsonObject &body)
+{
+    response->setStatusCode(status);
+    response->addHeader("content-type", "application/json");
+    response->end(QJsonDocument(body).toJson(QJsonDocument::Compact));
+}
+
+static void replyError(qhttp::server::QHttpResponse *response, qhttp::TStatusCode status, const QString &error)
+{
+    reply(response, status, {{"error", error}});
+}
+
+namespace Extensions
+{
+LocalApi::LocalApi(AppWindow *appwindow) : QObject(appwindow), app(appwindow)
+{
+}
+
+void LocalApi::watch(MainWindow *window)
+{
+    connect(window, &MainWindow::compilationEnded, this, &LocalApi::onCompilationEnded);
+    connect(window, &MainWindow::testCaseJudged, this, &LocalApi::onTestCaseJudged);
+    connect(window, &MainWindow::judgingFinished, this, &LocalApi::onJudgingFinished);
+}
+
+void LocalApi::handleRequest(const QString &method, const QString &path, const QByteArray &body,
+                             qhttp::server::QHttpResponse *response)
+{
+    LOG_INFO(INFO_OF(method) << INFO_OF(path));
+
+    static const QRegularExpression tabActionPattern("^/api/v1/tabs/(\\d+)/(compile|run|compile-run)$");
+    static const QRegularExpression tabResultsPattern("^/api/v1/tabs/(\\d+)/results$");
+    static const QRegularExpression fileActionPattern("^/api/v1/files/(compile|run|compile-run)$");
+
+    auto tabAction = tabActionPattern.match(path);
+    auto tabResults = tabResultsPattern.match(path);
+    auto fileAction = fileActionPattern.match(path);
+    bool isPost = tabAction.hasMatch() || fileAction.hasMatch();
+
+    if (path != "/api/v1" && path != "/api/v1/tabs" && path != "/api/v1/events" && !isPost && !tabResults.hasMatch())
+    {
+        replyError(response, qhttp::ESTATUS_NOT_FOUND, "Unknown endpoint");
+        return;
+    }
+
+    if (method != (isPost ? "POST" : "GET"))
+    {
+        replyError(response, qhttp::ESTATUS_METHOD_NOT_ALLOWED, QString("Use %1").arg(isPost ? "POST" : "GET"));
+        return;
+    }
+
+    if (path == "/api/v1")
+    {
+        reply(response, qhttp::ESTATUS_OK, {{"version", DISPLAY_VERSION}, {"api", API_VERSION}});
+    }
+    else if (path == "/api/v1/tabs")
+    {
+        QJsonArray tabs;
+        for (int i = 0; i < app->ui->tabWidget->count(); ++i)
+            tabs.push_back(tabInfo(i));
+        reply(response, qhttp::ESTATUS_OK, {{"tabs", tabs}});
+    }
+    else if (path == "/api/v1/events")
+    {
+        openEventStream(response);
+    }
+    else if (tabResults.hasMatch())
+    {
+        int index = tabResults.captured(1).toInt();
+        auto *window = app->windowAt(index < app->ui->tabWidget->count() ? index : -1);
+        if (window == nullptr)
+            replyError(response, qhttp::ESTATUS_NOT_FOUND, "No such tab");
+        else
+            reply(response, qhttp::ESTATUS_OK, {{"tab", index}, {"testcases", window->testCaseResults()}});
+    }
+    else if (tabAction.hasMatch())
+    {
+        int index = tabAction.captured(1).toInt();
+        auto *window = app->windowAt(index < app->ui->tabWidget->count() ? index : -1);
+        if (window == nullptr)
+        {
+            replyError(response, qhttp::ESTATUS_NOT_FOUND, "No such tab");
+            return;
+        }
+        reply(response, qhttp::ESTATUS_ACCEPTED, {{"tab", index}});
+        trigger(window, tabAction.captured(2));
+    }
+    else
+    {
+        QJsonParseError error{};
+        auto filePath = QJsonDocument::fromJson(body, &error).object()["path"].toString();
+        if (error.error != QJsonParseError::NoError || !QFileInfo(filePath).isFile())
+        {
+            replyError(response, qhttp::ESTATUS_BAD_REQUEST, "The body should be {\"path\": <an existing file>}");
+            return;
+        }
+        app->openTab(QFileInfo(filePath).absoluteFilePath());
+        int index = app->ui->tabWidget->currentIndex();
+        reply(response, qhttp::ESTATUS_ACCEPTED, {{"tab", index}});
+        trigger(app->currentWindow(), fileAction.captured(1));
+    }
+}
+
+void LocalApi::onCompilationEnded(MainWindow *window, bool succeeded)
+{
+    broadcast("compilation", {{"tab", tabIndex(window)}, {"succeeded", succeeded}});
+}
+
+void LocalApi::onTestCaseJudged(MainWindow *window, int index)
+{
+    auto results = window->testCaseResults();
+    if (index >= 0 && index < results.size())
+        broadcast("testcase", {{"tab", tabIndex(window)}, {"result", results[index]}});
+}
+
+void LocalApi::onJudgingFinished(MainWindow *window)
+{
+    broadcast("finished", {{"tab", tabIndex(window)}});
+}
+
+QJsonObject LocalApi::tabInfo(int index) const
+{
+    auto *window = app->windowAt(index);
+    return {{"index", index},
+            {"title", window->getTabTitle(false, false)},
+            {"filePath", window->getFilePath()},
+            {"language", window->getLanguage()},
+            {"problemURL", window->getProblemURL()},
+            {"current", index == app->ui->tabWidget->currentIndex()}};
+}
+
+int LocalApi::tabIndex(MainWindow *window) const
+{
+    return app->ui->tabWidget->indexOf(window);
+}
+
+void LocalApi::trigger(MainWindow *window, const QString &action)
+{
+    LOG_INFO(INFO_OF(window->getFilePath()) << INFO_OF(action));
+
+    if (action == "compile")
+        window->compileOnly();
+    else if (action == "run")
+        window->runOnly();
+    else if (action == "compile-run")
+        window->compileAndRun();
+}
+
+void LocalApi::openEventStream(qhttp::server::QHttpResponse *response)
+{
+    response->setStatusCode(qhttp::ESTATUS_OK);
+    response->addHeader("content-type", "text/event-stream");
+    response->addHeader("cache-control", "no-cache");
+    response->write(": connected\n\n"); // send the headers now, so the client knows it's subscribed
+    eventStreams.push_back(response);
+}
+
+void LocalApi::broadcast(const QString &event, const QJsonObject &data)
+{
+    eventStreams.removeAll(nullptr); // the responses are deleted when the connections are closed
+
+    if (eventStreams.isEmpty())
+        return;
+
+    auto message = QString("event: %1\ndata: %2\n\n")
+                       .arg(event, QString::fromUtf8(QJsonDocument(data).toJson(QJsonDocument::Compact)))
+                       .toUtf8();
+    for (auto const &response : eventStreams)
+        response->write(message);
+}
+
+} // namespace Extensions
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The LocalApi serves a JSON API on the Competitive Companion server, so editor plugins and scripts can use
+ * CP Editor as a local judge. The requests are received by Extensions::CompanionServer, which accepts them only
+ * from this computer and not from web pages. Each request should have the header "Authorization: Bearer <token>"
+ * with the token in the settings, and the POST requests should have "Content-Type: application/json".
+ * The endpoints are versioned under /api/v1:
+ *
+ *   GET  /api/v1                         the version of CP Editor and the API
+ *   GET  /api/v1/tabs                    the tabs, identified by their indices
+ *   POST /api/v1/tabs/<index>/<action>   compile, run or compile and run a tab, the action is one of "compile",
+ *                                        "run" and "compile-run"
+ *   POST /api/v1/files/<action>          open {"path": "..."} in a tab, and compile, run or compile and run it
+ *   GET  /api/v1/tabs/<index>/results    the results of the test cases of a tab, with the time used
+ *   GET  /api/v1/events                  the progress of all tabs as server-sent events, the events are
+ *                                        "compilation", "testcase" and "finished"
+ *
+ * The actions are asynchronous, subscribe to the events before triggering them to follow the progress.
+ */
+
+#ifndef LOCALAPI_HPP
+#define LOCALAPI_HPP
+
+#include <QJsonObject>
+#include <QPointer>
+
+class AppWindow;
+class MainWindow;
+
+namespace qhttp
+{
+namespace server
+{
+class QHttpResponse;
+} // namespace server
+} // namespace qhttp
+
+namespace Extensions
+{
+class LocalApi : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit LocalApi(AppWindow *appwindow);
+
+    /**
+     * @brief report the progress of a tab to the event streams
+     */
+    void watch(MainWindow *window);
+
+  public slots:
+    /**
+     * @brief handle a request, the arguments are the same as CompanionServer::apiRequestArrived
+     */
+    void handleRequest(const QString &method, const QString &path, const QByteArray &body,
+                       qhttp::server::QHttpResponse *response);
+
+  private slots:
+    void onCompilationEnded(MainWindow *window, bool succeeded);
+
+    void onTestCaseJudged(MainWindow *window, int index);
+
+    void onJudgingFinished(MainWindow *window);
+
+  private:
+    /**
+     * @brief the information of a tab in the response of /api/v1/tabs
+     */
+    QJsonObject tabInfo(int index) const;
+
+    /**
+     * @brief the index of a tab, -1 if it's closed
+     */
+    int tabIndex(MainWindow *window) const;
+
+    /**
+     * @brief start an action on a tab, the action is one of "compile", "run" and "compile-run"
+     */
+    static void trigger(MainWindow *window, const QString &action);
+
+    /**
+     * @brief keep the response open, and send the events to it
+     */
+    void openEventStream(qhttp::server::QHttpResponse *response);
+
+    /**
+     * @brief send an event to all event streams
+     */
+    void broadcast(const QString &event, const QJsonObject &data);
+
+    AppWindow *app = nullptr;
+    QList<QPointer<qhttp::server::QHttpResponse>> eventStreams; // the open event streams, null after closed
+};
+} // namespace Extensions
+
+#endif // LOCALAPI_HPP
@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Extensions/Profiler.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/MessageLogger.hpp"
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <algorithm>
+#include <generated/SettingsHelper.hpp>
+
+namespace Extensions
+{
+static const int STOP_WAIT_LIMIT = 1000; // the time to wait for perf to stop before killing it, in milliseconds
+
+Profiler::Profiler(MessageLogger *logger, QObject *parent) : QObject(parent), log(logger)
+{
+}
+
+Profiler::~Profiler()
+{
+    if (process != nullptr)
+    {
+        process->disconnect(this);
+        if (process->state() != QProcess::NotRunning)
+        {
+            // The process and the work directory are deleted after it finishes, so the UI doesn't wait for it.
+            // perf record stops the program on SIGTERM, while SIGKILL would leave the program running,
+            // so it's only killed if it's still running after STOP_WAIT_LIMIT.
+            LOG_WARN("The profiler is running and being stopped");
+            auto *running = process;
+            auto *dir = workDir;
+            running->setParent(nullptr);
+            connect(running, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), running, [running, dir] {
+                running->deleteLater();
+                delete dir;
+            });
+            running->terminate();
+            QTimer::singleShot(STOP_WAIT_LIMIT, running, [running] { running->kill(); });
+            return;
+        }
+        delete process;
+    }
+    delete workDir;
+}
+
+bool Profiler::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Profiler::start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &compileCommand,
+                     const QString &input, int timeLimit)
+{
+    programInput = input;
+    programTimeLimit = timeLimit;
+    sourcePath = QFileInfo(tmpFilePath).canonicalFilePath();
+
+    workDir = new QTemporaryDir();
+    if (!workDir->isValid())
+    {
+        fail(tr("Failed to create the temporary directory"));
+        return;
+    }
+
+    auto args = QProcess::splitCommand(compileCommand);
+    if (args.isEmpty())
+    {
+        fail(tr("The compile command is empty"));
+        return;
+    }
+    auto program = args.takeFirst();
+    args << QProcess::splitCommand(SettingsHelper::getProfilerCompileFlags()) << sourcePath << "-o"
+         << workDir->filePath("profiled");
+    if (QFile::exists(sourceFilePath))
+        args << "-I" << QFileInfo(sourceFilePath).canonicalPath();
+
+    timeoutTimer = new QTimer(this);
+    timeoutTimer->setSingleShot(true);
+    connect(timeoutTimer, &QTimer::timeout, this, [this] {
+        if (currentStep == Recording && process != nullptr)
+        {
+            timeLimitReached = true;
+            process->terminate();
+        }
+    });
+
+    log->info(tr("Profiler"), tr("Compiling with the profiling flags"));
+    startStep(Compiling, program, args);
+}
+
+void Profiler::startStep(Step step, const QString &program, const QStringList &arguments)
+{
+    LOG_INFO(INFO_OF(step) << INFO_OF(program) << INFO_OF(arguments.join(' ')));
+
+    currentStep = step;
+
+    if (process != nullptr)
+        process->deleteLater(); // this is called in the slots of the last process
+    process = new QProcess(this);
+    process->setWorkingDirectory(QFileInfo(sourcePath).path());
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, &Profiler::onProcessFinished);
+    connect(process, &QProcess::errorOccurred, this, &Profiler::onProcessErrorOccurred);
+
+    if (step == Recording)
+    {
+        process->setStandardOutputFile(QProcess::nullDevice()); // the output of the program is not needed
+        connect(process, &QProcess::started, this, [this] {
+            process->write(programInput.toUtf8());
+            process->closeWriteChannel();
+            timeoutTimer->start(programTimeLimit);
+        });
+    }
+
+    process->start(program, arguments);
+}
+
+void Profiler::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    auto perf = SettingsHelper::getProfilerPath();
+    auto data = workDir->filePath("perf.data");
+    auto error = QString::fromLocal8Bit(process->readAllStandardError()).trimmed();
+
+    switch (currentStep)
+    {
+    case Compiling:
+        if (exitStatus != QProcess::NormalExit || exitCode != 0)
+        {
+            fail(tr("Compilation with the profiling flags failed:\n%1").arg(error));
+            return;
+        }
+        log->info(tr("Profiler"), tr("Running the test case under perf record"));
+        // --all-user makes it work with perf_event_paranoid = 2, which is the default on most distributions
+        startStep(Recording, perf,
+                  {"record", "-F", QString::number(SettingsHelper::getProfilerFrequency()), "-g", "--all-user", "-o",
+                   data, "--", workDir->filePath("profiled")});
+        break;
+
+    case Recording:
+        timeoutTimer->stop();
+        if (!QFile::exists(data))
+        {
+            fail(tr("perf record failed:\n%1").arg(error));
+            return;
+        }
+        if (timeLimitReached)
+            log->warn(tr("Profiler"), tr("The time limit is reached, the samples before it are used"));
+        startStep(Scripting, perf, {"script", "-i", data, "-F", "ip,sym"});
+        break;
+
+    case Scripting:
+        if (exitStatus != QProcess::NormalExit || exitCode != 0)
+        {
+            fail(tr("perf script failed:\n%1").arg(error));
+            return;
+        }
+        parseScript(QString::fromUtf8(process->readAllStandardOutput()));
+        if (result.root.samples == 0)
+        {
+            fail(tr("No samples are recorded, the program may have finished too quickly"));
+            return;
+        }
+        log->info(tr("Profiler"), tr("%1 samples are recorded, resolving the source lines").arg(result.root.samples));
+        startStep(Reporting, perf,
+                  {"report", "-i", data, "--stdio", "--no-children", "-g", "none", "--sort", "srcline",
+                   "--full-source-path", "-q", "--percent-limit", "0.5"});
+        break;
+
+    case Reporting:
+        // the flame graph is still useful without the source lines, e.g. perf is built without libdw/addr2line
+        if (exitStatus != QProcess::NormalExit || exitCode != 0)
+            log->warn(tr("Profiler"), tr("Failed to resolve the source lines:\n%1").arg(error));
+        else
+            parseReport(QString::fromUtf8(process->readAllStandardOutput()));
+        process->deleteLater();
+        process = nullptr;
+        emit finished(result);
+        break;
+    }
+}
+
+void Profiler::onProcessErrorOccurred(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart)
+        return;
+
+    if (currentStep == Compiling)
+        fail(tr("Failed to start the compiler"));
+    else
+        fail(tr("Failed to start perf, please check %1").arg(SettingsHelper::pathOfProfilerPath()));
+}
+
+void Profiler::parseScript(const QString &output)
+{
+    result.root = FlameNode();
+    result.root.name = "all";
+
+    QStringList frames; // from the leaf to the root
+
+    auto addSample = [this, &frames] {
+        if (frames.isEmpty())
+            return;
+        auto *node = &result.root;
+        ++node->samples;
+        for (int i = frames.size() - 1; i >= 0; --i)
+        {
+            auto it = std::find_if(node->children.begin(), node->children.end(),
+                                   [&](const FlameNode &child) { return child.name == frames[i]; });
+            if (it == node->children.end())
+            {
+                node->children.push_back(FlameNode{frames[i], 0, {}});
+                node = &node->children.back();
+            }
+            else
+            {
+                node = &*it;
+            }
+            ++node->samples;
+        }
+        frames.clear();
+    };
+
+    // each frame is a line like "55d0c1e4a1c9 main", and the samples are separated by empty lines
+    for (const auto &line : output.split('\n'))
+    {
+        auto frame = line.trimmed();
+        if (frame.isEmpty())
+        {
+            addSample();
+            continue;
+        }
+        int space = frame.indexOf(' ');
+        auto symbol = space == -1 ? QString() : frame.mid(space + 1).trimmed();
+        frames.push_back(symbol.isEmpty() ? "[unknown]" : symbol);
+    }
+    addSample();
+}
+
+void Profiler::parseReport(const QString &output)
+{
+    // each line is like "    12.34%  /path/to/sol.cpp:42"
+    static const QRegularExpression lineRegex(R"(^\s*([\d.]+)%\s+(.+):(\d+)\s*$)");
+
+    for (const auto &line : output.split('\n'))
+    {
+        auto match = lineRegex.match(line);
+        if (!match.hasMatch() || match.captured(2) == "??")
+            continue;
+        HotLine hotLine;
+        hotLine.file = match.captured(2);
+        hotLine.line = match.captured(3).toInt();
+        hotLine.percent = match.captured(1).toDouble();
+        hotLine.inSource = QFileInfo(hotLine.file).canonicalFilePath() == sourcePath;
+        result.hotLines.push_back(hotLine);
+    }
+
+    std::stable_sort(result.hotLines.begin(), result.hotLines.end(),
+                     [](const HotLine &a, const HotLine &b) { return a.percent > b.percent; });
+}
+
+void Profiler::fail(const QString &reason)
+{
+    LOG_WARN(INFO_OF(reason));
+    if (process != nullptr)
+    {
+        process->disconnect(this);
+        process->deleteLater();
+        process = nullptr;
+    }
+    emit failed(reason);
+}
+} // namespace Extensions
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The Profiler finds out where a C++ program spends its time on a single test case.
+ * It compiles the program again with the debug information and the frame pointers, runs it under `perf record`,
+ * and reads the samples back by `perf script` (for the flame graph) and `perf report` (for the hottest lines).
+ * Each step is an asynchronous process, the result is returned by the finished signal.
+ * It only works on Linux, with perf installed and allowed by /proc/sys/kernel/perf_event_paranoid.
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <QProcess>
+#include <QVector>
+
+class MessageLogger;
+class QTemporaryDir;
+class QTimer;
+
+namespace Extensions
+{
+class Profiler : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // a frame in the call tree, the samples include the samples of the children
+    struct FlameNode
+    {
+        QString name;
+        qint64 samples = 0;
+        QVector<FlameNode> children;
+    };
+
+    // a source line and the ratio of the samples on it
+    struct HotLine
+    {
+        QString file;
+        int line = 0;
+        double percent = 0;
+        bool inSource = false; // whether it's a line in the profiled source file
+    };
+
+    struct Result
+    {
+        FlameNode root;
+        QVector<HotLine> hotLines; // sorted by percent in descending order
+    };
+
+    Profiler(MessageLogger *logger, QObject *parent = nullptr);
+
+    /**
+     * @brief destruct the profiler
+     * @note the running process is stopped, and it's deleted with the work directory after it finishes
+     */
+    ~Profiler() override;
+
+    /**
+     * @brief whether the profiler can be used on the current platform
+     */
+    static bool isSupported();
+
+    /**
+     * @brief compile and profile a C++ program
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     * @param compileCommand the command used to compile the program, the profiling flags are appended
+     * @param input the input of the test case
+     * @param timeLimit the program is stopped after this time, in milliseconds, and the samples until then are kept
+     * @note This should be called only once. Either finished or failed will be emitted.
+     */
+    void start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &compileCommand,
+               const QString &input, int timeLimit);
+
+  signals:
+    void finished(const Extensions::Profiler::Result &result);
+
+    void failed(const QString &reason);
+
+  private slots:
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void onProcessErrorOccurred(QProcess::ProcessError error);
+
+  private:
+    enum Step
+    {
+        Compiling,
+        Recording,
+        Scripting,
+        Reporting
+    };
+
+    /**
+     * @brief start the process of a step
+     */
+    void startStep(Step step, const QString &program, const QStringList &arguments);
+
+    /**
+     * @brief build the call tree from the output of `perf script`
+     */
+    void parseScript(const QString &output);
+
+    /**
+     * @brief get the hottest lines from the output of `perf report`
+     */
+    void parseReport(const QString &output);
+
+    /**
+     * @brief emit failed and stop
+     */
+    void fail(const QString &reason);
+
+    MessageLogger *log;
+    QProcess *process = nullptr;      // the process of the current step
+    QTimer *timeoutTimer = nullptr;   // stops the program when the time limit is reached
+    QTemporaryDir *workDir = nullptr; // the directory of the profiled executable and perf.data
+    Step currentStep = Compiling;
+    QString sourcePath; // the canonical path of the profiled source file
+    QString programInput;
+    int programTimeLimit = 0;
+    bool timeLimitReached = false;
+    Result result;
+};
+} // namespace Extensions
+
+#endif // PROFILER_HPP
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Extensions/SanitizerBuild.hpp"
+#include "Core/Compiler.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/MessageLogger.hpp"
+#include "Core/Runner.hpp"
+#include "Util/FileUtil.hpp"
+#include "generated/SettingsHelper.hpp"
+#include <QDir>
+#include <QFileInfo>
+#include <QThread>
+
+namespace Extensions
+{
+
+// the sanitizer build is much slower than the normal build, so its time limit is multiplied by this
+static const int SANITIZER_TIME_FACTOR = 5;
+
+// at most this number of lines of a report are shown in the message logger
+static const int REPORT_LINES = 20;
+
+SanitizerBuild::SanitizerBuild(MessageLogger *log, QObject *parent) : QObject(parent), log(log)
+{
+}
+
+SanitizerBuild::~SanitizerBuild()
+{
+    if (compiler != nullptr)
+    {
+        compiler->disconnect(this);
+        delete compiler; // the compilation process is killed in the destructor of Compiler
+    }
+    clearRuns();
+}
+
+void SanitizerBuild::compile(const QString &tmpDirPath, const QString &code, const QString &sourceFilePath,
+                             const QString &compileCommand)
+{
+    QDir dir(tmpDirPath);
+    if (!dir.mkpath("sanitize"))
+    {
+        onCompilationFailed(tr("Failed to create the directory of the sanitizer build"));
+        return;
+    }
+
+    tmpFilePath = QDir(dir.filePath("sanitize")).filePath("sol.cpp");
+    if (!Util::saveFile(tmpFilePath, code, tr("Sanitizer Build"), false, log))
+    {
+        onCompilationFailed(tr("Failed to save the code of the sanitizer build"));
+        return;
+    }
+
+    // The code is compiled in another directory, so the sanitizer build doesn't overwrite the normal build.
+    // The source file path is not passed to the compiler, so the include path of it is added here.
+    auto command = compileCommand + " " + SettingsHelper::getCppSanitizerFlags();
+    if (!sourceFilePath.isEmpty() && QFile::exists(sourceFilePath))
+        command += QString(" -I \"%1\"").arg(QFileInfo(sourceFilePath).canonicalPath());
+
+    LOG_INFO(INFO_OF(tmpFilePath) << INFO_OF(command));
+
+    state = Compiling;
+    compiler = new Core::Compiler();
+    connect(compiler, &Core::Compiler::compilationFinished, this, &SanitizerBuild::onCompilationFinished);
+    connect(compiler, &Core::Compiler::compilationErrorOccurred, this, &SanitizerBuild::onCompilationFailed);
+    connect(compiler, &Core::Compiler::compilationFailed, this, &SanitizerBuild::onCompilationFailed);
+    compiler->start(tmpFilePath, QString(), command, "C++");
+}
+
+void SanitizerBuild::run(const QMap<int, QString> &inputs, int timeLimit)
+{
+    clearRuns();
+
+    pendingInputs = inputs;
+    runTimeLimit = timeLimit * SANITIZER_TIME_FACTOR;
+    totalRuns = inputs.size();
+
+    if (state == Compiled)
+        runNext();
+    else if (state == Failed)
+        reportFailure();
+}
+
+QString SanitizerBuild::findReport(const QString &err)
+{
+    static const QStringList markers = {"ERROR: AddressSanitizer", "ERROR: LeakSanitizer", "runtime error:"};
+
+    int begin = -1;
+    for (const auto &marker : markers)
+    {
+        int pos = err.indexOf(marker);
+        if (pos != -1 && (begin == -1 || pos < begin))
+            begin = pos;
+    }
+    if (begin == -1)
+        return QString();
+
+    begin = err.lastIndexOf('\n', begin) + 1;
+    auto lines = err.mid(begin).split('\n');
+    if (lines.size() > REPORT_LINES)
+    {
+        lines = lines.mid(0, REPORT_LINES);
+        lines.push_back("...");
+    }
+    return lines.join('\n').trimmed();
+}
+
+void SanitizerBuild::onCompilationFinished()
+{
+    compiler->deleteLater();
+    compiler = nullptr;
+
+    state = Compiled;
+    runArguments = SettingsHelper::getCppRunArguments();
+
+    LOG_INFO(INFO_OF(pendingInputs.size()));
+
+    runNext();
+}
+
+void SanitizerBuild::onCompilationFailed(const QString &reason)
+{
+    if (compiler != nullptr)
+    {
+        compiler->disconnect(this);
+        compiler->deleteLater();
+        compiler = nullptr;
+    }
+
+    if (state == Failed)
+        return;
+
+    LOG_WARN(INFO_OF(reason));
+
+    state = Failed;
+    failureReason = reason;
+
+    // the compilation errors of the code are shown by the normal build, so the failure is reported after it runs
+    if (totalRuns > 0)
+        reportFailure();
+}
+
+void SanitizerBuild::reportFailure()
+{
+    log->warn(tr("Sanitizer Build"),
+              tr("The sanitizer build failed, the test cases are not checked by the sanitizers. You can change the "
+                 "flags at %1.\n%2")
+                  .arg(SettingsHelper::pathOfCppSanitizerFlags())
+                  .arg(failureReason));
+    pendingInputs.clear();
+    totalRuns = 0;
+}
+
+void SanitizerBuild::runNext()
+{
+    // the sanitizer build runs in the background, so it leaves half of the cores to the editor and the other tabs
+    int limit = qMax(1, QThread::idealThreadCount() / 2);
+    while (!pendingInputs.isEmpty() && runners.size() < limit)
+    {
+        int index = pendingInputs.firstKey();
+        auto input = pendingInputs.take(index);
+
+        auto *runner = new Core::Runner(index);
+        connect(runner, &Core::Runner::runFinished, this, &SanitizerBuild::onRunFinished);
+        connect(runner, &Core::Runner::failedToStartRun, this, &SanitizerBuild::onFailedToStartRun);
+        connect(runner, &Core::Runner::runOutputLimitExceeded, this, &SanitizerBuild::onRunOutputLimitExceeded);
+        runners[index] = runner;
+        runner->run(tmpFilePath, QString(), "C++", QString(), runArguments, input, runTimeLimit);
+    }
+}
+
+void SanitizerBuild::clearRuns()
+{
+    for (auto *runner : runners)
+    {
+        runner->disconnect(this);
+        runner->deleteLater(); // this may be called in the slots of the runners
+    }
+    runners.clear();
+    pendingInputs.clear();
+    outputLimitExceededRuns.clear();
+    totalRuns = 0;
+    finishedRuns = 0;
+    findings = 0;
+}
+
+void SanitizerBuild::onRunFinished(int index, const QString & /*out*/, const QString &err, int /*exitCode*/,
+                                   qint64 /*timeUsed*/, bool /*tle*/)
+{
+    // the stderr is kept when the output limit is exceeded, so a report printed before the kill is still found
+    auto report = findReport(err);
+    if (!report.isEmpty())
+    {
+        ++findings;
+        log->error(tr("Sanitizer[%1]").arg(index + 1), report);
+    }
+    else if (outputLimitExceededRuns.contains(index))
+    {
+        log->warn(tr("Sanitizer[%1]").arg(index + 1),
+                  tr("The program is killed for exceeding the output limit, it's not fully checked"));
+    }
+    outputLimitExceededRuns.remove(index);
+    finishRun(index);
+}
+
+void SanitizerBuild::onFailedToStartRun(int index, const QString &error)
+{
+    log->warn(tr("Sanitizer[%1]").arg(index + 1), error);
+    finishRun(index);
+}
+
+void SanitizerBuild::onRunOutputLimitExceeded(int index)
+{
+    // the program is killed, and runFinished is emitted after this with the output read until then
+    outputLimitExceededRuns.insert(index);
+}
+
+void SanitizerBuild::finishRun(int index)
+{
+    auto *runner = runners.take(index);
+    if (runner != nullptr)
+    {
+        runner->disconnect(this);
+        runner->deleteLater();
+    }
+
+    if (++finishedRuns < totalRuns)
+    {
+        runNext();
+        return;
+    }
+
+    LOG_INFO(INFO_OF(totalRuns) << INFO_OF(findings));
+
+    if (findings == 0)
+        log->info(tr("Sanitizer Build"), tr("No issues are found by the sanitizers in %1 test cases").arg(totalRuns));
+    else
+        log->warn(tr("Sanitizer Build"),
+                  tr("The sanitizers found issues in %1 of %2 test cases").arg(findings).arg(totalRuns));
+}
+
+} // namespace Extensions
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The SanitizerBuild is the second build profile of C++: the solution is also compiled with the sanitizer flags,
+ * in parallel with the normal build. After the normal runs are finished, the test cases are run again on the
+ * sanitizer build in the background, and the findings of the sanitizers are reported per test case in the message
+ * logger. The verdicts and the time used always come from the normal build.
+ * A SanitizerBuild is used for one compilation, it's deleted when the solution is compiled again or killed.
+ */
+
+#ifndef SANITIZERBUILD_HPP
+#define SANITIZERBUILD_HPP
+
+#include <QMap>
+#include <QObject>
+#include <QSet>
+
+class MessageLogger;
+
+namespace Core
+{
+class Compiler;
+class Runner;
+} // namespace Core
+
+namespace Extensions
+{
+class SanitizerBuild : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit SanitizerBuild(MessageLogger *log, QObject *parent = nullptr);
+
+    /**
+     * @brief destruct the build, the compilation and the runs are killed
+     */
+    ~SanitizerBuild() override;
+
+    /**
+     * @brief compile the code with the sanitizer flags
+     * @param tmpDirPath the temporary directory of the tab, the code is saved in a sub-directory of it
+     * @param code the code to compile
+     * @param sourceFilePath the path of the source file, its directory is added to the include paths
+     * @param compileCommand the compile command of the normal build, the sanitizer flags are appended to it
+     */
+    void compile(const QString &tmpDirPath, const QString &code, const QString &sourceFilePath,
+                 const QString &compileCommand);
+
+    /**
+     * @brief run the test cases on the sanitizer build, after it's compiled
+     * @param inputs the inputs of the test cases, keyed by their indices
+     * @param timeLimit the time limit of the normal runs, it's multiplied for the slower sanitizer build
+     * @note the runs of the last call are cancelled
+     */
+    void run(const QMap<int, QString> &inputs, int timeLimit);
+
+    /**
+     * @brief whether the stderr of a program contains a report of a sanitizer
+     * @returns the report, starting from the first line of it, empty if there is no report
+     */
+    static QString findReport(const QString &err);
+
+  private slots:
+    void onCompilationFinished();
+
+    void onCompilationFailed(const QString &reason);
+
+    void onRunFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed, bool tle);
+
+    void onFailedToStartRun(int index, const QString &error);
+
+    void onRunOutputLimitExceeded(int index);
+
+  private:
+    enum State
+    {
+        Compiling,
+        Compiled,
+        Failed
+    };
+
+    /**
+     * @brief start the pending runs, at most one per core
+     */
+    void runNext();
+
+    /**
+     * @brief report the failure of the compilation in the message logger, and cancel the pending runs
+     */
+    void reportFailure();
+
+    /**
+     * @brief clear the runs of the last call of run()
+     */
+    void clearRuns();
+
+    /**
+     * @brief a run is finished, report the summary after the last one
+     */
+    void finishRun(int index);
+
+    MessageLogger *log = nullptr;
+    Core::Compiler *compiler = nullptr;
+    State state = Compiling;
+    QString tmpFilePath;               // the path of the code of the sanitizer build
+    QString failureReason;             // the reason of the failure of the compilation
+    QString runArguments;              // the run arguments of C++, read when compiled
+    QMap<int, QString> pendingInputs;  // the inputs of the test cases which are not started
+    QMap<int, Core::Runner *> runners; // the running test cases
+    QSet<int> outputLimitExceededRuns; // the running test cases killed for exceeding the output limit
+    int runTimeLimit = 0;              // the time limit of the runs on the sanitizer build
+    int totalRuns = 0;                 // the number of test cases of the last call of run()
+    int finishedRuns = 0;              // the number of finished test cases of the last call of run()
+    int findings = 0;                  // the number of test cases with findings in the last call of run()
+};
+} // namespace Extensions
+
+#endif // SANITIZERBUILD_HPP
@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Extensions/ToolchainProbe.hpp"
+#include "Core/Compiler.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/Runner.hpp"
+#include "Util/FileUtil.hpp"
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <algorithm>
+
+namespace Extensions
+{
+
+// the fastest of several compilations is used, the first one also warms up the file system cache
+static const int PROBE_COMPILATIONS = 2;
+
+// the input and the time limit of the reference program
+static const QString PROBE_INPUT = "100000\n";
+static const int PROBE_TIME_LIMIT = 10000;
+
+/**
+ * @brief quote an argument of a command, so that QProcess::splitCommand gets it back
+ */
+static QString quoteArgument(const QString &argument)
+{
+    if (!argument.isEmpty() && !argument.contains(' ') && !argument.contains('\t') && !argument.contains('"'))
+        return argument;
+    auto quoted = argument;
+    return '"' + quoted.replace('"', "\"\"\"") + '"';
+}
+
+ToolchainProbe::ToolchainProbe(QObject *parent) : QObject(parent)
+{
+}
+
+ToolchainProbe::~ToolchainProbe()
+{
+    if (compiler != nullptr)
+    {
+        compiler->disconnect(this);
+        delete compiler; // the compilation process is killed in the destructor of Compiler
+    }
+    if (runner != nullptr)
+    {
+        runner->disconnect(this);
+        delete runner;
+    }
+    delete workDir;
+}
+
+void ToolchainProbe::start(const QString &compileCommand)
+{
+    LOG_INFO(INFO_OF(compileCommand));
+
+    workDir = new QTemporaryDir();
+    if (!workDir->isValid())
+    {
+        fail(tr("Failed to create the temporary directory"));
+        return;
+    }
+
+    findCandidates(compileCommand);
+    if (candidates.isEmpty())
+    {
+        fail(tr("The compile command is empty"));
+        return;
+    }
+
+    compile();
+}
+
+void ToolchainProbe::findCandidates(const QString &compileCommand)
+{
+    auto args = QProcess::splitCommand(compileCommand);
+    if (args.isEmpty())
+        return;
+    auto currentCompiler = args.takeFirst();
+
+    // the linker is chosen by the probe, the other flags are kept for all candidates
+    QString currentLinker;
+    QStringList flags;
+    for (const auto &arg : args)
+    {
+        if (arg.startsWith("-fuse-ld="))
+            currentLinker = arg.mid(9);
+        else
+            flags.push_back(quoteArgument(arg));
+    }
+
+    Candidate currentCandidate;
+    currentCandidate.compileCommand = compileCommand;
+    currentCandidate.compiler = currentCompiler;
+    currentCandidate.linker = currentLinker;
+    candidates.push_back(currentCandidate);
+
+    auto canonicalPath = [](const QString &program) {
+        auto path = QFileInfo(program).isAbsolute() ? program : QStandardPaths::findExecutable(program);
+        return path.isEmpty() ? program : QFileInfo(path).canonicalFilePath();
+    };
+
+    // the versioned names are used by the distributions which install several versions side by side
+    QStringList compilerNames = {"g++", "clang++"};
+    for (int version = 7; version <= 15; ++version)
+        compilerNames.push_back(QString("g++-%1").arg(version));
+    for (int version = 10; version <= 21; ++version)
+        compilerNames.push_back(QString("clang++-%1").arg(version));
+
+    QStringList compilers = {currentCompiler};
+    QStringList compilerPaths = {canonicalPath(currentCompiler)};
+    for (const auto &name : compilerNames)
+    {
+        if (QStandardPaths::findExecutable(name).isEmpty())
+            continue;
+        auto path = canonicalPath(name);
+        if (compilerPaths.contains(path)) // e.g. g++ is a link to g++-12
+            continue;
+        compilers.push_back(name);
+        compilerPaths.push_back(path);
+    }
+
+    // the name of a linker in -fuse-ld and the name of its executable
+    QStringList linkers = {QString()};
+    const QVector<QPair<QString, QString>> linkerExecutables = {
+        {"lld", "ld.lld"}, {"mold", "mold"}, {"gold", "ld.gold"}};
+    for (const auto &linker : linkerExecutables)
+    {
+        if (!QStandardPaths::findExecutable(linker.second).isEmpty())
+            linkers.push_back(linker.first);
+    }
+
+    for (const auto &compiler : compilers)
+    {
+        for (const auto &linker : linkers)
+        {
+            if (compiler == currentCompiler && linker == currentLinker)
+                continue;
+            Candidate candidate;
+            candidate.compiler = compiler;
+            candidate.linker = linker;
+            QStringList command = {quoteArgument(compiler)};
+            command << flags;
+            if (!linker.isEmpty())
+                command << "-fuse-ld=" + linker;
+            candidate.compileCommand = command.join(' ');
+            candidates.push_back(candidate);
+        }
+    }
+
+    LOG_INFO(INFO_OF(compilers.join(", ")) << INFO_OF(linkers.join(", ")) << INFO_OF(candidates.size()));
+}
+
+void ToolchainProbe::compile()
+{
+    auto dirPath = workDir->filePath(QString::number(current));
+    auto sourcePath = QDir(dirPath).filePath("probe.cpp");
+    if (!QDir().mkpath(dirPath) ||
+        !Util::saveFile(sourcePath, Util::readFile(":/native/CPEditorToolchainProbe.cpp", "Toolchain Probe"),
+                        "Toolchain Probe", false))
+    {
+        fail(tr("Failed to save the source file of the reference program"));
+        return;
+    }
+
+    LOG_INFO(INFO_OF(current) << INFO_OF(candidates[current].compileCommand));
+
+    compiler = new Core::Compiler();
+    connect(compiler, &Core::Compiler::compilationFinished, this, &ToolchainProbe::onCompilationFinished);
+    connect(compiler, &Core::Compiler::compilationErrorOccurred, this, &ToolchainProbe::onCompilationError);
+    connect(compiler, &Core::Compiler::compilationFailed, this, &ToolchainProbe::onCompilationError);
+    compileTimer.start();
+    compiler->start(sourcePath, QString(), candidates[current].compileCommand, "C++");
+}
+
+void ToolchainProbe::onCompilationFinished()
+{
+    auto time = compileTimer.elapsed();
+    compiler->deleteLater();
+    compiler = nullptr;
+
+    auto &candidate = candidates[current];
+    if (candidate.time == -1 || time < candidate.time)
+        candidate.time = time;
+
+    emit progress(current * PROBE_COMPILATIONS + ++currentRepeat, candidates.size() * PROBE_COMPILATIONS);
+
+    if (currentRepeat < PROBE_COMPILATIONS)
+    {
+        compile();
+        return;
+    }
+
+    auto sourcePath = QDir(workDir->filePath(QString::number(current))).filePath("probe.cpp");
+    runner = new Core::Runner(current);
+    connect(runner, &Core::Runner::runFinished, this, &ToolchainProbe::onRunFinished);
+    connect(runner, &Core::Runner::failedToStartRun, this, &ToolchainProbe::onFailedToStartRun);
+    runner->run(sourcePath, QString(), "C++", QString(), QString(), PROBE_INPUT, PROBE_TIME_LIMIT);
+}
+
+void ToolchainProbe::onCompilationError(const QString &error)
+{
+    compiler->disconnect(this);
+    compiler->deleteLater();
+    compiler = nullptr;
+
+    LOG_INFO(INFO_OF(current) << INFO_OF(error));
+
+    if (current == 0)
+    {
+        fail(tr("The current compile command can't build the reference program:\n%1").arg(error.trimmed()));
+        return;
+    }
+
+    auto &candidate = candidates[current];
+    candidate.time = -1;
+    candidate.error = error.trimmed().section('\n', 0, 0);
+    if (candidate.error.isEmpty())
+        candidate.error = tr("Compilation failed");
+    next();
+}
+
+void ToolchainProbe::onRunFinished(int /*index*/, const QString &out, const QString & /*err*/, int exitCode,
+                                   qint64 /*timeUsed*/, bool tle)
+{
+    runner->deleteLater();
+    runner = nullptr;
+
+    auto &candidate = candidates[current];
+    if (tle || exitCode != 0)
+    {
+        candidate.error = tle ? tr("The reference program exceeded the time limit")
+                              : tr("The reference program exited with code %1").arg(exitCode);
+    }
+    else if (current == 0)
+    {
+        expectedOutput = out;
+        candidate.valid = true;
+    }
+    else if (out != expectedOutput)
+    {
+        candidate.error = tr("The output of the reference program is different");
+    }
+    else
+    {
+        candidate.valid = true;
+    }
+
+    if (current == 0 && !candidate.valid)
+    {
+        fail(candidate.error);
+        return;
+    }
+
+    next();
+}
+
+void ToolchainProbe::onFailedToStartRun(int /*index*/, const QString &error)
+{
+    runner->deleteLater();
+    runner = nullptr;
+
+    if (current == 0)
+    {
+        fail(error);
+        return;
+    }
+
+    candidates[current].error = error;
+    next();
+}
+
+void ToolchainProbe::next()
+{
+    ++current;
+    currentRepeat = 0;
+    emit progress(current * PROBE_COMPILATIONS, candidates.size() * PROBE_COMPILATIONS);
+
+    if (current < candidates.size())
+    {
+        compile();
+        return;
+    }
+
+    Result result;
+    result.currentTime = candidates.front().time;
+    result.candidates = candidates;
+    std::stable_sort(result.candidates.begin(), result.candidates.end(), [](const Candidate &a, const Candidate &b) {
+        if (a.valid != b.valid)
+            return a.valid;
+        return a.valid && a.time < b.time;
+    });
+    emit finished(result);
+}
+
+void ToolchainProbe::fail(const QString &reason)
+{
+    LOG_WARN(INFO_OF(reason));
+    emit failed(reason);
+}
+
+} // namespace Extensions
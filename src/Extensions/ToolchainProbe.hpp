@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The ToolchainProbe finds the fastest C++ toolchain installed on the local machine.
+ * The candidates are the C++ compilers found in the PATH, combined with the linkers found in the PATH (lld, mold
+ * and gold, besides the default one), and the flags of the current compile command are kept.
+ * A reference program saved in the Qt Resources is compiled by Core::Compiler with each candidate, and run by
+ * Core::Runner. A candidate is valid if it prints the same output as the current compile command.
+ */
+
+#ifndef TOOLCHAINPROBE_HPP
+#define TOOLCHAINPROBE_HPP
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+
+class QTemporaryDir;
+
+namespace Core
+{
+class Compiler;
+class Runner;
+} // namespace Core
+
+namespace Extensions
+{
+class ToolchainProbe : public QObject
+{
+    Q_OBJECT
+
+  public:
+    struct Candidate
+    {
+        QString compileCommand; // the compile command with this compiler and linker
+        QString compiler;       // the name of the compiler
+        QString linker;         // the name of the linker, empty for the default one
+        qint64 time = -1;       // the fastest compile time in milliseconds, -1 if it doesn't build the program
+        bool valid = false;     // whether the program built by it prints the same output as the current command
+        QString error;          // the reason why it's not valid
+    };
+
+    struct Result
+    {
+        QVector<Candidate> candidates; // the valid ones come first, sorted by time, then the invalid ones
+        qint64 currentTime = 0;        // the compile time of the current compile command
+    };
+
+    explicit ToolchainProbe(QObject *parent = nullptr);
+
+    /**
+     * @brief destruct the probe
+     * @note the running compilation or program is killed
+     */
+    ~ToolchainProbe() override;
+
+    /**
+     * @brief find the candidates and benchmark them
+     * @param compileCommand the current C++ compile command, its flags are used by all candidates
+     * @note This should be called only once. Either finished or failed will be emitted.
+     */
+    void start(const QString &compileCommand);
+
+  signals:
+    /**
+     * @brief a compilation is finished
+     */
+    void progress(int finishedCompilations, int totalCompilations);
+
+    void finished(const Extensions::ToolchainProbe::Result &result);
+
+    void failed(const QString &reason);
+
+  private slots:
+    void onCompilationFinished();
+
+    void onCompilationError(const QString &error);
+
+    void onRunFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed, bool tle);
+
+    void onFailedToStartRun(int index, const QString &error);
+
+  private:
+    /**
+     * @brief find the installed compilers and linkers, the current compile command is the first candidate
+     */
+    void findCandidates(const QString &compileCommand);
+
+    /**
+     * @brief compile the reference program with the current candidate
+     */
+    void compile();
+
+    /**
+     * @brief the current candidate is finished, start the next one or emit finished
+     */
+    void next();
+
+    /**
+     * @brief emit failed and stop
+     */
+    void fail(const QString &reason);
+
+    QTemporaryDir *workDir = nullptr;   // the directories of the reference program, one for each candidate
+    Core::Compiler *compiler = nullptr; // the running compilation
+    Core::Runner *runner = nullptr;     // the running reference program
+    QElapsedTimer compileTimer;         // measures the time of the running compilation
+    QVector<Candidate> candidates;      // the candidates, the first one is the current compile command
+    int current = 0;                    // the index of the current candidate
+    int currentRepeat = 0;              // the number of finished compilations of the current candidate
+    QString expectedOutput;             // the output of the program built by the current compile command
+};
+} // namespace Extensions
+
+#endif // TOOLCHAINPROBE_HPP
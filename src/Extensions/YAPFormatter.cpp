@@ -45,6 +45,14 @@ QStringList YAPFormatter::rangeArgs() const
     return {QString("-l %1-%2").arg(qMin(cursorLine(), anchorLine()) + 1).arg(qMax(cursorLine(), anchorLine()) + 1)};
 }
 
+QStringList YAPFormatter::lineRangeArgs(const QList<QPair<int, int>> &ranges) const
+{
+    QStringList args;
+    for (const auto &range : ranges)
+        args.append(QString("-l %1-%2").arg(range.first).arg(range.second));
+    return args;
+}
+
 QString YAPFormatter::styleFileName() const
 {
     return ".style.yapf";
@@ -55,7 +63,7 @@ QString YAPFormatter::newSource(const QString &out) const
     return out;
 }
 
-QTextCursor YAPFormatter::newCursor(const QString &out, const QStringList & /*args*/) const
+QTextCursor YAPFormatter::newCursor(const QStringList & /*outs*/) const
 {
     auto cursor = editor()->textCursor();
 
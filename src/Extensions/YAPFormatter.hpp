@@ -37,11 +37,13 @@ class YAPFormatter : public CodeFormatter
 
     QStringList rangeArgs() const override;
 
+    QStringList lineRangeArgs(const QList<QPair<int, int>> &ranges) const override;
+
     QString styleFileName() const override;
 
     QString newSource(const QString &out) const override;
 
-    QTextCursor newCursor(const QString &out, const QStringList & /*args*/) const override;
+    QTextCursor newCursor(const QStringList & /*outs*/) const override;
 };
 
 } // namespace Extensions
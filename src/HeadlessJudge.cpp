@@ -0,0 +1,447 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "HeadlessJudge.hpp"
+#include "Core/Checker.hpp"
+#include "Core/Compiler.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/Runner.hpp"
+#include "Settings/SettingsInfo.hpp"
+#include "Util/FileUtil.hpp"
+#include "Widgets/TestCases.hpp"
+#include "generated/SettingsHelper.hpp"
+#include "generated/version.hpp"
+#include <QCollator>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <iostream>
+
+static const int REPORT_STDERR_LIMIT = 4096; // the maximum length of the stderr in the report
+
+static const QMap<QString, Core::Checker::CheckerType> builtinCheckers = {
+    {"ignore-trailing-spaces", Core::Checker::IgnoreTrailingSpaces},
+    {"strict", Core::Checker::Strict},
+    {"ncmp", Core::Checker::Ncmp},
+    {"rcmp4", Core::Checker::Rcmp4},
+    {"rcmp6", Core::Checker::Rcmp6},
+    {"rcmp9", Core::Checker::Rcmp9},
+    {"wcmp", Core::Checker::Wcmp},
+    {"nyesno", Core::Checker::Nyesno}};
+
+bool HeadlessJudge::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        QString arg(argv[i]); // NOLINT: Pointer arithmetics?
+        if (arg == "--judge" || arg == "-judge" || arg.startsWith("--judge="))
+            return true;
+    }
+    return false;
+}
+
+int HeadlessJudge::exec(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("CP Editor");
+    QCoreApplication::setApplicationVersion(DISPLAY_VERSION);
+
+    QCommandLineParser parser;
+    parser.addVersionOption();
+    parser.addHelpOption();
+    QString programName(argv[0]); // NOLINT: Pointer arithmetics?
+    parser.setApplicationDescription(
+        programName +
+        " --judge <file> [--tests <directory>] [--checker <checker>] [--time-limit <ms>] [--lang <language>]\n"
+        "Compile the file, run it on its test cases and print a JSON report, without opening a window.");
+    parser.addOptions(
+        {{"judge", "The source file to judge.", "file"},
+         {"tests", "The directory of the test cases, matched by \"Testcases Matching Rules\". The test cases saved by "
+                   "\"Input File Save Path\" and \"Answer File Save Path\" are used if it's not specified.",
+          "directory"},
+         {"checker",
+          "One of " + QStringList(builtinCheckers.keys()).join(", ") +
+              ", or the path to a testlib checker source. ignore-trailing-spaces is used if it's not specified.",
+          "checker"},
+         {"time-limit", "The time limit in milliseconds. \"Default Time Limit\" is used if it's not specified.", "ms"},
+         {"lang", "The language of the file, one of C++, Java and Python. It's guessed by the suffix if it's not "
+                  "specified.",
+          "language"},
+         {"verbose", "Dump all logs to stderr of the application. (use only for debug purpose)"}});
+    parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
+    parser.process(app);
+
+    Core::Log::init(static_cast<unsigned int>(QCoreApplication::applicationPid()), parser.isSet("verbose"));
+
+    SettingsInfo::updateSettingInfo();
+    SettingsManager::init();
+    // the settings are not saved in this mode, a persistent JVM or judge service is not worth starting for a single
+    // judge, and this process has no unsaved code to protect
+    SettingsManager::set("Java Run Server/Enable", false);
+    SettingsManager::set("Java Run Server/Compile", false);
+    SettingsManager::set("Judge Service/Enable", false);
+
+    Options options;
+    options.filePath = parser.value("judge");
+    options.language = parser.value("lang");
+    options.testsDirectory = parser.value("tests");
+    options.checker = parser.value("checker");
+    if (parser.isSet("time-limit"))
+    {
+        bool ok = false;
+        options.timeLimit = parser.value("time-limit").toInt(&ok);
+        if (!ok || options.timeLimit <= 0)
+        {
+            std::cerr << "The time limit should be a positive integer." << std::endl;
+            return 2;
+        }
+    }
+
+    HeadlessJudge judge(options);
+    QObject::connect(&judge, &HeadlessJudge::finished, &app, &QCoreApplication::exit);
+    QTimer::singleShot(0, &judge, &HeadlessJudge::start);
+    return QCoreApplication::exec();
+}
+
+HeadlessJudge::HeadlessJudge(const Options &options, QObject *parent) : QObject(parent), options(options)
+{
+}
+
+HeadlessJudge::~HeadlessJudge()
+{
+    delete compiler;
+    for (auto *runner : runners)
+        delete runner;
+    delete checker;
+    delete tmpDir;
+}
+
+void HeadlessJudge::start()
+{
+    LOG_INFO(INFO_OF(options.filePath) << INFO_OF(options.language) << INFO_OF(options.testsDirectory)
+                                       << INFO_OF(options.checker) << INFO_OF(options.timeLimit));
+
+    QFileInfo fileInfo(options.filePath);
+    if (!fileInfo.isFile())
+    {
+        report(QString("The file %1 doesn't exist").arg(options.filePath));
+        return;
+    }
+    options.filePath = fileInfo.canonicalFilePath();
+
+    if (options.language.isEmpty())
+    {
+        auto suffix = fileInfo.suffix().toLower();
+        if (Util::cppSuffix.contains(suffix))
+            options.language = "C++";
+        else if (Util::javaSuffix.contains(suffix))
+            options.language = "Java";
+        else if (Util::pythonSuffix.contains(suffix))
+            options.language = "Python";
+    }
+    if (!QStringList({"C++", "Java", "Python"}).contains(options.language))
+    {
+        report("Unknown language, please specify it by --lang");
+        return;
+    }
+
+    timeLimit = options.timeLimit == -1 ? SettingsHelper::getDefaultTimeLimit() : options.timeLimit;
+
+    if (!loadTests())
+    {
+        report("No test cases found");
+        return;
+    }
+
+    if (options.checker.isEmpty() || builtinCheckers.contains(options.checker))
+    {
+        checker = new Core::Checker(builtinCheckers.value(options.checker, Core::Checker::IgnoreTrailingSpaces),
+                                    nullptr, this);
+    }
+    else if (QFileInfo(options.checker).isFile())
+    {
+        checker = new Core::Checker(QFileInfo(options.checker).absoluteFilePath(), nullptr, this);
+    }
+    else
+    {
+        report(QString("Unknown checker %1").arg(options.checker));
+        return;
+    }
+    connect(checker, &Core::Checker::checkFinished, this, &HeadlessJudge::onCheckFinished);
+    connect(checker, &Core::Checker::checkFailed, this, &HeadlessJudge::onCheckFailed);
+    // the testlib checkers are compiled at the same time as the solution
+    checker->prepare(SettingsManager::get("C++/Compile Command").toString());
+
+    // the same file name as the temporary file of MainWindow, so the class name of Java is right
+    tmpDir = new QTemporaryDir();
+    if (!tmpDir->isValid())
+    {
+        report("Failed to create the temporary directory");
+        return;
+    }
+    QString name;
+    if (options.language == "C++")
+        name = "sol." + Util::cppSuffix.first();
+    else if (options.language == "Java")
+        name = SettingsHelper::getJavaClassName() + "." + Util::javaSuffix.first();
+    else
+        name = "sol." + Util::pythonSuffix.first();
+    tmpFilePath = tmpDir->filePath(name);
+    if (!QFile::copy(options.filePath, tmpFilePath))
+    {
+        report("Failed to copy the source file to the temporary directory");
+        return;
+    }
+
+    compileTimer.start();
+    if (options.language == "Python")
+    {
+        onCompilationFinished(QString());
+        return;
+    }
+
+    compiler = new Core::Compiler();
+    connect(compiler, &Core::Compiler::compilationFinished, this, &HeadlessJudge::onCompilationFinished);
+    connect(compiler, &Core::Compiler::compilationErrorOccurred, this, &HeadlessJudge::onCompilationErrorOccurred);
+    connect(compiler, &Core::Compiler::compilationFailed, this, &HeadlessJudge::onCompilationFailed);
+    compiler->start(tmpFilePath, options.filePath,
+                    SettingsManager::get(QString("%1/Compile Command").arg(options.language)).toString(),
+                    options.language);
+}
+
+bool HeadlessJudge::loadTests()
+{
+    auto addTest = [this](const QString &name, const QString &inputPath, const QString &answerPath) {
+        auto input = Util::readFile(inputPath);
+        if (input.isNull())
+            input = "";
+        if (input.trimmed().isEmpty() && !SettingsHelper::isRunOnEmptyTestcase())
+            return;
+        auto expected = answerPath.isEmpty() ? QString() : Util::readFile(answerPath);
+        QJsonObject result;
+        result["name"] = name;
+        result["input"] = inputPath;
+        if (!expected.isNull())
+            result["answer"] = answerPath;
+        tests.push_back({name, input, expected.isNull() ? QString() : expected, result, false, false});
+    };
+
+    if (options.testsDirectory.isEmpty())
+    {
+        // the same as Widgets::TestCases::loadFromSavedFiles
+        for (int i = Widgets::TestCases::MAX_NUMBER_OF_TESTCASES - 1; i >= 0; --i)
+        {
+            if (QFile::exists(Widgets::TestCases::inputFilePath(options.filePath, i)) ||
+                QFile::exists(Widgets::TestCases::answerFilePath(options.filePath, i)))
+            {
+                for (int j = 0; j <= i; ++j)
+                {
+                    addTest(QString("#%1").arg(j + 1), Widgets::TestCases::inputFilePath(options.filePath, j),
+                            Widgets::TestCases::answerFilePath(options.filePath, j));
+                }
+                break;
+            }
+        }
+        return !tests.isEmpty();
+    }
+
+    QDir dir(options.testsDirectory);
+    auto files = dir.entryList(QDir::Files);
+    QCollator collator;
+    collator.setNumericMode(true); // "2.in" before "10.in"
+    std::sort(files.begin(), files.end(), collator);
+
+    // the same as "Add Pairs of Test Cases" of Widgets::TestCases, unpaired inputs are added without answers
+    QSet<QString> remain;
+    for (auto const &file : files)
+        remain.insert(file);
+    for (bool paired : {true, false})
+    {
+        for (auto const &rule : SettingsHelper::getTestcasesMatchingRules())
+        {
+            QRegularExpression inputRegex("^" + rule.toStringList().front() + "$");
+            QString answerReplace(rule.toStringList().back());
+            for (auto const &inputFile : files)
+            {
+                if (!remain.contains(inputFile) || !inputRegex.match(inputFile).hasMatch())
+                    continue;
+                auto answerFile = inputFile;
+                answerFile.replace(inputRegex, answerReplace);
+                if (paired && !remain.contains(answerFile))
+                    continue;
+                remain.remove(inputFile);
+                remain.remove(answerFile);
+                addTest(inputFile, dir.filePath(inputFile), paired ? dir.filePath(answerFile) : QString());
+            }
+        }
+    }
+    return !tests.isEmpty();
+}
+
+void HeadlessJudge::onCompilationFinished(const QString &warning)
+{
+    compilation["success"] = true;
+    compilation["time"] = compileTimer.elapsed();
+    if (!warning.trimmed().isEmpty())
+        compilation["warning"] = warning;
+
+    for (int i = 0; i < tests.length(); ++i)
+        runQueue.enqueue(i);
+    runNextQueued();
+}
+
+void HeadlessJudge::onCompilationErrorOccurred(const QString &error)
+{
+    compilation["success"] = false;
+    compilation["time"] = compileTimer.elapsed();
+    compilation["error"] = error;
+    report("Compilation error");
+}
+
+void HeadlessJudge::onCompilationFailed(const QString &reason)
+{
+    compilation["success"] = false;
+    compilation["error"] = reason;
+    report("Failed to compile");
+}
+
+void HeadlessJudge::runNextQueued()
+{
+    int limit = qMax(1, QThread::idealThreadCount());
+    while (!runQueue.isEmpty() && runningCount < limit)
+    {
+        int index = runQueue.dequeue();
+        auto *runner = new Core::Runner(index);
+        connect(runner, &Core::Runner::runFinished, this, &HeadlessJudge::onRunFinished);
+        connect(runner, &Core::Runner::failedToStartRun, this, &HeadlessJudge::onFailedToStartRun);
+        connect(runner, &Core::Runner::runOutputLimitExceeded, this, &HeadlessJudge::onRunOutputLimitExceeded);
+        runners.push_back(runner);
+        ++runningCount;
+        runner->run(tmpFilePath, options.filePath, options.language,
+                    SettingsManager::get(QString("%1/Run Command").arg(options.language)).toString(),
+                    SettingsManager::get(QString("%1/Run Arguments").arg(options.language)).toString(),
+                    tests[index].input, timeLimit);
+    }
+}
+
+void HeadlessJudge::onRunFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed,
+                                  bool tle)
+{
+    auto &test = tests[index];
+    test.result["time"] = timeUsed;
+    test.result["exitCode"] = exitCode;
+    if (!err.isEmpty())
+        test.result["stderr"] = err.left(REPORT_STDERR_LIMIT);
+    if (test.outputLimitExceeded)
+        test.result["outputLimitExceeded"] = true;
+
+    --runningCount;
+    runNextQueued();
+
+    // the same rules as MainWindow::onRunFinished
+    if (exitCode != 0)
+        finishTest(index, tle ? "TLE" : "RE");
+    else if ((!out.isEmpty() && !test.expected.isEmpty()) || SettingsHelper::isCheckOnTestcasesWithEmptyOutput())
+        checker->reqeustCheck(index, test.input, out, test.expected);
+    else
+        finishTest(index, "UNKNOWN");
+}
+
+void HeadlessJudge::onFailedToStartRun(int index, const QString &error)
+{
+    tests[index].result["error"] = error;
+    --runningCount;
+    runNextQueued();
+    finishTest(index, "FAILED");
+}
+
+void HeadlessJudge::onRunOutputLimitExceeded(int index, const QString & /*unused*/)
+{
+    tests[index].outputLimitExceeded = true;
+}
+
+void HeadlessJudge::onCheckFinished(int index, Widgets::TestCase::Verdict verdict)
+{
+    finishTest(index, verdict == Widgets::TestCase::AC ? "AC" : "WA");
+}
+
+void HeadlessJudge::onCheckFailed(int index, const QString &reason)
+{
+    tests[index].result["checkerError"] = reason;
+    finishTest(index, "UNKNOWN");
+}
+
+void HeadlessJudge::finishTest(int index, const QString &verdict)
+{
+    auto &test = tests[index];
+    if (test.done)
+        return;
+    test.done = true;
+    test.result["verdict"] = verdict;
+    LOG_INFO(INFO_OF(index) << INFO_OF(verdict));
+
+    if (++finishedCount == tests.length())
+        report();
+}
+
+void HeadlessJudge::report(const QString &error)
+{
+    if (reported)
+        return;
+    reported = true;
+
+    QJsonObject json;
+    json["file"] = options.filePath;
+    json["language"] = options.language;
+    json["timeLimit"] = timeLimit;
+    if (!compilation.isEmpty())
+        json["compilation"] = compilation;
+
+    int accepted = 0;
+    QJsonArray results;
+    for (auto const &test : tests)
+    {
+        if (test.result["verdict"].toString() == "AC")
+            ++accepted;
+        results.push_back(test.result);
+    }
+    if (error.isEmpty())
+    {
+        json["tests"] = results;
+        json["accepted"] = accepted;
+        json["total"] = tests.length();
+    }
+    else
+    {
+        json["error"] = error;
+    }
+
+    std::cout << QJsonDocument(json).toJson().toStdString() << std::flush;
+
+    int exitCode = 2;
+    if (error.isEmpty())
+        exitCode = accepted == tests.length() ? 0 : 1;
+    // the runners and the checker are deleted with the judge after the event loop exits
+    QTimer::singleShot(0, this, [this, exitCode] { emit finished(exitCode); });
+}
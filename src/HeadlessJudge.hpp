@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The HeadlessJudge compiles a source file, runs it on its test cases and prints a JSON report, without any widget.
+ * It's started by `cpeditor --judge <file>` with a QCoreApplication, so it can be used in scripts and hooks.
+ * The test cases are loaded by the "Input File Save Path" and "Answer File Save Path" rules of the source file,
+ * or by the "Testcases Matching Rules" from a directory given by --tests.
+ * Core::Compiler, Core::Runner and Core::Checker are used in the same way as MainWindow.
+ */
+
+#ifndef HEADLESSJUDGE_HPP
+#define HEADLESSJUDGE_HPP
+
+#include "Widgets/TestCase.hpp"
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QQueue>
+#include <QVector>
+
+class QTemporaryDir;
+
+namespace Core
+{
+class Checker;
+class Compiler;
+class Runner;
+} // namespace Core
+
+class HeadlessJudge : public QObject
+{
+    Q_OBJECT
+
+  public:
+    struct Options
+    {
+        QString filePath;       // the path to the source file
+        QString language;       // the language of the source file, guessed by the suffix if it's empty
+        QString testsDirectory; // the directory of the test cases, the saved test cases are used if it's empty
+        QString checker;        // the name of a built-in checker, or the path to a custom checker
+        int timeLimit = -1;     // the time limit in milliseconds, "Default Time Limit" is used if it's -1
+    };
+
+    /**
+     * @brief whether the command line arguments request the headless judge
+     * @note this is checked before any QCoreApplication is created, so it only looks for --judge
+     */
+    static bool isRequested(int argc, char *argv[]);
+
+    /**
+     * @brief parse the arguments, run the headless judge in a QCoreApplication and return the exit code
+     * @returns 0 if all test cases are accepted, 1 if some are not, 2 if it can't judge, e.g. compilation error
+     */
+    static int exec(int argc, char *argv[]);
+
+    explicit HeadlessJudge(const Options &options, QObject *parent = nullptr);
+
+    ~HeadlessJudge() override;
+
+    /**
+     * @brief load the test cases, prepare the checker and compile the source file
+     */
+    void start();
+
+  signals:
+    /**
+     * @brief the report is printed
+     * @param exitCode the exit code of the process, the same as exec()
+     */
+    void finished(int exitCode);
+
+  private slots:
+    void onCompilationFinished(const QString &warning);
+    void onCompilationErrorOccurred(const QString &error);
+    void onCompilationFailed(const QString &reason);
+
+    void onRunFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed, bool tle);
+    void onFailedToStartRun(int index, const QString &error);
+    void onRunOutputLimitExceeded(int index, const QString &type);
+
+    void onCheckFinished(int index, Widgets::TestCase::Verdict verdict);
+    void onCheckFailed(int index, const QString &reason);
+
+  private:
+    struct Test
+    {
+        QString name;             // the name of the test case in the report
+        QString input;            // the input of the test case
+        QString expected;         // the expected output, empty if there's no answer file
+        QJsonObject result;       // the result in the report, filled when the test case is finished
+        bool outputLimitExceeded; // whether the program is killed by the output length limit
+        bool done;                // whether the verdict is given
+    };
+
+    /**
+     * @brief load the test cases from testsDirectory or the saved files
+     * @returns false if no test case is found
+     */
+    bool loadTests();
+
+    /**
+     * @brief start the queued test cases, at most as many as the CPU cores at the same time
+     */
+    void runNextQueued();
+
+    /**
+     * @brief give the verdict of a test case, and print the report if all test cases are finished
+     * @param verdict one of "AC", "WA", "TLE", "RE", "UNKNOWN" and "FAILED"
+     */
+    void finishTest(int index, const QString &verdict);
+
+    /**
+     * @brief print the report and emit finished
+     * @param error the reason why it can't judge, empty if all test cases are judged
+     */
+    void report(const QString &error = QString());
+
+    Options options;
+    int timeLimit = 0;                       // the time limit used by the runs
+    QString tmpFilePath;                     // the copy of the source file which is compiled
+    QTemporaryDir *tmpDir = nullptr;         // the directory of tmpFilePath
+    Core::Compiler *compiler = nullptr;      // the compiler of the source file
+    Core::Checker *checker = nullptr;        // the checker of the outputs
+    QVector<Core::Runner *> runners;         // the runners of the started test cases
+    QVector<Test> tests;                     // the test cases
+    QQueue<int> runQueue;                    // the test cases waiting to run
+    int runningCount = 0;                    // the number of runs which are not finished
+    int finishedCount = 0;                   // the number of test cases with verdicts
+    QJsonObject compilation;                 // the compilation part of the report
+    QElapsedTimer compileTimer;              // the timer to measure the compilation
+    bool reported = false;                   // whether the report is printed
+};
+
+#endif // HEADLESSJUDGE_HPP
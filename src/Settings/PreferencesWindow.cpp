@@ -195,7 +195,8 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
             .page(TRKEY("General"), {"Default Language"})
             .dir(TRKEY("C++"))
                 .page("C++ Commands", tr("%1 Commands").arg(tr("C++")),
-                      {"C++/Compile Command", "C++/Output Path", "C++/Run Arguments", "C++/Compiler Output Codec"})
+                      {"C++/Compile Command", "C++/Output Path", "C++/Run Arguments", "C++/Compiler Output Codec",
+                       "C++/Sanitizer Build", "C++/Sanitizer Flags"})
                 .page("C++ Template", tr("%1 Template").arg(tr("C++")),
                       {"C++/Template Path", "C++/Template Cursor Position Regex",
                        "C++/Template Cursor Position Offset Type", "C++/Template Cursor Position Offset Characters"})
@@ -244,7 +245,13 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
 #endif
             .page(TRKEY("Save Session"), {"Hot Exit/Enable", "Hot Exit/Auto Save", "Hot Exit/Auto Save Interval"})
             .page(TRKEY("Bind file and problem"), {"Restore Old Problem Url", "Open Old File For Old Problem Url"})
-            .page(TRKEY("Test Cases"), {"Run On Empty Testcase", "Check On Testcases With Empty Output", "Auto Uncheck Accepted Testcases"})
+            .page(TRKEY("Test Cases"), {"Run On Empty Testcase", "Check On Testcases With Empty Output", "Auto Uncheck Accepted Testcases",
+                                        "Check Output While Running", "Stop On First Failure",
+                                        "Run Smallest Testcases First", "Run Result Cache"
+#ifdef Q_OS_LINUX
+                                        , "Detect Input Exhaustion", "Stable Timing Repeats"
+#endif
+                                        })
             .page(TRKEY("Load External File Changes"), {"Auto Load External Changes If No Unsaved Modification", "Ask For Loading External Changes"})
         .end()
         .dir(TRKEY("Extensions"))
@@ -261,8 +268,13 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
             .page(TRKEY("Competitive Companion"), {"Competitive Companion/Enable", "Competitive Companion/Open New Tab",
                 "Competitive Companion/Set Time Limit For Tab", "Competitive Companion/Connection Port",
                 "Competitive Companion/Head Comments", "Competitive Companion/Head Comments Time Format",
-                "Competitive Companion/Head Comments Powered By CP Editor"}, false)
+                "Competitive Companion/Head Comments Powered By CP Editor", "Competitive Companion/Local API",
+                "Competitive Companion/Local API Token"}, false)
             .page(TRKEY("CF Tool"), {"CF/Path", "CF/Show Toast Messages"})
+            .page(TRKEY("Java Run Server"), {"Java Run Server/Enable", "Java Run Server/Compile"})
+#ifdef Q_OS_LINUX
+            .page(TRKEY("Profiler"), {"Profiler/Path", "Profiler/Frequency", "Profiler/Compile Flags"})
+#endif
         .end()
         .dir(TRKEY("File Path"))
             .page(TRKEY("Testcases"), {"Input File Save Path", "Answer File Save Path", "Testcases Matching Rules"})
@@ -275,7 +287,12 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
             .page(TRKEY("Update"), {"Check Update", "Beta"})
             .page(TRKEY("Limits"), {"Default Time Limit", "Output Length Limit", "Output Display Length Limit", "Message Length Limit",
                                     "HTML Diff Viewer Length Limit", "Open File Length Limit", "Display Test Case Length Limit"})
+            .page(TRKEY("Judge Speed"), {"Judge Speed/Enable", "Judge Speed/Local Score", "Judge Speed/Judges"})
+            .page(TRKEY("Judge Service"), {"Judge Service/Enable"})
             .page(TRKEY("Network Proxy"), {"Proxy/Enabled", "Proxy/Type", "Proxy/Host Name", "Proxy/Port", "Proxy/User", "Proxy/Password"})
+#ifdef Q_OS_LINUX
+            .page(TRKEY("Process Launcher"), {"Fast Process Launcher"})
+#endif
         .end()
     .ensureAtTop();
 
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/CompileProfileDialog.hpp"
+#include <QHeaderView>
+#include <QTabWidget>
+#include <QTableWidget>
+
+namespace Widgets
+{
+CompileProfileDialog::CompileProfileDialog(QWidget *parent) : QMainWindow(parent)
+{
+    setWindowTitle(tr("Compilation Profile"));
+    resize(960, 540);
+
+    tabWidget = new QTabWidget(this);
+    setCentralWidget(tabWidget);
+
+    auto createTable = [this] {
+        auto *table = new QTableWidget(0, 3, tabWidget);
+        table->setHorizontalHeaderLabels({tr("Time (ms)"), tr("Count"), tr("Name")});
+        table->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Stretch);
+        table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        table->setSelectionBehavior(QAbstractItemView::SelectRows);
+        table->verticalHeader()->hide();
+        return table;
+    };
+
+    headersTable = createTable();
+    headersTable->setToolTip(tr("The time of a header includes the time of the headers included by it"));
+    instantiationsTable = createTable();
+    instantiationsTable->setToolTip(
+        tr("The time of an instantiation includes the time of the instantiations required by it"));
+    phasesTable = createTable();
+
+    tabWidget->addTab(headersTable, tr("Headers"));
+    tabWidget->addTab(instantiationsTable, tr("Instantiations"));
+    tabWidget->addTab(phasesTable, tr("Phases"));
+}
+
+void CompileProfileDialog::setResult(const Extensions::CompileProfiler::Result &result)
+{
+    setWindowTitle(tr("Compilation Profile - %1 ms by %2").arg(result.totalTime / 1000).arg(result.compiler));
+
+    setEntries(headersTable, result.headers);
+    setEntries(instantiationsTable, result.instantiations);
+    setEntries(phasesTable, result.phases);
+
+    // GCC only reports the phases, the tabs of the headers and the instantiations are disabled for it
+    for (int i = tabWidget->count() - 1; i >= 0; --i)
+    {
+        tabWidget->setTabEnabled(i, qobject_cast<QTableWidget *>(tabWidget->widget(i))->rowCount() > 0);
+        if (tabWidget->isTabEnabled(i))
+            tabWidget->setCurrentIndex(i);
+    }
+}
+
+void CompileProfileDialog::setEntries(QTableWidget *table, const QVector<Extensions::CompileProfiler::Entry> &entries)
+{
+    table->setRowCount(entries.size());
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        const auto &entry = entries[i];
+        table->setItem(i, 0, new QTableWidgetItem(QString::number(entry.time / 1000.0, 'f', 1)));
+        table->setItem(i, 1, new QTableWidgetItem(QString::number(entry.count)));
+        auto *nameItem = new QTableWidgetItem(entry.name);
+        nameItem->setToolTip(entry.name);
+        table->setItem(i, 2, nameItem);
+    }
+}
+} // namespace Widgets
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The CompileProfileDialog shows the result of Extensions::CompileProfiler.
+ * There is a table for the headers, the template instantiations and the phases of the compiler each.
+ */
+
+#ifndef COMPILEPROFILEDIALOG_HPP
+#define COMPILEPROFILEDIALOG_HPP
+
+#include "Extensions/CompileProfiler.hpp"
+#include <QMainWindow>
+
+class QTabWidget;
+class QTableWidget;
+
+namespace Widgets
+{
+class CompileProfileDialog : public QMainWindow
+{
+    Q_OBJECT
+
+  public:
+    explicit CompileProfileDialog(QWidget *parent = nullptr);
+    void setResult(const Extensions::CompileProfiler::Result &result);
+
+  private:
+    /**
+     * @brief fill a table with the entries, in the order of them
+     */
+    void setEntries(QTableWidget *table, const QVector<Extensions::CompileProfiler::Entry> &entries);
+
+    QTabWidget *tabWidget = nullptr;
+    QTableWidget *headersTable = nullptr;
+    QTableWidget *instantiationsTable = nullptr;
+    QTableWidget *phasesTable = nullptr;
+};
+} // namespace Widgets
+#endif // COMPILEPROFILEDIALOG_HPP
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/ComplexityDialog.hpp"
+#include "Core/EventLogger.hpp"
+#include "generated/SettingsHelper.hpp"
+#include <QApplication>
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QToolButton>
+#include <QVBoxLayout>
+#include <cmath>
+
+namespace Widgets
+{
+
+/**
+ * @brief format a time in milliseconds for humans, it can be very large for the exponential model
+ */
+static QString formatTime(double milliseconds)
+{
+    if (!std::isfinite(milliseconds) || milliseconds > 1e12)
+        return ComplexityDialog::tr("forever");
+    if (milliseconds < 1000)
+        return ComplexityDialog::tr("%1ms").arg(qRound64(milliseconds));
+    if (milliseconds < 1000 * 60)
+        return ComplexityDialog::tr("%1s").arg(milliseconds / 1000, 0, 'f', 2);
+    if (milliseconds < 1000 * 3600)
+        return ComplexityDialog::tr("%1min").arg(milliseconds / 1000 / 60, 0, 'f', 1);
+    return ComplexityDialog::tr("%1h").arg(milliseconds / 1000 / 3600, 0, 'f', 1);
+}
+
+ComplexityDialog::ComplexityDialog(QWidget *parent) : QDialog(parent)
+{
+    setWindowTitle(tr("Estimate Complexity"));
+    resize(560, 640);
+
+    auto *mainLayout = new QVBoxLayout(this);
+
+    auto *groupBox = new QGroupBox(tr("Input"));
+    mainLayout->addWidget(groupBox);
+
+    auto *formLayout = new QFormLayout(groupBox);
+
+    auto *generatorLayout = new QHBoxLayout();
+    generatorLayout->setContentsMargins(0, 0, 0, 0);
+    formLayout->addRow(tr("Generator"), generatorLayout);
+
+    generatorEdit = new QLineEdit();
+    generatorEdit->setPlaceholderText(tr("e.g. python3 gen.py"));
+    generatorEdit->setToolTip(tr("The command of the generator. The size n is appended as the last argument, and the "
+                                 "generator should print the input of size n.\nRelative paths are relative to the "
+                                 "directory of the source file."));
+    generatorLayout->addWidget(generatorEdit);
+
+    auto *generatorToolButton = new QToolButton();
+    generatorToolButton->setIcon(QApplication::style()->standardIcon(QStyle::SP_DialogOpenButton));
+    connect(generatorToolButton, &QToolButton::clicked, this, &ComplexityDialog::chooseGenerator);
+    generatorLayout->addWidget(generatorToolButton);
+
+    startSizeSpinBox = new QSpinBox();
+    startSizeSpinBox->setRange(1, 1000000000);
+    startSizeSpinBox->setToolTip(tr("The first size to measure, the size is doubled each time"));
+    formLayout->addRow(tr("Start size"), startSizeSpinBox);
+
+    maxConstraintSpinBox = new QSpinBox();
+    maxConstraintSpinBox->setRange(1, 2000000000);
+    maxConstraintSpinBox->setToolTip(tr("The maximum n in the problem statement, the running time at it is predicted"));
+    formLayout->addRow(tr("Max constraint"), maxConstraintSpinBox);
+
+    repeatsSpinBox = new QSpinBox();
+    repeatsSpinBox->setRange(1, 20);
+    repeatsSpinBox->setToolTip(tr("The number of runs of each size, the fastest one is used"));
+    formLayout->addRow(tr("Repeats"), repeatsSpinBox);
+
+    auto *buttonLayout = new QHBoxLayout();
+    mainLayout->addLayout(buttonLayout);
+    statusLabel = new QLabel();
+    statusLabel->setWordWrap(true);
+    statusLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+    buttonLayout->addWidget(statusLabel);
+    startButton = new QPushButton(tr("Start"));
+    connect(startButton, &QPushButton::clicked, this, [this] {
+        LOG_INFO(INFO_OF(generatorEdit->text()));
+        SettingsHelper::setComplexityEstimatorGenerator(generatorEdit->text());
+        SettingsHelper::setComplexityEstimatorStartSize(startSizeSpinBox->value());
+        SettingsHelper::setComplexityEstimatorMaxConstraint(maxConstraintSpinBox->value());
+        SettingsHelper::setComplexityEstimatorRepeats(repeatsSpinBox->value());
+        emit startRequested();
+    });
+    buttonLayout->addWidget(startButton);
+    stopButton = new QPushButton(tr("Stop"));
+    stopButton->setEnabled(false);
+    connect(stopButton, &QPushButton::clicked, this, [this] {
+        emit stopRequested();
+        setStopped(tr("Stopped"));
+    });
+    buttonLayout->addWidget(stopButton);
+
+    samplesTable = new QTableWidget(0, 2);
+    samplesTable->setHorizontalHeaderLabels({tr("n"), tr("Time")});
+    samplesTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    samplesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    samplesTable->verticalHeader()->hide();
+    mainLayout->addWidget(samplesTable);
+
+    fitsTable = new QTableWidget(0, 3);
+    fitsTable->setHorizontalHeaderLabels({tr("Model"), tr("Error"), tr("Predicted time at max constraint")});
+    fitsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    fitsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    fitsTable->verticalHeader()->hide();
+    mainLayout->addWidget(fitsTable);
+
+    generatorEdit->setText(SettingsHelper::getComplexityEstimatorGenerator());
+    startSizeSpinBox->setValue(SettingsHelper::getComplexityEstimatorStartSize());
+    maxConstraintSpinBox->setValue(SettingsHelper::getComplexityEstimatorMaxConstraint());
+    repeatsSpinBox->setValue(SettingsHelper::getComplexityEstimatorRepeats());
+}
+
+Extensions::ComplexityEstimator::Options ComplexityDialog::options() const
+{
+    Extensions::ComplexityEstimator::Options options;
+    options.generator = generatorEdit->text();
+    options.startSize = startSizeSpinBox->value();
+    options.maxConstraint = maxConstraintSpinBox->value();
+    options.repeats = repeatsSpinBox->value();
+    return options;
+}
+
+void ComplexityDialog::setRunning()
+{
+    running = true;
+    startButton->setEnabled(false);
+    stopButton->setEnabled(true);
+    statusLabel->setText(tr("Measuring..."));
+    samplesTable->setRowCount(0);
+    fitsTable->setRowCount(0);
+}
+
+void ComplexityDialog::addSample(const Extensions::ComplexityEstimator::Sample &sample)
+{
+    int row = samplesTable->rowCount();
+    samplesTable->insertRow(row);
+    samplesTable->setItem(row, 0, new QTableWidgetItem(QString::number(sample.size)));
+    samplesTable->setItem(row, 1, new QTableWidgetItem(formatTime(sample.time)));
+}
+
+void ComplexityDialog::setResult(const Extensions::ComplexityEstimator::Result &result, int timeLimit)
+{
+    running = false;
+    startButton->setEnabled(true);
+    stopButton->setEnabled(false);
+
+    fitsTable->setRowCount(result.fits.size());
+    for (int i = 0; i < result.fits.size(); ++i)
+    {
+        const auto &fit = result.fits[i];
+        fitsTable->setItem(i, 0, new QTableWidgetItem(Extensions::ComplexityEstimator::modelName(fit.model)));
+        fitsTable->setItem(i, 1, new QTableWidgetItem(QString("%1%").arg(fit.error * 100, 0, 'f', 1)));
+        fitsTable->setItem(i, 2, new QTableWidgetItem(formatTime(fit.predictedTime)));
+    }
+
+    if (result.fits.isEmpty())
+    {
+        statusLabel->setText(tr("Failed to fit the running time"));
+        return;
+    }
+
+    const auto &best = result.fits.front();
+    QString status = tr("Best fit: %1, predicted %2 at n = %3, %4 the time limit (%5).")
+                         .arg(Extensions::ComplexityEstimator::modelName(best.model))
+                         .arg(formatTime(best.predictedTime))
+                         .arg(maxConstraintSpinBox->value())
+                         .arg(best.predictedTime <= timeLimit ? tr("within") : tr("exceeding"))
+                         .arg(formatTime(timeLimit));
+    if (result.samples.last().time < 50)
+        status += "\n" + tr("The running time is short, the estimation may be dominated by noise. "
+                            "Please try larger sizes.");
+    if (!result.stopReason.isEmpty())
+        status += "\n" + result.stopReason;
+    statusLabel->setText(status);
+}
+
+void ComplexityDialog::setStopped(const QString &reason)
+{
+    running = false;
+    startButton->setEnabled(true);
+    stopButton->setEnabled(false);
+    statusLabel->setText(reason);
+}
+
+void ComplexityDialog::hideEvent(QHideEvent *event)
+{
+    if (running)
+    {
+        emit stopRequested();
+        setStopped(tr("Stopped"));
+    }
+    QDialog::hideEvent(event);
+}
+
+void ComplexityDialog::chooseGenerator()
+{
+    auto path = QFileDialog::getOpenFileName(this, tr("Choose Generator"));
+    if (!path.isEmpty())
+        generatorEdit->setText(QString("\"%1\"").arg(path));
+}
+
+} // namespace Widgets
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The ComplexityDialog is the user interface of Extensions::ComplexityEstimator.
+ * It takes the generator and the sizes, shows the measured running time of each size,
+ * and shows the fits of the models with the predicted running time at the maximum constraint.
+ */
+
+#ifndef COMPLEXITYDIALOG_HPP
+#define COMPLEXITYDIALOG_HPP
+
+#include "Extensions/ComplexityEstimator.hpp"
+#include <QDialog>
+
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QSpinBox;
+class QTableWidget;
+
+namespace Widgets
+{
+class ComplexityDialog : public QDialog
+{
+    Q_OBJECT
+
+  public:
+    explicit ComplexityDialog(QWidget *parent = nullptr);
+
+    /**
+     * @brief the options filled in the dialog, the time limit is not included
+     */
+    Extensions::ComplexityEstimator::Options options() const;
+
+    /**
+     * @brief clear the last result and show that the solution is being compiled and measured
+     */
+    void setRunning();
+
+    void addSample(const Extensions::ComplexityEstimator::Sample &sample);
+
+    /**
+     * @brief show the fits and the verdict
+     * @param result the result of the estimator
+     * @param timeLimit the time limit of the problem, in milliseconds
+     */
+    void setResult(const Extensions::ComplexityEstimator::Result &result, int timeLimit);
+
+    /**
+     * @brief show that the estimation is stopped
+     * @param reason the reason shown to the user
+     */
+    void setStopped(const QString &reason);
+
+  signals:
+    void startRequested();
+
+    void stopRequested();
+
+  protected:
+    void hideEvent(QHideEvent *event) override;
+
+  private slots:
+    void chooseGenerator();
+
+  private:
+    QLineEdit *generatorEdit = nullptr;
+    QSpinBox *startSizeSpinBox = nullptr;
+    QSpinBox *maxConstraintSpinBox = nullptr;
+    QSpinBox *repeatsSpinBox = nullptr;
+    QPushButton *startButton = nullptr;
+    QPushButton *stopButton = nullptr;
+    QLabel *statusLabel = nullptr;
+    QTableWidget *samplesTable = nullptr;
+    QTableWidget *fitsTable = nullptr;
+    bool running = false;
+};
+} // namespace Widgets
+
+#endif // COMPLEXITYDIALOG_HPP
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/DiagnosticsView.hpp"
+#include <QFileInfo>
+#include <QFontDatabase>
+#include <QHeaderView>
+#include <QTimer>
+
+namespace Widgets
+{
+
+// the number of diagnostics added to the tree in each iteration of the event loop
+static const int BATCH_SIZE = 100;
+
+DiagnosticsView::DiagnosticsView(QWidget *parent) : QTreeWidget(parent)
+{
+    setColumnCount(2);
+    setHeaderLabels({tr("Location"), tr("Message")});
+    header()->setStretchLastSection(true);
+    setUniformRowHeights(true);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setToolTip(tr("Double click a diagnostic in the source file to go to it"));
+    hide();
+
+    connect(this, &QTreeWidget::itemExpanded, this, &DiagnosticsView::onItemExpanded);
+    connect(this, &QTreeWidget::itemDoubleClicked, this, &DiagnosticsView::onItemDoubleClicked);
+}
+
+void DiagnosticsView::setDiagnostics(const QVector<Core::CompilerDiagnostics::Diagnostic> &diagnostics,
+                                     const QString &sourceFilePath)
+{
+    clearDiagnostics();
+
+    if (diagnostics.isEmpty())
+        return;
+
+    this->diagnostics = diagnostics;
+    sourcePath = QFileInfo(sourceFilePath).canonicalFilePath();
+    show();
+    addBatch();
+}
+
+void DiagnosticsView::clearDiagnostics()
+{
+    ++generation;
+    clear();
+    diagnostics.clear();
+    sourcePath.clear();
+    addedCount = 0;
+    hide();
+}
+
+void DiagnosticsView::addBatch()
+{
+    bool firstBatch = addedCount == 0;
+    int end = qMin(addedCount + BATCH_SIZE, diagnostics.size());
+    for (; addedCount < end; ++addedCount)
+        addTopLevelItem(createItem(diagnostics[addedCount], {addedCount}));
+
+    if (firstBatch)
+        resizeColumnToContents(0);
+
+    if (addedCount < diagnostics.size())
+    {
+        int current = generation;
+        QTimer::singleShot(0, this, [this, current] {
+            if (current == generation)
+                addBatch();
+        });
+    }
+}
+
+QTreeWidgetItem *DiagnosticsView::createItem(const Core::CompilerDiagnostics::Diagnostic &diagnostic,
+                                             const QVector<int> &path)
+{
+    auto *item = new QTreeWidgetItem();
+
+    QString location = QFileInfo(diagnostic.file).fileName();
+    if (diagnostic.line > 0)
+        location += QString(":%1").arg(diagnostic.line);
+    if (diagnostic.column > 0)
+        location += QString(":%1").arg(diagnostic.column);
+    item->setText(0, location);
+    item->setToolTip(0, diagnostic.file);
+
+    QString message = diagnostic.message;
+    if (diagnostic.repeats > 1)
+        message = tr("%1 (repeated %2 times)").arg(message).arg(diagnostic.repeats);
+    item->setText(1, message);
+    item->setToolTip(1, Core::CompilerDiagnostics::headline(diagnostic));
+
+    switch (diagnostic.severity)
+    {
+    case Core::CompilerDiagnostics::Error:
+        item->setForeground(1, Qt::red);
+        break;
+    case Core::CompilerDiagnostics::Warning:
+        item->setForeground(1, Qt::darkGreen); // the same as the warnings in the message logger
+        break;
+    case Core::CompilerDiagnostics::Note:
+    case Core::CompilerDiagnostics::Context:
+        break;
+    }
+
+    QVariantList pathData;
+    for (int index : path)
+        pathData.push_back(index);
+    item->setData(0, Qt::UserRole, pathData);
+
+    if (!diagnostic.details.isEmpty() || !diagnostic.children.isEmpty())
+        item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+
+    return item;
+}
+
+const Core::CompilerDiagnostics::Diagnostic *DiagnosticsView::diagnosticOf(QTreeWidgetItem *item) const
+{
+    auto pathData = item->data(0, Qt::UserRole).toList();
+    if (pathData.isEmpty())
+        return nullptr; // the lines of the details
+
+    const Core::CompilerDiagnostics::Diagnostic *diagnostic = nullptr;
+    for (const auto &index : pathData)
+    {
+        const auto &list = diagnostic == nullptr ? diagnostics : diagnostic->children;
+        int i = index.toInt();
+        if (i < 0 || i >= list.size())
+            return nullptr;
+        diagnostic = &list[i];
+    }
+    return diagnostic;
+}
+
+void DiagnosticsView::onItemExpanded(QTreeWidgetItem *item)
+{
+    if (item->childCount() > 0)
+        return;
+
+    const auto *diagnostic = diagnosticOf(item);
+    if (diagnostic == nullptr)
+        return;
+
+    auto path = item->data(0, Qt::UserRole).toList();
+    auto font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+
+    // the details are the excerpt of the code and the caret, they are shown before the context and the notes
+    QList<QTreeWidgetItem *> children;
+    for (const auto &line : diagnostic->details)
+    {
+        auto *detail = new QTreeWidgetItem();
+        detail->setText(1, line);
+        detail->setFont(1, font);
+        children.push_back(detail);
+    }
+
+    QVector<int> childPath;
+    for (const auto &index : path)
+        childPath.push_back(index.toInt());
+    childPath.push_back(0);
+    for (int i = 0; i < diagnostic->children.size(); ++i)
+    {
+        childPath.last() = i;
+        children.push_back(createItem(diagnostic->children[i], childPath));
+    }
+
+    item->addChildren(children);
+}
+
+void DiagnosticsView::onItemDoubleClicked(QTreeWidgetItem *item)
+{
+    const auto *diagnostic = diagnosticOf(item);
+    if (diagnostic == nullptr || diagnostic->line <= 0 || sourcePath.isEmpty())
+        return;
+
+    if (QFileInfo(diagnostic->file).canonicalFilePath() == sourcePath)
+        emit requestGoToLine(diagnostic->line, diagnostic->column);
+}
+
+} // namespace Widgets
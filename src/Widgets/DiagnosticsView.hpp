@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The DiagnosticsView shows the diagnostics of a compilation in a tree, below the message logger.
+ * The diagnostics are added in batches in the event loop, and the children are added when they are expanded,
+ * so that a huge output of the compiler doesn't block the user interface.
+ */
+
+#ifndef DIAGNOSTICSVIEW_HPP
+#define DIAGNOSTICSVIEW_HPP
+
+#include "Core/CompilerDiagnostics.hpp"
+#include <QTreeWidget>
+
+namespace Widgets
+{
+class DiagnosticsView : public QTreeWidget
+{
+    Q_OBJECT
+
+  public:
+    explicit DiagnosticsView(QWidget *parent = nullptr);
+
+    /**
+     * @brief show the diagnostics of a compilation, the view is hidden if there is no diagnostic
+     * @param diagnostics the diagnostics parsed by Core::CompilerDiagnostics
+     * @param sourceFilePath the path of the compiled file, the diagnostics in it can be double clicked to go to them
+     */
+    void setDiagnostics(const QVector<Core::CompilerDiagnostics::Diagnostic> &diagnostics,
+                        const QString &sourceFilePath);
+
+    /**
+     * @brief remove all diagnostics and hide the view
+     */
+    void clearDiagnostics();
+
+  signals:
+    void requestGoToLine(int line, int column);
+
+  private slots:
+    void onItemExpanded(QTreeWidgetItem *item);
+
+    void onItemDoubleClicked(QTreeWidgetItem *item);
+
+  private:
+    /**
+     * @brief add the next batch of the diagnostics
+     */
+    void addBatch();
+
+    /**
+     * @brief create the item of a diagnostic
+     * @param path the indices of the diagnostic in the tree, stored in the item to add the children lazily
+     */
+    QTreeWidgetItem *createItem(const Core::CompilerDiagnostics::Diagnostic &diagnostic, const QVector<int> &path);
+
+    /**
+     * @brief find the diagnostic of an item
+     */
+    const Core::CompilerDiagnostics::Diagnostic *diagnosticOf(QTreeWidgetItem *item) const;
+
+    QVector<Core::CompilerDiagnostics::Diagnostic> diagnostics; // the diagnostics being shown
+    QString sourcePath;                                          // the canonical path of the compiled file
+    int addedCount = 0;                                          // the number of diagnostics added to the tree
+    int generation = 0;                                          // increased on every change, stops the stale batches
+};
+} // namespace Widgets
+
+#endif // DIAGNOSTICSVIEW_HPP
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/FlameGraph.hpp"
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+
+namespace Widgets
+{
+static const int frameHeight = 18;
+
+FlameGraph::FlameGraph(QWidget *parent) : QWidget(parent)
+{
+    setMouseTracking(true);
+}
+
+void FlameGraph::setRoot(const Extensions::Profiler::FlameNode &node)
+{
+    root = node;
+    zoomed = &root;
+    setMinimumHeight(depthOf(root) * frameHeight);
+    update();
+}
+
+bool FlameGraph::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip)
+    {
+        auto *helpEvent = static_cast<QHelpEvent *>(event);
+        const auto *frame = frameAt(helpEvent->pos());
+        if (frame != nullptr && root.samples > 0)
+        {
+            QToolTip::showText(helpEvent->globalPos(),
+                               tr("%1\n%2 samples, %3%")
+                                   .arg(frame->node->name)
+                                   .arg(frame->node->samples)
+                                   .arg(100.0 * frame->node->samples / root.samples, 0, 'f', 2));
+        }
+        else
+        {
+            QToolTip::hideText();
+            event->ignore();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+void FlameGraph::paintEvent(QPaintEvent * /*event*/)
+{
+    frames.clear();
+    if (zoomed == nullptr || zoomed->samples == 0)
+        return;
+
+    layoutNode(zoomed, 0, width(), 0);
+
+    QPainter painter(this);
+    painter.setFont(font());
+    for (const auto &frame : frames)
+    {
+        // the same name always gets the same warm color, so a function is easy to follow across the graph
+        auto hash = qHash(frame.node->name);
+        QColor color(205 + int(hash % 50), 80 + int((hash >> 8) % 120), 40 + int((hash >> 16) % 40));
+        painter.fillRect(frame.rect.adjusted(0, 0, -1, -1), color);
+        if (frame.rect.width() > 20)
+        {
+            painter.setPen(Qt::black);
+            auto textRect = frame.rect.adjusted(3, 0, -3, 0);
+            painter.drawText(textRect, Qt::AlignVCenter | Qt::AlignLeft,
+                             painter.fontMetrics().elidedText(frame.node->name, Qt::ElideRight, int(textRect.width())));
+        }
+    }
+}
+
+void FlameGraph::mousePressEvent(QMouseEvent *event)
+{
+    const auto *frame = frameAt(event->pos());
+    if (frame == nullptr)
+        return;
+    zoomed = frame->node == zoomed ? &root : frame->node;
+    update();
+}
+
+void FlameGraph::layoutNode(const Extensions::Profiler::FlameNode *node, qreal x, qreal width, int depth)
+{
+    if (width < 1)
+        return;
+    frames.push_back({QRectF(x, depth * frameHeight, width, frameHeight), node});
+    for (const auto &child : node->children)
+    {
+        qreal childWidth = width * child.samples / node->samples;
+        layoutNode(&child, x, childWidth, depth + 1);
+        x += childWidth;
+    }
+}
+
+const FlameGraph::Frame *FlameGraph::frameAt(const QPoint &pos) const
+{
+    for (const auto &frame : frames)
+    {
+        if (frame.rect.contains(pos))
+            return &frame;
+    }
+    return nullptr;
+}
+
+int FlameGraph::depthOf(const Extensions::Profiler::FlameNode &node)
+{
+    int depth = 0;
+    for (const auto &child : node.children)
+        depth = qMax(depth, depthOf(child));
+    return depth + 1;
+}
+} // namespace Widgets
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The FlameGraph shows the call tree of a profile as an icicle graph: the root is at the top,
+ * and the width of each frame is proportional to its samples.
+ * Clicking a frame zooms into it, and clicking the top frame zooms out to the root.
+ */
+
+#ifndef FLAMEGRAPH_HPP
+#define FLAMEGRAPH_HPP
+
+#include "Extensions/Profiler.hpp"
+#include <QWidget>
+
+namespace Widgets
+{
+class FlameGraph : public QWidget
+{
+    Q_OBJECT
+
+  public:
+    explicit FlameGraph(QWidget *parent = nullptr);
+
+    void setRoot(const Extensions::Profiler::FlameNode &node);
+
+  protected:
+    bool event(QEvent *event) override;
+
+    void paintEvent(QPaintEvent *event) override;
+
+    void mousePressEvent(QMouseEvent *event) override;
+
+  private:
+    struct Frame
+    {
+        QRectF rect;
+        const Extensions::Profiler::FlameNode *node;
+    };
+
+    /**
+     * @brief compute the rectangles of a node and its children
+     */
+    void layoutNode(const Extensions::Profiler::FlameNode *node, qreal x, qreal width, int depth);
+
+    /**
+     * @brief the frame at a position, nullptr if there is none
+     */
+    const Frame *frameAt(const QPoint &pos) const;
+
+    static int depthOf(const Extensions::Profiler::FlameNode &node);
+
+    Extensions::Profiler::FlameNode root;
+    const Extensions::Profiler::FlameNode *zoomed = nullptr; // the node shown at the top, points into root
+    QVector<Frame> frames;                                   // the frames computed in the last paint
+};
+} // namespace Widgets
+
+#endif // FLAMEGRAPH_HPP
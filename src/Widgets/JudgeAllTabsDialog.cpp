@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/JudgeAllTabsDialog.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/RunScheduler.hpp"
+#include "mainwindow.hpp"
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QJsonArray>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QThread>
+#include <QVBoxLayout>
+
+namespace Widgets
+{
+
+JudgeAllTabsDialog::JudgeAllTabsDialog(QWidget *parent) : QDialog(parent)
+{
+    setWindowTitle(tr("Compile And Run All Tabs"));
+    resize(720, 360);
+
+    auto *mainLayout = new QVBoxLayout(this);
+
+    auto *statusLayout = new QHBoxLayout();
+    mainLayout->addLayout(statusLayout);
+    statusLabel = new QLabel();
+    statusLabel->setWordWrap(true);
+    statusLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+    statusLayout->addWidget(statusLabel);
+    stopButton = new QPushButton(tr("Stop"));
+    stopButton->setEnabled(false);
+    connect(stopButton, &QPushButton::clicked, this, &JudgeAllTabsDialog::stop);
+    statusLayout->addWidget(stopButton);
+
+    table = new QTableWidget(0, 5);
+    table->setHorizontalHeaderLabels({tr("Tab"), tr("Status"), tr("Verdicts"), tr("Passed"), tr("Max Time")});
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    table->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Stretch);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->verticalHeader()->hide();
+    mainLayout->addWidget(table);
+}
+
+void JudgeAllTabsDialog::start(const QList<MainWindow *> &windows)
+{
+    LOG_INFO(INFO_OF(windows.length()));
+
+    stop();
+
+    tabs.clear();
+    compiling = 0;
+    table->setRowCount(windows.length());
+
+    for (auto *window : windows)
+    {
+        tabs.push_back({window, window->getTabTitle(false, false), Waiting});
+        connect(window, &MainWindow::compilationEnded, this, &JudgeAllTabsDialog::onCompilationEnded);
+        connect(window, &MainWindow::testCaseJudged, this, &JudgeAllTabsDialog::onTestCaseJudged);
+        connect(window, &MainWindow::judgingFinished, this, &JudgeAllTabsDialog::onJudgingFinished);
+        connect(window, &QObject::destroyed, this, &JudgeAllTabsDialog::onWindowDestroyed);
+    }
+
+    for (int i = 0; i < tabs.length(); ++i)
+        updateRow(i);
+
+    compileNext();
+    updateStatus();
+}
+
+void JudgeAllTabsDialog::onCompilationEnded(MainWindow *window, bool succeeded)
+{
+    int row = rowOf(window);
+    if (row == -1 || tabs[row].status != Compiling)
+        return;
+
+    --compiling;
+
+    if (succeeded)
+    {
+        tabs[row].status = Running;
+        // joined before the test cases are queued, so the first runs are limited too
+        Core::RunScheduler::instance()->join(window);
+    }
+    else
+    {
+        tabs[row].status = CompilationFailed;
+        release(tabs[row]);
+    }
+
+    updateRow(row);
+    compileNext();
+    updateStatus();
+}
+
+void JudgeAllTabsDialog::onTestCaseJudged(MainWindow *window)
+{
+    int row = rowOf(window);
+    if (row != -1 && tabs[row].status == Running)
+        updateRow(row);
+}
+
+void JudgeAllTabsDialog::onJudgingFinished(MainWindow *window)
+{
+    int row = rowOf(window);
+    if (row == -1 || tabs[row].status != Running)
+        return;
+
+    tabs[row].status = Finished;
+    release(tabs[row]);
+    updateRow(row);
+    updateStatus();
+}
+
+void JudgeAllTabsDialog::onWindowDestroyed()
+{
+    for (int i = 0; i < tabs.length(); ++i)
+    {
+        if (tabs[i].window.isNull() && (tabs[i].status == Waiting || tabs[i].status == Compiling ||
+                                        tabs[i].status == Running))
+        {
+            if (tabs[i].status == Compiling)
+                --compiling;
+            tabs[i].status = Closed;
+            updateRow(i);
+        }
+    }
+
+    compileNext();
+    updateStatus();
+}
+
+void JudgeAllTabsDialog::stop()
+{
+    for (int i = 0; i < tabs.length(); ++i)
+    {
+        auto &tab = tabs[i];
+        if (tab.status != Waiting && tab.status != Compiling && tab.status != Running)
+            continue;
+        bool started = tab.status != Waiting;
+        tab.status = Stopped;
+        if (started && !tab.window.isNull())
+            tab.window->killProcesses();
+        release(tab);
+        updateRow(i);
+    }
+    compiling = 0;
+    updateStatus();
+}
+
+void JudgeAllTabsDialog::compileNext()
+{
+    // the compilers are heavier than the solutions, so fewer compilations run together
+    int limit = qMax(1, QThread::idealThreadCount() / 2);
+
+    for (int i = 0; i < tabs.length() && compiling < limit; ++i)
+    {
+        if (tabs[i].status != Waiting || tabs[i].window.isNull())
+            continue;
+        tabs[i].status = Compiling;
+        ++compiling;
+        updateRow(i);
+        // this may finish the compilation immediately, e.g. for Python, and start the next compilations
+        tabs[i].window->compileAndRun();
+    }
+}
+
+int JudgeAllTabsDialog::rowOf(MainWindow *window) const
+{
+    for (int i = 0; i < tabs.length(); ++i)
+    {
+        if (tabs[i].window == window)
+            return i;
+    }
+    return -1;
+}
+
+void JudgeAllTabsDialog::release(Tab &tab)
+{
+    if (tab.window.isNull())
+        return;
+    tab.window->disconnect(this);
+    Core::RunScheduler::instance()->leave(tab.window);
+}
+
+void JudgeAllTabsDialog::updateRow(int row)
+{
+    // in the order of Status
+    const QStringList statusNames = {tr("Waiting"),            tr("Compiling"), tr("Running"), tr("Finished"),
+                                     tr("Compilation failed"), tr("Stopped"),   tr("Closed")};
+
+    auto const &tab = tabs[row];
+
+    QStringList verdicts;
+    int passed = 0;
+    int judged = 0;
+    qint64 maxTime = -1;
+    if (!tab.window.isNull() && tab.status != Waiting && tab.status != Compiling && tab.status != CompilationFailed)
+    {
+        for (auto const &value : tab.window->testCaseResults())
+        {
+            auto result = value.toObject();
+            if (!result.contains("timeUsed") && result["verdict"].isNull())
+                continue; // not run, e.g. unchecked or still waiting
+            auto verdict = result["verdict"].isNull() ? QString("-") : result["verdict"].toString();
+            verdicts.push_back(QString("#%1 %2").arg(result["index"].toInt() + 1).arg(verdict));
+            ++judged;
+            if (verdict == "AC")
+                ++passed;
+            if (result.contains("timeUsed"))
+                maxTime = qMax(maxTime, qint64(result["timeUsed"].toDouble()));
+        }
+    }
+
+    auto setText = [this, row](int column, const QString &text) {
+        auto *item = table->item(row, column);
+        if (item == nullptr)
+        {
+            item = new QTableWidgetItem();
+            table->setItem(row, column, item);
+        }
+        item->setText(text);
+    };
+
+    setText(0, tab.title);
+    setText(1, statusNames[tab.status]);
+    setText(2, verdicts.join("  "));
+    setText(3, judged == 0 ? QString() : QString("%1/%2").arg(passed).arg(judged));
+    setText(4, maxTime == -1 ? QString() : tr("%1ms").arg(maxTime));
+}
+
+void JudgeAllTabsDialog::updateStatus()
+{
+    int unfinished = 0;
+    int failed = 0;
+    for (auto const &tab : tabs)
+    {
+        if (tab.status == Waiting || tab.status == Compiling || tab.status == Running)
+            ++unfinished;
+        else if (tab.status == CompilationFailed)
+            ++failed;
+    }
+
+    stopButton->setEnabled(unfinished > 0);
+
+    if (unfinished > 0)
+        statusLabel->setText(tr("Judging %1 of %2 tabs...").arg(unfinished).arg(tabs.length()));
+    else if (failed > 0)
+        statusLabel->setText(tr("Finished, %1 tabs failed to compile").arg(failed));
+    else
+        statusLabel->setText(tr("Finished"));
+}
+
+} // namespace Widgets
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The JudgeAllTabsDialog compiles and runs the given tabs together, e.g. all problems of a contest.
+ * The tabs are compiled concurrently with a limited number of jobs, and their test cases are run with the cores
+ * shared by Core::RunScheduler. It shows the verdicts and the maximum time used of each tab in a grid.
+ * The results are also shown in the tabs as usual.
+ */
+
+#ifndef JUDGEALLTABSDIALOG_HPP
+#define JUDGEALLTABSDIALOG_HPP
+
+#include <QDialog>
+#include <QPointer>
+
+class MainWindow;
+class QLabel;
+class QPushButton;
+class QTableWidget;
+
+namespace Widgets
+{
+class JudgeAllTabsDialog : public QDialog
+{
+    Q_OBJECT
+
+  public:
+    explicit JudgeAllTabsDialog(QWidget *parent = nullptr);
+
+    /**
+     * @brief compile and run the tabs, the tabs of the last judging which are not finished are stopped
+     */
+    void start(const QList<MainWindow *> &windows);
+
+  private slots:
+    void onCompilationEnded(MainWindow *window, bool succeeded);
+
+    void onTestCaseJudged(MainWindow *window);
+
+    void onJudgingFinished(MainWindow *window);
+
+    /**
+     * @brief some tabs are closed, they are removed from the judging
+     */
+    void onWindowDestroyed();
+
+    /**
+     * @brief kill the compilations and the runs of the tabs which are not finished
+     */
+    void stop();
+
+  private:
+    enum Status
+    {
+        Waiting,
+        Compiling,
+        Running,
+        Finished,
+        CompilationFailed,
+        Stopped,
+        Closed
+    };
+
+    struct Tab
+    {
+        QPointer<MainWindow> window;
+        QString title;
+        Status status = Waiting;
+    };
+
+    /**
+     * @brief start compiling the waiting tabs until the job limit is reached
+     */
+    void compileNext();
+
+    /**
+     * @brief the row of a tab, -1 if it's not in the judging
+     */
+    int rowOf(MainWindow *window) const;
+
+    /**
+     * @brief stop watching the tab, and stop sharing the cores with it
+     */
+    void release(Tab &tab);
+
+    void updateRow(int row);
+
+    void updateStatus();
+
+    QVector<Tab> tabs;
+    int compiling = 0; // the number of tabs being compiled
+    QLabel *statusLabel = nullptr;
+    QPushButton *stopButton = nullptr;
+    QTableWidget *table = nullptr;
+};
+} // namespace Widgets
+
+#endif // JUDGEALLTABSDIALOG_HPP
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/ProfilerDialog.hpp"
+#include "Widgets/FlameGraph.hpp"
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QScrollArea>
+#include <QTabWidget>
+#include <QTableWidget>
+
+namespace Widgets
+{
+ProfilerDialog::ProfilerDialog(QWidget *parent) : QMainWindow(parent)
+{
+    setWindowTitle(tr("Profiler"));
+    resize(960, 540);
+
+    tabWidget = new QTabWidget(this);
+    setCentralWidget(tabWidget);
+
+    auto *scrollArea = new QScrollArea(tabWidget);
+    scrollArea->setWidgetResizable(true);
+    flameGraph = new FlameGraph(scrollArea);
+    scrollArea->setWidget(flameGraph);
+    tabWidget->addTab(scrollArea, tr("Flame Graph"));
+
+    hotLinesTable = new QTableWidget(0, 3, tabWidget);
+    hotLinesTable->setHorizontalHeaderLabels({tr("Samples"), tr("File"), tr("Line")});
+    hotLinesTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    hotLinesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    hotLinesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    hotLinesTable->verticalHeader()->hide();
+    tabWidget->addTab(hotLinesTable, tr("Hottest Lines"));
+
+    connect(hotLinesTable, &QTableWidget::cellDoubleClicked, this, [this](int row) {
+        if (row >= 0 && row < hotLines.size() && hotLines[row].inSource)
+            emit requestGoToLine(hotLines[row].line);
+    });
+}
+
+void ProfilerDialog::setResult(const Extensions::Profiler::Result &result, const QString &title)
+{
+    setWindowTitle(tr("Profiler - %1").arg(title));
+
+    flameGraph->setRoot(result.root);
+
+    hotLines = result.hotLines;
+    hotLinesTable->setRowCount(hotLines.size());
+    for (int i = 0; i < hotLines.size(); ++i)
+    {
+        const auto &hotLine = hotLines[i];
+        // the lines in headers can't be opened, only the name is shown for them
+        auto file = hotLine.inSource ? tr("<the source file>") : QFileInfo(hotLine.file).fileName();
+        hotLinesTable->setItem(i, 0, new QTableWidgetItem(QString("%1%").arg(hotLine.percent, 0, 'f', 2)));
+        auto *fileItem = new QTableWidgetItem(file);
+        fileItem->setToolTip(hotLine.file);
+        hotLinesTable->setItem(i, 1, fileItem);
+        hotLinesTable->setItem(i, 2, new QTableWidgetItem(QString::number(hotLine.line)));
+    }
+    hotLinesTable->setToolTip(tr("Double click a line in the source file to go to it"));
+}
+} // namespace Widgets
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#ifndef PROFILERDIALOG_HPP
+#define PROFILERDIALOG_HPP
+
+#include "Extensions/Profiler.hpp"
+#include <QMainWindow>
+
+class QTableWidget;
+class QTabWidget;
+
+namespace Widgets
+{
+class FlameGraph;
+
+class ProfilerDialog : public QMainWindow
+{
+    Q_OBJECT
+
+  public:
+    explicit ProfilerDialog(QWidget *parent = nullptr);
+    void setResult(const Extensions::Profiler::Result &result, const QString &title);
+
+  signals:
+    void requestGoToLine(int line);
+
+  private:
+    QTabWidget *tabWidget = nullptr;
+    FlameGraph *flameGraph = nullptr;
+    QTableWidget *hotLinesTable = nullptr;
+    QVector<Extensions::Profiler::HotLine> hotLines;
+};
+} // namespace Widgets
+#endif // PROFILERDIALOG_HPP
@@ -18,6 +18,7 @@
 #include "Widgets/TestCase.hpp"
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Util/FileUtil.hpp"
 #include "Util/Util.hpp"
 #include "Widgets/DiffViewer.hpp"
 #include "Widgets/TestCaseEdit.hpp"
@@ -52,6 +53,7 @@ TestCase::TestCase(int index, MessageLogger *logger, QWidget *parent, const QStr
     inputLabel = new QLabel(tr("Input"), this);
     outputLabel = new QLabel(tr("Output"), this);
     expectedLabel = new QLabel(tr("Expected"), this);
+    runStatsLabel = new QLabel(this);
     runButton = new QPushButton(tr("Run"), this);
     diffButton = new QPushButton("**", this);
     delButton = new QPushButton(tr("Del"), this);
@@ -70,6 +72,7 @@ TestCase::TestCase(int index, MessageLogger *logger, QWidget *parent, const QStr
     inputUpLayout->addWidget(inputLabel);
     inputUpLayout->addWidget(runButton);
     outputUpLayout->addWidget(outputLabel);
+    outputUpLayout->addWidget(runStatsLabel);
     outputUpLayout->addWidget(diffButton);
     expectedUpLayout->addWidget(expectedLabel);
     expectedUpLayout->addWidget(delButton);
@@ -90,7 +93,17 @@ TestCase::TestCase(int index, MessageLogger *logger, QWidget *parent, const QStr
 
     splitter->setChildrenCollapsible(false);
 
+#ifdef Q_OS_LINUX
+    runButton->setToolTip(tr("Test on a single testcase, right click to profile it"));
+    runButton->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(runButton, &QPushButton::customContextMenuRequested, this, [this](const QPoint &pos) {
+        QMenu menu;
+        menu.addAction(tr("Profile this test"), [this] { emit requestProfile(id); });
+        menu.exec(runButton->mapToGlobal(pos));
+    });
+#else
     runButton->setToolTip(tr("Test on a single testcase"));
+#endif
     diffButton->setToolTip(tr("Open the Diff Viewer"));
 
     connect(checkBox, &QCheckBox::toggled, this, &TestCase::onCheckBoxToggled);
@@ -107,13 +120,14 @@ void TestCase::setInput(const QString &text)
     inputEdit->modifyText(text);
 }
 
-void TestCase::setOutput(const QString &text)
+void TestCase::setOutput(const QString &text, const QString &wholeOutputPath)
 {
+    this->wholeOutputPath = wholeOutputPath;
     outputEdit->modifyText(text);
     outputEdit->startAnimation();
 
     if (!diffViewer->isHidden())
-        diffViewer->setText(text, expected());
+        diffViewer->setText(output(), expected());
 }
 
 void TestCase::setExpected(const QString &text)
@@ -123,7 +137,10 @@ void TestCase::setExpected(const QString &text)
 
 void TestCase::clearOutput()
 {
+    wholeOutputPath.clear();
     outputEdit->modifyText(QString());
+    runStatsLabel->clear();
+    runStatsLabel->setToolTip(QString());
     currentVerdict = UNKNOWN;
     diffButton->setStyleSheet("");
     diffButton->setText("**");
@@ -136,6 +153,13 @@ QString TestCase::input() const
 
 QString TestCase::output() const
 {
+    // the beginning of a long output is shown, and the whole output is only loaded when it's needed
+    if (!wholeOutputPath.isEmpty())
+    {
+        auto whole = Util::readFile(wholeOutputPath, tr("Output"), log);
+        if (!whole.isNull())
+            return whole;
+    }
     return outputEdit->getText();
 }
 
@@ -158,6 +182,12 @@ void TestCase::setID(int index)
     expectedLabel->setText(tr("Expected #%1").arg(id + 1));
 }
 
+void TestCase::setRunStats(const QString &summary, const QString &details)
+{
+    runStatsLabel->setText(summary);
+    runStatsLabel->setToolTip(details);
+}
+
 void TestCase::setVerdict(Verdict verdict)
 {
     currentVerdict = verdict;
@@ -186,6 +216,10 @@ void TestCase::setVerdict(Verdict verdict)
         diffButton->setStyleSheet("background: #b0b");
         diffButton->setText("RE");
         break;
+    case IE:
+        diffButton->setStyleSheet("background: #d70");
+        diffButton->setText("IE");
+        break;
     default:
         Q_UNREACHABLE();
         break;
@@ -45,13 +45,14 @@ class TestCase : public QWidget
         WA,  // Wrong answer
         TLE, // Time Limit Exceeded
         RE,  // Runtime Error
+        IE,  // Input Exhausted, the program is waiting for more input than provided
         UNKNOWN
     };
 
     explicit TestCase(int index, MessageLogger *logger, QWidget *parent = nullptr, const QString &in = QString(),
                       const QString &exp = QString());
     void setInput(const QString &text);
-    void setOutput(const QString &text);
+    void setOutput(const QString &text, const QString &wholeOutputPath = QString());
     void setExpected(const QString &text);
     void clearOutput();
     QString input() const;
@@ -61,6 +62,7 @@ class TestCase : public QWidget
     void setID(int index);
     void setVerdict(Verdict verdict);
     Verdict verdict() const;
+    void setRunStats(const QString &summary, const QString &details);
     void setChecked(bool checked);
     bool isChecked() const;
     void setTestCaseEditFont(const QFont &font);
@@ -71,6 +73,7 @@ class TestCase : public QWidget
   signals:
     void deleted(TestCase *widget);
     void requestRun(int index);
+    void requestProfile(int index);
 
   private slots:
     void onCheckBoxToggled(bool checked);
@@ -86,11 +89,13 @@ class TestCase : public QWidget
     QVBoxLayout *inputLayout = nullptr, *outputLayout = nullptr, *expectedLayout = nullptr;
     QCheckBox *checkBox = nullptr;
     QLabel *inputLabel = nullptr, *outputLabel = nullptr, *expectedLabel = nullptr;
+    QLabel *runStatsLabel = nullptr; // the performance counters of the last run, shown next to the output label
     QPushButton *runButton = nullptr, *diffButton = nullptr, *delButton = nullptr;
     TestCaseEdit *inputEdit = nullptr, *outputEdit = nullptr, *expectedEdit = nullptr;
     DiffViewer *diffViewer = nullptr;
     MessageLogger *log;
     Verdict currentVerdict = UNKNOWN;
+    QString wholeOutputPath; // the file with the whole output, empty if the whole output is in outputEdit
     int id;
 };
 } // namespace Widgets
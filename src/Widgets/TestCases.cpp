@@ -271,10 +271,10 @@ void TestCases::setInput(int index, const QString &input)
         testcases[index]->setInput(input);
 }
 
-void TestCases::setOutput(int index, const QString &output)
+void TestCases::setOutput(int index, const QString &output, const QString &wholeOutputPath)
 {
     if (VALIDATE_INDEX(index))
-        testcases[index]->setOutput(output);
+        testcases[index]->setOutput(output, wholeOutputPath);
 }
 
 void TestCases::setExpected(int index, const QString &expected)
@@ -297,6 +297,7 @@ void TestCases::addTestCase(const QString &input, const QString &expected)
         auto *testcase = new TestCase(count(), log, this, input, expected);
         connect(testcase, &TestCase::deleted, this, &TestCases::onChildDeleted);
         connect(testcase, &TestCase::requestRun, this, &TestCases::requestRun);
+        connect(testcase, &TestCase::requestProfile, this, &TestCases::requestProfile);
         testcases.push_back(testcase);
         scrollAreaLayout->addWidget(testcase);
         updateVerdicts();
@@ -331,6 +332,11 @@ QString TestCases::expected(int index) const
     return VALIDATE_INDEX(index) ? testcases[index]->expected() : QString();
 }
 
+TestCase::Verdict TestCases::verdict(int index) const
+{
+    return VALIDATE_INDEX(index) ? testcases[index]->verdict() : TestCase::UNKNOWN;
+}
+
 void TestCases::loadStatus(const QStringList &inputList, const QStringList &expectedList)
 {
     clear();
@@ -527,6 +533,12 @@ void TestCases::setVerdict(int index, TestCase::Verdict verdict)
     }
 }
 
+void TestCases::setRunStats(int index, const QString &summary, const QString &details)
+{
+    if (VALIDATE_INDEX(index))
+        testcases[index]->setRunStats(summary, details);
+}
+
 void TestCases::on_addButton_clicked()
 {
     addTestCase();
@@ -577,6 +589,7 @@ void TestCases::updateVerdicts()
         case TestCase::WA:
         case TestCase::TLE:
         case TestCase::RE:
+        case TestCase::IE:
             ++unaccepted;
             break;
         case TestCase::UNKNOWN:
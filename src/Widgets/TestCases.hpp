@@ -46,7 +46,7 @@ class TestCases : public QWidget
     QString expected(int index) const;
 
     void setInput(int index, const QString &input);
-    void setOutput(int index, const QString &output);
+    void setOutput(int index, const QString &output, const QString &wholeOutputPath = QString());
     void setExpected(int index, const QString &expected);
 
     void loadStatus(const QStringList &inputList, const QStringList &expectedList);
@@ -72,6 +72,8 @@ class TestCases : public QWidget
     void setChecked(int index, bool checked);
     bool isChecked(int index) const;
 
+    TestCase::Verdict verdict(int index) const;
+
     void loadFromSavedFiles(const QString &filePath);
     void saveToFiles(const QString &filePath, bool safe);
 
@@ -84,12 +86,23 @@ class TestCases : public QWidget
     QVariantList splitterStates() const;
     void restoreSplitterStates(const QVariantList &states);
 
+    /**
+     * @brief the paths where the test cases of a source file are saved, by "Input/Answer File Save Path"
+     * @note these are also used by the headless judge, which doesn't create the widget
+     */
+    static QString inputFilePath(const QString &filePath, int index);
+    static QString answerFilePath(const QString &filePath, int index);
+
+    static const int MAX_NUMBER_OF_TESTCASES = 100;
+
   public slots:
     void setVerdict(int index, TestCase::Verdict verdict);
+    void setRunStats(int index, const QString &summary, const QString &details);
 
   signals:
     void checkerChanged();
     void requestRun(int index);
+    void requestProfile(int index);
 
   private slots:
     void on_addButton_clicked();
@@ -99,11 +112,8 @@ class TestCases : public QWidget
   private:
     bool validateIndex(int index, const QString &funcName) const;
     void updateVerdicts();
-    static QString inputFilePath(const QString &filePath, int index);
-    static QString answerFilePath(const QString &filePath, int index);
     static QString testCaseFilePath(QString rule, const QString &filePath, int index);
 
-    static const int MAX_NUMBER_OF_TESTCASES = 100;
     QVBoxLayout *mainLayout = nullptr, *scrollAreaLayout = nullptr;
     QHBoxLayout *titleLayout = nullptr, *checkerLayout = nullptr;
     QPushButton *addButton = nullptr, *moreButton = nullptr, *addCheckerButton = nullptr;
@@ -26,13 +26,18 @@
 #include "Extensions/CFTool.hpp"
 #include "Extensions/CompanionServer.hpp"
 #include "Extensions/EditorTheme.hpp"
+#include "Extensions/JavaRunServer.hpp"
+#include "Extensions/JudgeCalibration.hpp"
 #include "Extensions/LanguageServer.hpp"
+#include "Extensions/LocalApi.hpp"
+#include "Extensions/ToolchainProbe.hpp"
 #include "Settings/DefaultPathManager.hpp"
 #include "Settings/FileProblemBinder.hpp"
 #include "Settings/PreferencesWindow.hpp"
 #include "Telemetry/UpdateChecker.hpp"
 #include "Util/FileUtil.hpp"
 #include "Util/Util.hpp"
+#include "Widgets/JudgeAllTabsDialog.hpp"
 #include "Widgets/SupportUsDialog.hpp"
 #include "application.hpp"
 #include "generated/SettingsHelper.hpp"
@@ -67,6 +72,14 @@ AppWindow::AppWindow(bool noHotExit, QWidget *parent) : QMainWindow(parent), ui(
     ui->actionSwapLineDown->setShortcut({"Ctrl+Meta+Down"});
 #endif
 
+#ifndef Q_OS_LINUX
+    // perf_event_open is only available on Linux
+    ui->actionRunWithCounters->setVisible(false);
+    // the heap profiler preloads a shared library by LD_PRELOAD
+    ui->actionRunWithHeapProfile->setVisible(false);
+    ui->actionExportHeapProfile->setVisible(false);
+#endif
+
     auto *separator = ui->menuFile->insertSeparator(ui->actionSave); // used to insert openRecentFilesMenu
     auto *openRecentFilesMenu = new QMenu(tr("Open Recent Files"), ui->menuFile);
     ui->menuFile->insertMenu(separator, openRecentFilesMenu);
@@ -276,6 +289,7 @@ void AppWindow::setConnections()
     connect(preferencesWindow, &PreferencesWindow::settingsApplied, this, &AppWindow::onSettingsApplied);
 
     connect(server, &Extensions::CompanionServer::onRequestArrived, this, &AppWindow::onIncomingCompanionRequest);
+    connect(server, &Extensions::CompanionServer::apiRequestArrived, localApi, &Extensions::LocalApi::handleRequest);
 
     connect(trayIcon, &QSystemTrayIcon::activated, this, &AppWindow::onTrayIconActivated);
     connect(trayIcon, &QSystemTrayIcon::messageClicked, this, &AppWindow::showOnTop);
@@ -293,6 +307,7 @@ void AppWindow::allocate()
     preferencesWindow = new PreferencesWindow(this);
 
     server = new Extensions::CompanionServer(SettingsHelper::getCompetitiveCompanionConnectionPort());
+    localApi = new Extensions::LocalApi(this);
 
     cppServer = new Extensions::LanguageServer("C++");
     javaServer = new Extensions::LanguageServer("Java");
@@ -423,6 +438,7 @@ void AppWindow::openTab(MainWindow *window)
     connect(window, &MainWindow::requestToastMessage, trayIcon,
             [this](QString const &head, QString const &body) { trayIcon->showMessage(head, body); });
     connect(window, &MainWindow::compileOrRunTriggered, this, &AppWindow::onCompileOrRunTriggered);
+    localApi->watch(window);
 
     ui->tabWidget->setCurrentIndex(ui->tabWidget->addTab(window, window->getTabTitle(false, true)));
 
@@ -854,13 +870,6 @@ void AppWindow::onTabChanged(int index)
         findReplaceDialog->setTextEdit(nullptr);
         setWindowTitle(tr("CP Editor: An editor specially designed for competitive programming"));
 
-        if (cppServer->isDocumentOpen())
-            cppServer->closeDocument();
-        if (pythonServer->isDocumentOpen())
-            pythonServer->closeDocument();
-        if (javaServer->isDocumentOpen())
-            javaServer->closeDocument();
-
         return;
     }
 
@@ -959,21 +968,19 @@ void AppWindow::onEditorTextChanged(MainWindow *window)
 
 void AppWindow::updateLanguageServerFilePath(MainWindow *window, const QString &path)
 {
-    if (currentWindow() == window)
-    {
-        if (window->getLanguage() == "C++" && cppServer->isDocumentOpen())
-            cppServer->updatePath(path);
-        else if (window->getLanguage() == "Java" && javaServer->isDocumentOpen())
-            javaServer->updatePath(path);
-        else if (window->getLanguage() == "Python" && pythonServer->isDocumentOpen())
-            pythonServer->updatePath(path);
-    }
+    // the documents of the background tabs are open as well
+    cppServer->updatePath(window->getEditor(), path);
+    javaServer->updatePath(window->getEditor(), path);
+    pythonServer->updatePath(window->getEditor(), path);
 }
 
 void AppWindow::onEditorLanguageChanged(MainWindow *window)
 {
     if (currentWindow() == window)
+    {
+        window->getEditor()->clearSquiggle();
         reAttachLanguageServer(window);
+    }
 }
 
 void AppWindow::onLSPTimerElapsedCpp()
@@ -983,7 +990,7 @@ void AppWindow::onLSPTimerElapsedCpp()
         return;
 
     if (SettingsHelper::isLSPUseLintingCpp() && tab->getLanguage() == "C++")
-        cppServer->requestLinting();
+        cppServer->requestLinting(tab->getEditor());
 
     lspTimerCpp->stop();
 }
@@ -995,7 +1002,7 @@ void AppWindow::onLSPTimerElapsedJava()
         return;
 
     if (SettingsHelper::isLSPUseLintingJava() && tab->getLanguage() == "Java")
-        javaServer->requestLinting();
+        javaServer->requestLinting(tab->getEditor());
 
     lspTimerJava->stop();
 }
@@ -1007,7 +1014,7 @@ void AppWindow::onLSPTimerElapsedPython()
         return;
 
     if (SettingsHelper::isLSPUseLintingPython() && tab->getLanguage() == "Python")
-        pythonServer->requestLinting();
+        pythonServer->requestLinting(tab->getEditor());
 
     lspTimerPython->stop();
 }
@@ -1039,6 +1046,15 @@ void AppWindow::onSettingsApplied(const QString &pagePath)
             server->updatePort(0);
     }
 
+    if (pageChanged("Extensions/Java Run Server"))
+    {
+        if (SettingsHelper::isJavaRunServerCompile())
+            Extensions::JavaRunServer::instance()->start(SettingsHelper::getJavaCompileCommand(),
+                                                         SettingsHelper::getJavaRunCommand());
+        else if (!SettingsHelper::isJavaRunServerEnable())
+            Extensions::JavaRunServer::instance()->stop();
+    }
+
     if (pageChanged("Appearance/General"))
     {
         setWindowOpacity(SettingsHelper::getOpacity() / 100.0);
@@ -1208,6 +1224,28 @@ void AppWindow::on_actionRun_triggered()
         currentWindow()->runOnly();
 }
 
+void AppWindow::on_actionCompileRunWithoutCache_triggered()
+{
+    if (currentWindow() != nullptr)
+        currentWindow()->compileAndRunWithoutCache();
+}
+
+void AppWindow::on_actionCompileRunAllTabs_triggered()
+{
+    QList<MainWindow *> windows;
+    for (int i = 0; i < ui->tabWidget->count(); ++i)
+        windows.push_back(windowAt(i));
+
+    if (windows.isEmpty())
+        return;
+
+    if (judgeAllTabsDialog == nullptr)
+        judgeAllTabsDialog = new Widgets::JudgeAllTabsDialog(this);
+    judgeAllTabsDialog->show();
+    judgeAllTabsDialog->raise();
+    judgeAllTabsDialog->start(windows);
+}
+
 void AppWindow::on_actionFindReplace_triggered()
 {
     auto *tmp = currentWindow();
@@ -1231,6 +1269,167 @@ void AppWindow::on_actionRunDetached_triggered()
     }
 }
 
+void AppWindow::on_actionRunWithCounters_triggered()
+{
+    if (currentWindow() != nullptr)
+        currentWindow()->compileAndRunWithCounters();
+}
+
+void AppWindow::on_actionRunWithHeapProfile_triggered()
+{
+    if (currentWindow() != nullptr)
+        currentWindow()->compileAndRunWithHeapProfile();
+}
+
+void AppWindow::on_actionExportHeapProfile_triggered()
+{
+    if (currentWindow() != nullptr)
+        currentWindow()->exportHeapProfile();
+}
+
+void AppWindow::on_actionEstimateComplexity_triggered()
+{
+    if (currentWindow() != nullptr)
+        currentWindow()->estimateComplexity();
+}
+
+void AppWindow::on_actionProfileCompilation_triggered()
+{
+    if (currentWindow() != nullptr)
+        currentWindow()->profileCompilation();
+}
+
+void AppWindow::on_actionCalibrateJudgeSpeed_triggered()
+{
+    LOG_INFO("Calibrating the judge speed");
+
+    auto *calibration = new Extensions::JudgeCalibration(this);
+
+    auto *progressDialog = new QProgressDialog(tr("Running the calibration benchmark..."), tr("Cancel"), 0, 0, this);
+    progressDialog->setWindowTitle(tr("Calibrate Judge Speed"));
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
+    progressDialog->setMinimumDuration(0);
+    connect(progressDialog, &QProgressDialog::canceled, this, [calibration, progressDialog] {
+        calibration->deleteLater();
+        progressDialog->deleteLater();
+    });
+
+    connect(calibration, &Extensions::JudgeCalibration::progress, progressDialog,
+            [progressDialog](int finished, int total) {
+                progressDialog->setMaximum(total);
+                progressDialog->setValue(finished);
+            });
+
+    connect(calibration, &Extensions::JudgeCalibration::finished, this,
+            [this, calibration, progressDialog](const Extensions::JudgeCalibration::Result &result) {
+                calibration->deleteLater();
+                progressDialog->deleteLater();
+
+                SettingsHelper::setJudgeSpeedLocalScore(int(result.score));
+
+                QStringList details;
+                for (const auto &kernel : result.kernels)
+                    details.push_back(QString("%1: %2ms").arg(kernel.name).arg(kernel.time));
+
+                QMessageBox box(QMessageBox::Information, tr("Calibrate Judge Speed"),
+                                tr("The local score is %1ms.\n\n%2\n\nTo add a judge, run the benchmark on its custom "
+                                   "invocation, and add the total time at %3.")
+                                    .arg(result.score)
+                                    .arg(details.join('\n'))
+                                    .arg(SettingsHelper::pathOfJudgeSpeedJudges()),
+                                QMessageBox::Ok, this);
+                auto *copyButton = box.addButton(tr("Copy Benchmark Source"), QMessageBox::ActionRole);
+                box.exec();
+                if (box.clickedButton() == copyButton)
+                    QGuiApplication::clipboard()->setText(Extensions::JudgeCalibration::benchmarkSource());
+            });
+
+    connect(calibration, &Extensions::JudgeCalibration::failed, this,
+            [this, calibration, progressDialog](const QString &reason) {
+                calibration->deleteLater();
+                progressDialog->deleteLater();
+                QMessageBox::warning(this, tr("Calibrate Judge Speed"), reason);
+            });
+
+    calibration->start(SettingsHelper::getCppCompileCommand());
+}
+
+void AppWindow::on_actionFindFastestToolchain_triggered()
+{
+    LOG_INFO("Finding the fastest toolchain");
+
+    auto *probe = new Extensions::ToolchainProbe(this);
+
+    auto *progressDialog =
+        new QProgressDialog(tr("Compiling the reference program with each toolchain..."), tr("Cancel"), 0, 0, this);
+    progressDialog->setWindowTitle(tr("Find the Fastest Toolchain"));
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
+    progressDialog->setMinimumDuration(0);
+    connect(progressDialog, &QProgressDialog::canceled, this, [probe, progressDialog] {
+        probe->deleteLater();
+        progressDialog->deleteLater();
+    });
+
+    connect(probe, &Extensions::ToolchainProbe::progress, progressDialog, [progressDialog](int finished, int total) {
+        progressDialog->setMaximum(total);
+        progressDialog->setValue(finished);
+    });
+
+    connect(probe, &Extensions::ToolchainProbe::finished, this,
+            [this, probe, progressDialog](const Extensions::ToolchainProbe::Result &result) {
+                probe->deleteLater();
+                progressDialog->deleteLater();
+
+                auto currentCommand = SettingsHelper::getCppCompileCommand();
+                QStringList details;
+                for (const auto &candidate : result.candidates)
+                {
+                    auto name = candidate.compileCommand;
+                    if (name == currentCommand)
+                        name = tr("%1 (current)").arg(name);
+                    if (candidate.valid)
+                        details.push_back(tr("%1: %2ms").arg(name).arg(candidate.time));
+                    else
+                        details.push_back(tr("%1: %2").arg(name, candidate.error));
+                }
+
+                const auto &fastest = result.candidates.front();
+                // the difference within the noise of the measurement is not worth changing the command
+                bool faster = fastest.valid && fastest.compileCommand != currentCommand &&
+                              fastest.time * 10 < result.currentTime * 9;
+
+                QMessageBox box(QMessageBox::Information, tr("Find the Fastest Toolchain"),
+                                (faster ? tr("[%1] compiles the reference program in %2ms, and the current compile "
+                                             "command takes %3ms.")
+                                              .arg(fastest.compileCommand)
+                                              .arg(fastest.time)
+                                              .arg(result.currentTime)
+                                        : tr("The current compile command is the fastest one.")) +
+                                    "\n\n" + details.join('\n'),
+                                QMessageBox::Ok, this);
+                QAbstractButton *useButton = nullptr;
+                if (faster)
+                    useButton = box.addButton(tr("Use the Fastest"), QMessageBox::AcceptRole);
+                box.exec();
+                if (useButton != nullptr && box.clickedButton() == useButton)
+                {
+                    LOG_INFO("Using the fastest toolchain " << INFO_OF(fastest.compileCommand));
+                    SettingsHelper::setCppCompileCommand(fastest.compileCommand);
+                    onSettingsApplied("Language/C++/C++ Commands");
+                }
+            });
+
+    connect(probe, &Extensions::ToolchainProbe::failed, this, [this, probe, progressDialog](const QString &reason) {
+        probe->deleteLater();
+        progressDialog->deleteLater();
+        QMessageBox::warning(this, tr("Find the Fastest Toolchain"), reason);
+    });
+
+    probe->start(SettingsHelper::getCppCompileCommand());
+}
+
 void AppWindow::on_actionKillProcesses_triggered()
 {
     if (currentWindow() != nullptr)
@@ -1439,6 +1638,13 @@ void AppWindow::onTabContextMenuRequested(const QPoint &pos)
 
         tabMenu->addAction(tr("Set Time Limit"), [window] { window->updateTimeLimit(); });
 
+#ifdef Q_OS_LINUX
+        auto *stableTimingAction =
+            tabMenu->addAction(tr("Stable Timing"), [window](bool checked) { window->setStableTiming(checked); });
+        stableTimingAction->setCheckable(true);
+        stableTimingAction->setChecked(window->isStableTiming());
+#endif
+
         LOG_INFO(INFO_OF(filePath));
 
         const auto outputFilePath =
@@ -1512,34 +1718,36 @@ MainWindow *AppWindow::currentWindow()
 
 void AppWindow::reAttachLanguageServer(MainWindow *window)
 {
-    window->getEditor()->clearSquiggle();
     lspTimerCpp->stop();
     lspTimerJava->stop();
     lspTimerPython->stop();
 
-    if (cppServer->isDocumentOpen())
-        cppServer->closeDocument();
-    if (javaServer->isDocumentOpen())
-        javaServer->closeDocument();
-    if (pythonServer->isDocumentOpen())
-        pythonServer->closeDocument();
+    // The document of each tab is kept open in the server of its language, so switching tabs doesn't make the server
+    // parse it again. It's only closed in the other servers when the language of the tab is changed.
+
+    if (window->getLanguage() != "C++")
+        cppServer->closeDocument(window->getEditor());
+    if (window->getLanguage() != "Java")
+        javaServer->closeDocument(window->getEditor());
+    if (window->getLanguage() != "Python")
+        pythonServer->closeDocument(window->getEditor());
 
     if (window->getLanguage() == "C++")
     {
         cppServer->openDocument(window->filePathOrTmpPath(), window->getEditor(), window->getLogger());
-        cppServer->requestLinting();
+        cppServer->requestLinting(window->getEditor());
         lspTimerCpp->start();
     }
     else if (window->getLanguage() == "Java")
     {
         javaServer->openDocument(window->filePathOrTmpPath(), window->getEditor(), window->getLogger());
-        javaServer->requestLinting();
+        javaServer->requestLinting(window->getEditor());
         lspTimerJava->start();
     }
     else if (window->getLanguage() == "Python")
     {
         pythonServer->openDocument(window->filePathOrTmpPath(), window->getEditor(), window->getLogger());
-        pythonServer->requestLinting();
+        pythonServer->requestLinting(window->getEditor());
         lspTimerPython->start();
     }
 }
@@ -41,8 +41,14 @@ namespace Extensions
 class CompanionServer;
 struct CompanionData;
 class LanguageServer;
+class LocalApi;
 } // namespace Extensions
 
+namespace Widgets
+{
+class JudgeAllTabsDialog;
+}
+
 namespace Telemetry
 {
 class UpdateChecker;
@@ -133,12 +139,30 @@ class AppWindow : public QMainWindow
 
     void on_actionRun_triggered();
 
+    void on_actionCompileRunWithoutCache_triggered();
+
+    void on_actionCompileRunAllTabs_triggered();
+
     void on_actionFindReplace_triggered();
 
     void on_actionFormatCode_triggered();
 
     void on_actionRunDetached_triggered();
 
+    void on_actionRunWithCounters_triggered();
+
+    void on_actionRunWithHeapProfile_triggered();
+
+    void on_actionExportHeapProfile_triggered();
+
+    void on_actionEstimateComplexity_triggered();
+
+    void on_actionProfileCompilation_triggered();
+
+    void on_actionCalibrateJudgeSpeed_triggered();
+
+    void on_actionFindFastestToolchain_triggered();
+
     void on_actionKillProcesses_triggered();
 
     void on_actionUseSnippets_triggered();
@@ -226,7 +250,9 @@ class AppWindow : public QMainWindow
     Telemetry::UpdateChecker *updateChecker = nullptr;
     PreferencesWindow *preferencesWindow = nullptr;
     Extensions::CompanionServer *server = nullptr;
+    Extensions::LocalApi *localApi = nullptr;
     FindReplaceDialog *findReplaceDialog = nullptr;
+    Widgets::JudgeAllTabsDialog *judgeAllTabsDialog = nullptr;
     QSystemTrayIcon *trayIcon = nullptr;
     QMenu *trayIconMenu = nullptr;
     QMenu *tabMenu = nullptr;
@@ -259,6 +285,7 @@ class AppWindow : public QMainWindow
     MainWindow *windowAt(int index);
 
     friend class Core::SessionManager;
+    friend class Extensions::LocalApi;
 };
 
 #endif // APPWINDOW_HPP
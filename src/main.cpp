@@ -17,6 +17,8 @@
 
 #include "Core/EventLogger.hpp"
 #include "Core/Translator.hpp"
+#include "Extensions/JudgeService.hpp"
+#include "HeadlessJudge.hpp"
 #include "Settings/SettingsInfo.hpp"
 #include "SignalHandler.hpp"
 #include "Util/Util.hpp"
@@ -45,6 +47,13 @@
 
 int main(int argc, char *argv[])
 {
+    // the headless judge doesn't create any widget, so it must be checked before creating the QApplication
+    if (HeadlessJudge::isRequested(argc, argv))
+        return HeadlessJudge::exec(argc, argv);
+
+    if (Extensions::JudgeService::isServiceRequested(argc, argv))
+        return Extensions::JudgeService::execService(argc, argv);
+
     Application app(argc, argv);
     SingleApplication::setApplicationName("CP Editor");
     SingleApplication::setApplicationVersion(DISPLAY_VERSION);
@@ -124,7 +133,9 @@ int main(int argc, char *argv[])
     parser.addHelpOption();
     parser.setApplicationDescription(programName + " [-d/--depth <depth>] [options] [<path1> [<path2> [...]]]\n" +
                                      programName +
-                                     " [-c/--contest] [options] <number of problems> <contest directory>");
+                                     " [-c/--contest] [options] <number of problems> <contest directory>\n" +
+                                     programName + " --judge <file> [options], see " + programName +
+                                     " --judge <file> --help for more information.");
     parser.addOptions(
         {{{"d", "depth"}, "Maximum depth when opening files in directories. No limit if not specified.", "depth", "-1"},
          {{"c", "contest"}, "Open a contest. i.e. Open files named A, B, ..., Z in a given directory."},
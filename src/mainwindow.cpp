@@ -19,32 +19,56 @@
 
 #include "Core/Checker.hpp"
 #include "Core/Compiler.hpp"
+#include "Core/CompilerDiagnostics.hpp"
 #include "Core/EventLogger.hpp"
+#include "Core/IncrementalChecker.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Core/RunCache.hpp"
+#include "Core/RunScheduler.hpp"
 #include "Core/Runner.hpp"
+#include "Core/StableTiming.hpp"
 #include "Extensions/CFTool.hpp"
 #include "Extensions/ClangFormatter.hpp"
 #include "Extensions/CompanionServer.hpp"
+#include "Extensions/CompileProfiler.hpp"
+#include "Extensions/ComplexityEstimator.hpp"
+#include "Extensions/HeapProfiler.hpp"
+#include "Extensions/JavaRunServer.hpp"
+#include "Extensions/JudgeCalibration.hpp"
+#include "Extensions/Profiler.hpp"
+#include "Extensions/SanitizerBuild.hpp"
 #include "Extensions/YAPFormatter.hpp"
 #include "Settings/DefaultPathManager.hpp"
 #include "Settings/FileProblemBinder.hpp"
 #include "Settings/PreferencesWindow.hpp"
 #include "Util/FileUtil.hpp"
 #include "Util/QCodeEditorUtil.hpp"
+#include "Util/Util.hpp"
+#include "Widgets/CompileProfileDialog.hpp"
+#include "Widgets/ComplexityDialog.hpp"
+#include "Widgets/DiagnosticsView.hpp"
+#include "Widgets/ProfilerDialog.hpp"
 #include "Widgets/TestCases.hpp"
 #include "appwindow.hpp"
 #include "generated/SettingsHelper.hpp"
 #include "generated/version.hpp"
 #include <QCodeEditor>
 #include <QFileSystemWatcher>
+#include <QFutureWatcher>
 #include <QInputDialog>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QMessageBox>
 #include <QMimeData>
 #include <QRegularExpression>
 #include <QScrollBar>
 #include <QTemporaryDir>
 #include <QTextBlock>
+#include <QThread>
 #include <QTimer>
+#include <QtConcurrent>
+#include <cmath>
+#include <numeric>
 
 #include "../ui/ui_mainwindow.h"
 
@@ -64,10 +88,26 @@ MainWindow::MainWindow(int index, AppWindow *parent)
     log = new MessageLogger(appWindow->getPreferencesWindow(), this);
     ui->messageLoggerLayout->addWidget(log);
 
+    diagnosticsView = new Widgets::DiagnosticsView(this);
+    ui->messageLoggerLayout->addWidget(diagnosticsView);
+    connect(diagnosticsView, &Widgets::DiagnosticsView::requestGoToLine, this, [this](int line, int column) {
+        QTextCursor cursor(editor->document()->findBlockByNumber(line - 1));
+        if (column > 0)
+            cursor.setPosition(cursor.position() + qMin(column - 1, cursor.block().length() - 1));
+        editor->setTextCursor(cursor);
+        editor->setFocus();
+    });
+
     testcases = new Widgets::TestCases(log, this);
     ui->testCasesLayout->addWidget(testcases);
     connect(testcases, &Widgets::TestCases::checkerChanged, this, &MainWindow::updateChecker);
     connect(testcases, &Widgets::TestCases::requestRun, this, &MainWindow::runTestCase);
+    connect(testcases, &Widgets::TestCases::requestProfile, this, &MainWindow::profileTestCase);
+    connect(Core::RunScheduler::instance(), &Core::RunScheduler::sharesChanged, this, &MainWindow::runNextQueued);
+    connect(Extensions::HeapProfiler::instance(), &Extensions::HeapProfiler::prepared, this,
+            &MainWindow::onHeapProfilerPrepared);
+    connect(Extensions::HeapProfiler::instance(), &Extensions::HeapProfiler::reportRead, this,
+            &MainWindow::onHeapReportRead);
 
     setEditor();
     connect(fileWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::onFileWatcherChanged);
@@ -96,6 +136,7 @@ MainWindow::MainWindow(const EditorStatus &status, bool duplicate, int index, Ap
 MainWindow::~MainWindow()
 {
     killProcesses();
+    Core::RunScheduler::instance()->leave(this);
 
     delete cftool;
     delete tmpDir;
@@ -130,12 +171,18 @@ void MainWindow::compile()
         saveFile(IgnoreUntitled, tr("Compiler"), true);
 
     killProcesses();
+    diagnosticsView->clearDiagnostics();
+    ++diagnosticsParseId;
 
     compiler = new Core::Compiler();
 
     auto path = tmpPath();
+    compiledFilePath = path;
     if (path.isEmpty())
+    {
+        emit compilationEnded(this, false);
         return;
+    }
 
     if (language == "Python")
     {
@@ -146,6 +193,7 @@ void MainWindow::compile()
     if (language != "C++" && language != "Java")
     {
         log->warn(tr("Compiler"), tr("Please set the language"));
+        emit compilationEnded(this, false);
         return;
     }
 
@@ -155,6 +203,18 @@ void MainWindow::compile()
     connect(compiler, &Core::Compiler::compilationFailed, this, &MainWindow::onCompilationFailed);
     connect(compiler, &Core::Compiler::compilationKilled, this, &MainWindow::onCompilationKilled);
     compiler->start(path, filePath, compileCommand(), language);
+
+    // start the Java run server during the compilation, so it's probably ready when running
+    if (language == "Java" && afterCompile == Run && SettingsHelper::isJavaRunServerEnable())
+        Extensions::JavaRunServer::instance()->start(SettingsHelper::getJavaCompileCommand(),
+                                                     SettingsHelper::getJavaRunCommand());
+
+    // the sanitizer build is compiled in parallel with the normal build, and runs the test cases after them
+    if (language == "C++" && afterCompile == Run && SettingsHelper::isCppSanitizerBuild())
+    {
+        sanitizerBuild = new Extensions::SanitizerBuild(log, this);
+        sanitizerBuild->compile(QFileInfo(path).path(), editor->toPlainText(), filePath, compileCommand());
+    }
 }
 
 void MainWindow::run()
@@ -163,8 +223,15 @@ void MainWindow::run()
         saveFile(IgnoreUntitled, tr("Runner"), true);
 
     LOG_INFO("Requesting run of testcases");
+
+    // the sanitizer build of the last compilation is kept, so it can run the test cases after this run
+    auto *sanitizer = sanitizerBuild;
+    sanitizerBuild = nullptr;
     killProcesses();
+    sanitizerBuild = sanitizer;
+
     testcases->clearOutput();
+    runResults.clear();
 
     if (!QStringList({"C++", "Java", "Python"}).contains(language))
     {
@@ -173,18 +240,49 @@ void MainWindow::run()
     }
 
     checker->clearTasks();
+    countersWarningShown = false;
 
+    QString judge;
+    int scaledTimeLimit = Extensions::JudgeCalibration::scaledTimeLimit(problemTimeLimit(), problemURL, &judge);
+    if (!judge.isEmpty())
+    {
+        log->info(tr("Runner"), tr("The time limit is scaled from %1ms to %2ms by the speed of %3")
+                                    .arg(problemTimeLimit())
+                                    .arg(scaledTimeLimit)
+                                    .arg(judge));
+    }
+
+    QList<int> indices;
     for (int i = 0; i < testcases->count(); ++i)
     {
         if ((!testcases->input(i).trimmed().isEmpty() || SettingsHelper::isRunOnEmptyTestcase()) &&
             testcases->isChecked(i))
         {
-            run(i);
+            indices.push_back(i);
         }
     }
 
-    if (runner.empty())
+    if (SettingsHelper::isRunSmallestTestcasesFirst())
+    {
+        std::stable_sort(indices.begin(), indices.end(),
+                         [this](int a, int b) { return testcases->input(a).length() < testcases->input(b).length(); });
+    }
+
+    for (int index : indices)
+    {
+        runQueue.enqueue(index);
+        judgingTestCases.insert(index);
+        if (sanitizerBuild != nullptr)
+            sanitizerInputs[index] = testcases->input(index);
+    }
+
+    runNextQueued();
+
+    if (indices.isEmpty())
+    {
         log->warn(tr("Runner"), tr("All inputs are empty, nothing to run"));
+        emit judgingFinished(this);
+    }
 }
 
 void MainWindow::run(int index)
@@ -195,23 +293,175 @@ void MainWindow::run(int index)
         return;
     }
 
+    auto key = runCacheKey(index);
+    if (!key.isEmpty() && restoreCachedRun(index, key))
+        return;
+    if (!key.isEmpty())
+        runCacheKeys[index] = key;
+
     auto *tmp = new Core::Runner(index);
     connect(tmp, &Core::Runner::runStarted, this, &MainWindow::onRunStarted);
     connect(tmp, &Core::Runner::runFinished, this, &MainWindow::onRunFinished);
     connect(tmp, &Core::Runner::failedToStartRun, this, &MainWindow::onFailedToStartRun);
     connect(tmp, &Core::Runner::runOutputLimitExceeded, this, &MainWindow::onRunOutputLimitExceeded);
     connect(tmp, &Core::Runner::runKilled, this, &MainWindow::onRunKilled);
-    tmp->run(tmpPath(), filePath, language, SettingsManager::get(QString("%1/Run Command").arg(language)).toString(),
+    connect(tmp, &Core::Runner::runTimeBreakdown, this, &MainWindow::onRunTimeBreakdown);
+    connect(tmp, &Core::Runner::runOutputMismatched, this, &MainWindow::onRunOutputMismatched);
+    connect(tmp, &Core::Runner::runInputExhausted, this, &MainWindow::onRunInputExhausted);
+    connect(tmp, &Core::Runner::runCounters, this, &MainWindow::onRunCounters);
+    connect(tmp, &Core::Runner::runCountersUnavailable, this, &MainWindow::onRunCountersUnavailable);
+    connect(tmp, &Core::Runner::runHeapProfile, this, &MainWindow::onRunHeapProfile);
+    connect(tmp, &Core::Runner::runTimingStats, this, &MainWindow::onRunTimingStats);
+    connect(tmp, &Core::Runner::runOutputLimitExceeded, this, [this](int index) { runCacheKeys.remove(index); });
+    connect(tmp, &Core::Runner::runChecked, this,
+            [this](int index, Widgets::TestCase::Verdict verdict) { judgedVerdicts[index] = verdict; });
+    connect(tmp, &Core::Runner::runOutputElided, this, [this](int index, const QString &wholeOutputPath) {
+        // only the beginning of the output is received, so the result is not cached
+        runCacheKeys.remove(index);
+        wholeOutputPaths[index] = wholeOutputPath;
+    });
+    auto path = tmpPath();
+#ifdef Q_OS_LINUX
+    tmp->setDetectInputExhaustion(SettingsHelper::isDetectInputExhaustion());
+    tmp->setProfileCounters(profileCounters);
+    if (profileHeap && !path.isEmpty())
+    {
+        heapProfileSource = path;
+        tmp->setHeapProfile(Extensions::HeapProfiler::instance()->libraryPath(),
+                            QFileInfo(path).dir().filePath(QString("heap-%1.json").arg(index)));
+    }
+    if (stableTiming && !profileCounters && !profileHeap)
+        tmp->setStableTiming(SettingsHelper::getStableTimingRepeats());
+#endif
+    if (SettingsHelper::isCheckOutputWhileRunning() &&
+        Core::IncrementalChecker::isSupported(testcases->checkerType()) && !testcases->expected(index).isEmpty())
+        tmp->setIncrementalChecker(testcases->checkerType(), testcases->expected(index));
+    if (!path.isEmpty())
+        tmp->setJudgeOnService(testcases->checkerType(), testcases->expected(index),
+                               QFileInfo(path).dir().filePath(QString("output-%1.txt").arg(index)));
+    ++runningCount;
+    tmp->run(path, filePath, language, SettingsManager::get(QString("%1/Run Command").arg(language)).toString(),
              SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString(), testcases->input(index),
              timeLimit());
     runner.push_back(tmp);
 }
 
+QString MainWindow::runCacheKey(int index)
+{
+    // the profiling runs are slower than the normal runs, so their results are not cached
+    if (!SettingsHelper::isRunResultCache() || profileCounters || profileHeap)
+        return QString();
+
+    if (runCacheProgramHash.isEmpty())
+        runCacheProgramHash = Core::RunCache::programHash(tmpPath(), filePath, language);
+    if (runCacheProgramHash.isEmpty())
+        return QString();
+
+    return Core::RunCache::key(runCacheProgramHash, testcases->input(index), timeLimit(),
+                               SettingsManager::get(QString("%1/Run Command").arg(language)).toString(),
+                               SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString());
+}
+
+bool MainWindow::restoreCachedRun(int index, const QString &key)
+{
+    // the stable timing profile is used to measure the program again, so the results are stored but not restored
+    if (bypassRunCache || (stableTiming && Core::StableTiming::isSupported()))
+        return false;
+
+    Core::RunCache::Result result;
+    if (!Core::RunCache::find(key, &result))
+        return false;
+
+    LOG_INFO("Restoring the result of the test case from the run cache. " << INFO_OF(index) << INFO_OF(key));
+
+    log->info(getRunnerHead(index),
+              tr("The result of test case #%1 is restored from the cache of an unchanged run at %2. Use \"%3\" "
+                 "to run it again.")
+                  .arg(index + 1)
+                  .arg(result.runTime.toLocalTime().toString(Qt::DefaultLocaleShortDate))
+                  .arg(tr("Compile and Run Without Cache")));
+    testcases->setRunStats(index, tr("cached"),
+                           tr("This result is restored from the run at %1, the program and the input are unchanged.")
+                               .arg(result.runTime.toLocalTime().toString(Qt::DefaultLocaleLongDate)));
+
+    ++runningCount;
+    onRunFinished(index, result.out, result.err, result.exitCode, result.timeUsed, result.tle);
+    return true;
+}
+
+void MainWindow::runNextQueued()
+{
+    // without sorting, all test cases are started at the same time
+    int limit = SettingsHelper::isRunSmallestTestcasesFirst() ? qMax(1, QThread::idealThreadCount()) : INT_MAX;
+    limit = Core::RunScheduler::instance()->limit(this, limit); // shared with the other tabs when judging all tabs
+    if (stableTiming && Core::StableTiming::isSupported())
+        limit = 1; // all runs are pinned to the same CPU, running them together would disturb each other
+    while (!runQueue.isEmpty() && runningCount < limit)
+        run(runQueue.dequeue());
+}
+
+void MainWindow::stopRunsOnFailure(int index)
+{
+    if (!SettingsHelper::isStopOnFirstFailure() || (runQueue.isEmpty() && runningCount == 0))
+        return;
+
+    LOG_INFO(INFO_OF(index) << INFO_OF(runQueue.length()) << INFO_OF(runningCount));
+
+    log->warn(tr("Runner"),
+              tr("Test case #%1 failed, the remaining test cases are cancelled. You can change it at %2.")
+                  .arg(index + 1)
+                  .arg(SettingsHelper::pathOfStopOnFirstFailure()),
+              false);
+
+    runQueue.clear();
+    runningCount = 0;
+
+    // the cancelled test cases are not run on the sanitizer build either
+    for (int cancelled : judgingTestCases)
+        sanitizerInputs.remove(cancelled);
+    runSanitizerBuild();
+
+    // this is called in the slots of the runners, so they can't be deleted immediately
+    for (auto &t : runner)
+    {
+        t->disconnect(this);
+        t->deleteLater();
+    }
+    runner.clear();
+
+    if (!judgingTestCases.isEmpty())
+    {
+        judgingTestCases.clear();
+        emit judgingFinished(this);
+    }
+}
+
+void MainWindow::finishTestCase(int index)
+{
+    if (!judgingTestCases.remove(index))
+        return;
+
+    emit testCaseJudged(this, index);
+    if (judgingTestCases.isEmpty())
+    {
+        runSanitizerBuild();
+        emit judgingFinished(this);
+    }
+}
+
+void MainWindow::runSanitizerBuild()
+{
+    if (sanitizerBuild != nullptr && !sanitizerInputs.isEmpty())
+        sanitizerBuild->run(sanitizerInputs, timeLimit());
+    sanitizerInputs.clear();
+}
+
 void MainWindow::runTestCase(int index)
 {
     LOG_INFO(INFO_OF(index));
     killProcesses();
     testcases->clearOutput();
+    runResults.clear();
     log->clear();
 
     if (!QStringList({"C++", "Java", "Python"}).contains(language))
@@ -220,9 +470,71 @@ void MainWindow::runTestCase(int index)
         return;
     }
 
+    judgingTestCases.insert(index);
     run(index);
 }
 
+void MainWindow::profileTestCase(int index)
+{
+    LOG_INFO(INFO_OF(index));
+
+    if (language != "C++")
+    {
+        log->warn(tr("Profiler"), tr("Only C++ programs can be profiled"));
+        return;
+    }
+
+    if (SettingsHelper::isSaveFileOnCompilation())
+        saveFile(IgnoreUntitled, tr("Profiler"), true);
+
+    auto path = tmpPath();
+    if (path.isEmpty())
+        return;
+
+    delete profiler;
+    profiler = new Extensions::Profiler(log, this);
+
+    connect(profiler, &Extensions::Profiler::failed, this,
+            [this](const QString &reason) { log->error(tr("Profiler"), reason); });
+
+    connect(profiler, &Extensions::Profiler::finished, this, [this, index](const Extensions::Profiler::Result &result) {
+        if (profilerDialog == nullptr)
+        {
+            profilerDialog = new Widgets::ProfilerDialog(this);
+            connect(profilerDialog, &Widgets::ProfilerDialog::requestGoToLine, this, [this](int line) {
+                QTextCursor cursor(editor->document()->findBlockByNumber(line - 1));
+                editor->setTextCursor(cursor);
+                editor->setFocus();
+            });
+        }
+        profilerDialog->setResult(result, tr("Test case #%1").arg(index + 1));
+        Util::showWidgetOnTop(profilerDialog);
+
+        // the annotations are cleared with the diagnostics when the language server lints the code again
+        QStringList hottest;
+        for (const auto &hotLine : result.hotLines)
+        {
+            if (!hotLine.inSource || hotLine.percent < 1)
+                continue;
+            auto block = editor->document()->findBlockByNumber(hotLine.line - 1);
+            if (!block.isValid())
+                continue;
+            editor->squiggle(QCodeEditor::SeverityLevel::Information, {hotLine.line, 0},
+                             {hotLine.line, block.length() - 1},
+                             tr("%1% of the samples in the profile").arg(hotLine.percent, 0, 'f', 2));
+            if (hottest.size() < 3)
+                hottest.push_back(tr("line %1 (%2%)").arg(hotLine.line).arg(hotLine.percent, 0, 'f', 1));
+        }
+
+        log->info(tr("Profiler"),
+                  hottest.isEmpty() ? tr("Profiling finished")
+                                    : tr("Profiling finished, the hottest lines: %1").arg(hottest.join(", ")));
+    });
+
+    log->clear();
+    profiler->start(path, filePath, compileCommand(), testcases->input(index), timeLimit());
+}
+
 void MainWindow::loadTests()
 {
     if (!isUntitled() && SettingsHelper::isSaveTests())
@@ -387,6 +699,7 @@ MainWindow::EditorStatus::EditorStatus(const QMap<QString, QVariant> &status)
 {
     LOG_INFO("Window status from map");
     FROMSTATUS(isLanguageSet).toInt();
+    FROMSTATUS(stableTiming).toBool();
     FROMSTATUS(filePath).toString();
     FROMSTATUS(savedText).toString();
     FROMSTATUS(problemURL).toString();
@@ -414,6 +727,7 @@ QMap<QString, QVariant> MainWindow::EditorStatus::toMap() const
     LOG_INFO("Window status to hashmap");
     QMap<QString, QVariant> status;
     TOSTATUS(isLanguageSet);
+    TOSTATUS(stableTiming);
     TOSTATUS(filePath);
     TOSTATUS(savedText);
     TOSTATUS(problemURL);
@@ -454,6 +768,7 @@ MainWindow::EditorStatus MainWindow::toStatus() const
     status.horizontalScrollBarValue = editor->horizontalScrollBar()->value();
     status.verticalScrollbarValue = editor->verticalScrollBar()->value();
     status.customTimeLimit = customTimeLimit;
+    status.stableTiming = stableTiming;
     status.input = testcases->inputs();
     status.expected = testcases->expecteds();
     for (int i = 0; i < testcases->count(); ++i)
@@ -486,6 +801,7 @@ void MainWindow::loadStatus(const EditorStatus &status, bool duplicate)
     editor->horizontalScrollBar()->setValue(status.horizontalScrollBarValue);
     editor->verticalScrollBar()->setValue(status.verticalScrollbarValue);
     customTimeLimit = status.customTimeLimit;
+    stableTiming = status.stableTiming;
     testcases->loadStatus(status.input, status.expected);
     for (int i = 0; i < status.testcasesIsShow.count() && i < testcases->count(); ++i)
         testcases->setChecked(i, status.testcasesIsShow[i].toBool());
@@ -670,6 +986,9 @@ void MainWindow::runOnly()
 {
     LOG_INFO("Requesting Run only");
     emit compileOrRunTriggered();
+    profileCounters = false;
+    profileHeap = false;
+    bypassRunCache = false;
     log->clear();
     run();
 }
@@ -679,17 +998,131 @@ void MainWindow::compileAndRun()
     LOG_INFO("Requested Compile and Run");
     emit compileOrRunTriggered();
     afterCompile = Run;
+    profileCounters = false;
+    profileHeap = false;
+    bypassRunCache = false;
+    log->clear();
+    compile();
+}
+
+void MainWindow::compileAndRunWithoutCache()
+{
+    LOG_INFO("Requested Compile and Run without the run cache");
+    emit compileOrRunTriggered();
+    afterCompile = Run;
+    profileCounters = false;
+    profileHeap = false;
+    bypassRunCache = true;
+    log->clear();
+    compile();
+}
+
+void MainWindow::compileAndRunWithCounters()
+{
+    LOG_INFO("Requested Compile and Run with performance counters");
+    emit compileOrRunTriggered();
+    afterCompile = Run;
+    profileCounters = true;
+    profileHeap = false;
+    log->clear();
+    compile();
+}
+
+void MainWindow::compileAndRunWithHeapProfile()
+{
+    LOG_INFO("Requested Compile and Run with heap profiling");
+    emit compileOrRunTriggered();
     log->clear();
+
+    if (language != "C++")
+    {
+        log->warn(tr("Heap Profiler"), tr("Only C++ programs can be profiled"));
+        return;
+    }
+
+    // the compilation starts when the allocation recorder is ready
+    heapProfilerCompiler = QProcess::splitCommand(compileCommand()).value(0);
+    Extensions::HeapProfiler::instance()->prepare(heapProfilerCompiler);
+}
+
+void MainWindow::onHeapProfilerPrepared(const QString &compiler, const QString &error)
+{
+    if (heapProfilerCompiler.isEmpty() || compiler != heapProfilerCompiler)
+        return; // it's requested by another tab
+    heapProfilerCompiler.clear();
+
+    if (!error.isEmpty())
+    {
+        log->error(tr("Heap Profiler"), error);
+        return;
+    }
+
+    afterCompile = Run;
+    profileCounters = false;
+    profileHeap = true;
+    heapProfiles.clear();
     compile();
 }
 
-void MainWindow::formatSource(bool selectionOnly, bool logOnNoChange)
+void MainWindow::exportHeapProfile()
+{
+    LOG_INFO(INFO_OF(heapProfiles.count()));
+
+    if (heapProfiles.isEmpty())
+    {
+        log->warn(tr("Heap Profiler"),
+                  tr("There is no heap profile, please compile and run with heap profiling first"));
+        return;
+    }
+
+    emit confirmTriggered(this);
+    auto path = QFileDialog::getSaveFileName(this, tr("Export Heap Profile"), QString(), tr("JSON Files (*.json)"));
+    if (path.isEmpty())
+        return;
+
+    QJsonArray testcaseProfiles;
+    for (auto it = heapProfiles.cbegin(); it != heapProfiles.cend(); ++it)
+    {
+        auto profile = it.value();
+        profile["testcase"] = it.key() + 1;
+        testcaseProfiles.push_back(profile);
+    }
+
+    QJsonObject root;
+    root["file"] = filePath;
+    root["testcases"] = testcaseProfiles;
+
+    if (Util::saveFile(path, QString::fromUtf8(QJsonDocument(root).toJson()), tr("Heap Profiler"), true, log))
+        log->info(tr("Heap Profiler"), tr("The heap profile is exported to %1").arg(path));
+}
+
+void MainWindow::formatSource(bool selectionOnly, bool logOnNoChange, bool changedLinesOnly)
 {
-    LOG_INFO("Requested code format");
+    LOG_INFO("Requested code format. " << BOOL_INFO_OF(changedLinesOnly));
+
+    delete formatter; // the result of the previous request is dropped if it's still running
+    formatter = nullptr;
+
+    QList<QPair<int, int>> lines;
+    if (changedLinesOnly)
+    {
+        lines = Extensions::CodeFormatter::changedLines(formattedText, editor->toPlainText());
+        if (lines.isEmpty())
+        {
+            LOG_INFO("No lines are changed since the last format");
+            return;
+        }
+    }
+
     if (language == "Python")
-        Extensions::YAPFormatter(editor, language, selectionOnly, logOnNoChange, log, this).format();
+        formatter = new Extensions::YAPFormatter(editor, language, selectionOnly, logOnNoChange, log, this);
     else
-        Extensions::ClangFormatter(editor, language, selectionOnly, logOnNoChange, log, this).format();
+        formatter = new Extensions::ClangFormatter(editor, language, selectionOnly, logOnNoChange, log, this);
+
+    connect(formatter, &Extensions::CodeFormatter::completed, this, [this] { formattedText = editor->toPlainText(); });
+
+    formatter->setLineRanges(lines);
+    formatter->format();
 }
 
 void MainWindow::setLanguage(const QString &lang)
@@ -758,6 +1191,176 @@ void MainWindow::setViewMode(const QString &mode)
     }
 }
 
+void MainWindow::estimateComplexity()
+{
+    LOG_INFO("Requested complexity estimation");
+
+    if (complexityDialog == nullptr)
+    {
+        complexityDialog = new Widgets::ComplexityDialog(this);
+        connect(complexityDialog, &Widgets::ComplexityDialog::startRequested, this, [this] {
+            if (!QStringList({"C++", "Java", "Python"}).contains(language))
+            {
+                complexityDialog->setStopped(tr("Wrong language, please set the language"));
+                return;
+            }
+            emit compileOrRunTriggered();
+            killProcesses();
+            complexityDialog->setRunning();
+            afterCompile = EstimateComplexity;
+            log->clear();
+            compile();
+        });
+        connect(complexityDialog, &Widgets::ComplexityDialog::stopRequested, this, &MainWindow::killProcesses);
+    }
+
+    Util::showWidgetOnTop(complexityDialog);
+}
+
+void MainWindow::profileCompilation()
+{
+    LOG_INFO("Requested compilation profiling");
+
+    if (language != "C++")
+    {
+        log->warn(tr("Compilation Profiler"), tr("Only the compilation of C++ programs can be profiled"));
+        return;
+    }
+
+    if (SettingsHelper::isSaveFileOnCompilation())
+        saveFile(IgnoreUntitled, tr("Compilation Profiler"), true);
+
+    auto path = tmpPath();
+    if (path.isEmpty())
+        return;
+
+    delete compileProfiler;
+    compileProfiler = new Extensions::CompileProfiler(this);
+
+    connect(compileProfiler, &Extensions::CompileProfiler::failed, this,
+            [this](const QString &reason) { log->error(tr("Compilation Profiler"), reason); });
+
+    connect(compileProfiler, &Extensions::CompileProfiler::finished, this,
+            [this](const Extensions::CompileProfiler::Result &result) {
+                if (compileProfileDialog == nullptr)
+                    compileProfileDialog = new Widgets::CompileProfileDialog(this);
+                compileProfileDialog->setResult(result);
+                Util::showWidgetOnTop(compileProfileDialog);
+
+                QStringList slowest;
+                if (!result.headers.isEmpty())
+                    slowest.push_back(tr("the slowest header: %1 (%2 ms)")
+                                          .arg(QFileInfo(result.headers.front().name).fileName())
+                                          .arg(result.headers.front().time / 1000));
+                if (!result.instantiations.isEmpty())
+                    slowest.push_back(tr("the slowest instantiation: %1 (%2 ms)")
+                                          .arg(result.instantiations.front().name)
+                                          .arg(result.instantiations.front().time / 1000));
+                if (!result.phases.isEmpty())
+                    slowest.push_back(tr("the slowest phase: %1 (%2 ms)")
+                                          .arg(result.phases.front().name)
+                                          .arg(result.phases.front().time / 1000));
+                log->info(tr("Compilation Profiler"), tr("The compilation by %1 took %2 ms, %3")
+                                                          .arg(result.compiler)
+                                                          .arg(result.totalTime / 1000)
+                                                          .arg(slowest.join(", ")));
+            });
+
+    log->clear();
+    log->info(tr("Compilation Profiler"), tr("Compiling with the time report of the compiler"));
+    compileProfiler->start(path, filePath, compileCommand());
+}
+
+void MainWindow::startComplexityEstimation()
+{
+    auto options = complexityDialog->options();
+    options.timeLimit = timeLimit();
+
+    complexityEstimator = new Extensions::ComplexityEstimator(this);
+    connect(complexityEstimator, &Extensions::ComplexityEstimator::sampleMeasured, complexityDialog,
+            &Widgets::ComplexityDialog::addSample);
+    connect(complexityEstimator, &Extensions::ComplexityEstimator::finished, this,
+            [this, options](const Extensions::ComplexityEstimator::Result &result) {
+                complexityEstimator->deleteLater();
+                complexityEstimator = nullptr;
+                complexityDialog->setResult(result, options.timeLimit);
+                if (!result.fits.isEmpty())
+                {
+                    log->info(tr("Complexity Estimator"),
+                              tr("Best fit: %1, predicted %2ms at n = %3")
+                                  .arg(Extensions::ComplexityEstimator::modelName(result.fits.front().model))
+                                  .arg(result.fits.front().predictedTime, 0, 'f', 0)
+                                  .arg(options.maxConstraint));
+                }
+            });
+    connect(complexityEstimator, &Extensions::ComplexityEstimator::failed, this, [this](const QString &reason) {
+        complexityEstimator->deleteLater();
+        complexityEstimator = nullptr;
+        complexityDialog->setStopped(reason);
+        log->error(tr("Complexity Estimator"), reason);
+    });
+
+    log->info(tr("Complexity Estimator"),
+              tr("Measuring the running time with the generator [%1]").arg(options.generator));
+    complexityEstimator->start(options, tmpPath(), filePath, language,
+                               SettingsManager::get(QString("%1/Run Command").arg(language)).toString(),
+                               SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString());
+}
+
+void MainWindow::showDiagnostics(const QString &output, bool isError)
+{
+    // the output of a template error can be several megabytes, so it's parsed in another thread
+    using ParseResult = QPair<QVector<Core::CompilerDiagnostics::Diagnostic>, int>;
+    auto *watcher = new QFutureWatcher<ParseResult>(this);
+    int id = ++diagnosticsParseId;
+    auto filePath = compiledFilePath;
+    connect(watcher, &QFutureWatcher<ParseResult>::finished, this, [=] {
+        watcher->deleteLater();
+        if (id != diagnosticsParseId) // the diagnostics are cleared or replaced by another compilation
+            return;
+
+        const auto diagnostics = watcher->result().first;
+        const int merged = watcher->result().second;
+        if (diagnostics.isEmpty())
+        {
+            if (isError)
+                log->error(tr("Compile Errors"), output);
+            else
+                log->warn(tr("Compile Warnings"), output);
+            return;
+        }
+
+        diagnosticsView->setDiagnostics(diagnostics, filePath);
+
+        // only the first diagnostic is shown in the message logger, the whole output may be too long for it
+        auto first = std::find_if(diagnostics.begin(), diagnostics.end(), [isError](const auto &diagnostic) {
+            return diagnostic.severity ==
+                   (isError ? Core::CompilerDiagnostics::Error : Core::CompilerDiagnostics::Warning);
+        });
+        if (first == diagnostics.end())
+            first = diagnostics.begin();
+
+        auto summary = tr("%1 errors and %2 warnings, see the diagnostics below for all of them.")
+                           .arg(Core::CompilerDiagnostics::count(diagnostics, Core::CompilerDiagnostics::Error))
+                           .arg(Core::CompilerDiagnostics::count(diagnostics, Core::CompilerDiagnostics::Warning));
+        if (merged > 0)
+            summary += ' ' + tr("%1 repeated diagnostics are merged.").arg(merged);
+        auto body = summary + '\n' + Core::CompilerDiagnostics::headline(*first);
+        if (!first->details.isEmpty())
+            body += '\n' + first->details.join('\n');
+
+        if (isError)
+            log->error(tr("Compile Errors"), body);
+        else
+            log->warn(tr("Compile Warnings"), body);
+    });
+    watcher->setFuture(QtConcurrent::run([output] {
+        int merged = 0;
+        auto diagnostics = Core::CompilerDiagnostics::parse(output, &merged);
+        return qMakePair(diagnostics, merged);
+    }));
+}
+
 void MainWindow::detachedExecution()
 {
     LOG_INFO("Executing in detached mode");
@@ -789,6 +1392,16 @@ void MainWindow::killProcesses()
         delete t;
     }
     runner.clear();
+    runQueue.clear();
+    runningCount = 0;
+    runCacheProgramHash.clear();
+    runCacheKeys.clear();
+
+    if (!judgingTestCases.isEmpty())
+    {
+        judgingTestCases.clear();
+        emit judgingFinished(this);
+    }
 
     if (detachedRunner != nullptr)
     {
@@ -796,6 +1409,20 @@ void MainWindow::killProcesses()
         detachedRunner = nullptr;
     }
 
+    if (complexityEstimator != nullptr)
+    {
+        delete complexityEstimator;
+        complexityEstimator = nullptr;
+        complexityDialog->setStopped(tr("Stopped"));
+    }
+
+    if (sanitizerBuild != nullptr)
+    {
+        delete sanitizerBuild;
+        sanitizerBuild = nullptr;
+    }
+    sanitizerInputs.clear();
+
     killingProcesses = false;
 }
 
@@ -861,6 +1488,7 @@ void MainWindow::loadFile(const QString &loadPath)
         return;
 
     savedText = content;
+    formattedText = content; // only format the lines changed by the user on auto-save
     if (content.length() > SettingsHelper::getOpenFileLengthLimit())
     {
         log->error(tr("Open File"),
@@ -909,10 +1537,22 @@ bool MainWindow::saveFile(SaveMode mode, const QString &head, bool safe)
 {
     LOG_INFO(INFO_OF(mode) << INFO_OF(head) << BOOL_INFO_OF(safe));
 
-    if ((mode != AutoSave && SettingsHelper::isFormatOnManualSave()) ||
-        (mode == AutoSave && SettingsHelper::isFormatOnAutoSave()))
+    if (!skipFormatOnSave && ((mode != AutoSave && SettingsHelper::isFormatOnManualSave()) ||
+                              (mode == AutoSave && SettingsHelper::isFormatOnAutoSave())))
     {
-        formatSource(false, false);
+        // auto-save runs frequently, so only the lines changed since the last format are formatted
+        formatSource(false, false, mode == AutoSave);
+
+        // The code is saved before formatting if the result is not cached, save it again after it's formatted.
+        // The formatted code is dropped if the code is changed in the meantime, so the new save won't be outdated.
+        if (formatter != nullptr && formatter->isRunning())
+        {
+            connect(formatter, &Extensions::CodeFormatter::formatted, this, [this, mode, head, safe] {
+                skipFormatOnSave = true;
+                saveFile(mode == AutoSave ? AutoSave : IgnoreUntitled, head, safe);
+                skipFormatOnSave = false;
+            });
+        }
     }
 
     if (mode == SaveAs || (isUntitled() && mode == AlwaysSave))
@@ -1071,11 +1711,44 @@ void MainWindow::updateTimeLimit()
 {
     bool ok = false;
     const int limit = QInputDialog::getInt(this, tr("Set Time Limit"), tr("Custom time limit for this tab: (ms)"),
-                                           timeLimit(), 1, 3600000, 1000, &ok);
+                                           problemTimeLimit(), 1, 3600000, 1000, &ok);
     if (ok)
         customTimeLimit = limit;
 }
 
+bool MainWindow::isStableTiming() const
+{
+    return stableTiming;
+}
+
+void MainWindow::setStableTiming(bool enable)
+{
+    LOG_INFO(INFO_OF(enable));
+    stableTiming = enable;
+}
+
+QJsonArray MainWindow::testCaseResults() const
+{
+    static const QMap<Widgets::TestCase::Verdict, QString> verdictNames = {{Widgets::TestCase::AC, "AC"},
+                                                                            {Widgets::TestCase::WA, "WA"},
+                                                                            {Widgets::TestCase::TLE, "TLE"},
+                                                                            {Widgets::TestCase::RE, "RE"},
+                                                                            {Widgets::TestCase::IE, "IE"}};
+
+    QJsonArray results;
+    for (int i = 0; i < testcases->count(); ++i)
+    {
+        auto result = runResults.value(i);
+        result["index"] = i;
+        result["checked"] = testcases->isChecked(i);
+        auto verdict = testcases->verdict(i);
+        result["verdict"] = verdictNames.contains(verdict) ? QJsonValue(verdictNames[verdict]) : QJsonValue();
+        result["output"] = testcases->output(i);
+        results.push_back(result);
+    }
+    return results;
+}
+
 bool MainWindow::isTextChanged() const
 {
     if (isUntitled())
@@ -1117,6 +1790,8 @@ bool MainWindow::closeConfirm()
 void MainWindow::on_clearMessagesButton_clicked()
 {
     log->clear();
+    diagnosticsView->clearDiagnostics();
+    ++diagnosticsParseId;
 }
 
 void MainWindow::on_changeLanguageButton_clicked()
@@ -1245,6 +1920,12 @@ void MainWindow::updateChecker()
     else
         checker = new Core::Checker(testcases->checkerType(), log, this);
     connect(checker, &Core::Checker::checkFinished, testcases, &Widgets::TestCases::setVerdict);
+    connect(checker, &Core::Checker::checkFinished, this, [this](int index, Widgets::TestCase::Verdict verdict) {
+        finishTestCase(index);
+        if (verdict != Widgets::TestCase::AC)
+            stopRunsOnFailure(index);
+    });
+    connect(checker, &Core::Checker::checkFailed, this, [this](int index) { finishTestCase(index); });
     checker->prepare(SettingsManager::get(QString("C++/Compile Command")).toString());
 }
 
@@ -1266,6 +1947,11 @@ QString MainWindow::compileCommand() const
 }
 
 int MainWindow::timeLimit() const
+{
+    return Extensions::JudgeCalibration::scaledTimeLimit(problemTimeLimit(), problemURL);
+}
+
+int MainWindow::problemTimeLimit() const
 {
     if (customTimeLimit == -1)
         return SettingsHelper::getDefaultTimeLimit();
@@ -1310,15 +1996,19 @@ void MainWindow::onCompilationFinished(const QString &warning)
     {
         log->info(tr("Compiler"), tr("Compilation has finished"));
         if (!warning.trimmed().isEmpty())
-        {
-            log->warn(tr("Compile Warnings"), warning);
-        }
+            showDiagnostics(warning, false);
     }
 
+    emit compilationEnded(this, true);
+
     if (afterCompile == Run)
     {
         run();
     }
+    else if (afterCompile == EstimateComplexity)
+    {
+        startComplexityEstimation();
+    }
     else if (afterCompile == RunDetached)
     {
         if (SettingsHelper::isSaveFileOnExecution())
@@ -1345,9 +2035,12 @@ void MainWindow::onCompilationFinished(const QString &warning)
 void MainWindow::onCompilationErrorOccurred(const QString &error)
 {
     log->error(tr("Compiler"), tr("Error occurred while compiling"));
+    emit compilationEnded(this, false);
+    if (afterCompile == EstimateComplexity)
+        complexityDialog->setStopped(tr("Compilation failed"));
     if (!error.trimmed().isEmpty())
     {
-        log->error(tr("Compile Errors"), error);
+        showDiagnostics(error, true);
         if (language == "Java" && error.contains("public class"))
         {
             log->warn(
@@ -1362,6 +2055,9 @@ void MainWindow::onCompilationErrorOccurred(const QString &error)
 void MainWindow::onCompilationFailed(const QString &reason)
 {
     log->error(tr("Compiler"), tr("Failed to start compilation: %1").arg(reason), false);
+    emit compilationEnded(this, false);
+    if (afterCompile == EstimateComplexity)
+        complexityDialog->setStopped(tr("Compilation failed"));
 }
 
 void MainWindow::onCompilationKilled()
@@ -1388,13 +2084,35 @@ void MainWindow::onRunFinished(int index, const QString &out, const QString &err
 {
     auto head = getRunnerHead(index);
 
+    if (runCacheKeys.contains(index))
+    {
+        Core::RunCache::insert(runCacheKeys.take(index),
+                               {out, err, exitCode, timeUsed, tle, QDateTime::currentDateTime()});
+    }
+
+    runResults[index] = QJsonObject{{"exitCode", exitCode}, {"timeUsed", timeUsed}, {"timeLimitExceeded", tle}};
+    bool checking = false;
+    auto judgedVerdict = judgedVerdicts.value(index, Widgets::TestCase::UNKNOWN);
+    judgedVerdicts.remove(index);
+    auto wholeOutputPath = wholeOutputPaths.take(index);
+
     if (exitCode == 0)
     {
         log->info(head, tr("Execution for test case #%1 has finished in %2ms").arg(index + 1).arg(timeUsed));
 
-        if ((!out.isEmpty() && !testcases->expected(index).isEmpty()) ||
-            (SettingsHelper::isCheckOnTestcasesWithEmptyOutput() && exitCode == 0))
-            checker->reqeustCheck(index, testcases->input(index), out, testcases->expected(index));
+        if (judgedVerdict != Widgets::TestCase::UNKNOWN)
+        {
+            // the output is checked by the built-in checker on the judge service
+            testcases->setVerdict(index, judgedVerdict);
+        }
+        else if ((!out.isEmpty() && !testcases->expected(index).isEmpty()) ||
+                 (SettingsHelper::isCheckOnTestcasesWithEmptyOutput() && exitCode == 0))
+        {
+            checking = true;
+            checker->reqeustCheck(index, testcases->input(index),
+                                  wholeOutputPath.isEmpty() ? out : Util::readFile(wholeOutputPath, head, log),
+                                  testcases->expected(index));
+        }
     }
 
     else
@@ -1413,14 +2131,211 @@ void MainWindow::onRunFinished(int index, const QString &out, const QString &err
                              .arg(timeUsed));
     }
 
+    if (!err.trimmed().isEmpty())
+        log->error(head + tr("/stderr"), err);
+    testcases->setOutput(index, out, wholeOutputPath);
+
+    if (!checking)
+        finishTestCase(index);
+
+    if (index != -1)
+        --runningCount;
+
+    if (exitCode != 0 || (judgedVerdict != Widgets::TestCase::UNKNOWN && judgedVerdict != Widgets::TestCase::AC))
+        stopRunsOnFailure(index);
+    runNextQueued();
+}
+
+void MainWindow::onRunOutputMismatched(int index, const QString &out, const QString &err, int line, qint64 timeUsed)
+{
+    auto head = getRunnerHead(index);
+
+    log->error(head, tr("The output of test case #%1 mismatched on line %2, so the process is killed after %3ms. You "
+                        "can change it at %4.")
+                         .arg(index + 1)
+                         .arg(line)
+                         .arg(timeUsed)
+                         .arg(SettingsHelper::pathOfCheckOutputWhileRunning()),
+               false);
+    testcases->setVerdict(index, Widgets::TestCase::WA);
+
     if (!err.trimmed().isEmpty())
         log->error(head + tr("/stderr"), err);
     testcases->setOutput(index, out);
+
+    runResults[index] = QJsonObject{{"timeUsed", timeUsed}, {"mismatchedLine", line}};
+    finishTestCase(index);
+
+    --runningCount;
+    stopRunsOnFailure(index);
+    runNextQueued();
+}
+
+void MainWindow::onRunInputExhausted(int index, const QString &out, const QString &err, qint64 timeUsed)
+{
+    auto head = getRunnerHead(index);
+
+    log->warn(head, tr("The process running on test case #%1 waited for more input than provided, and failed after "
+                       "getting EOF in %2ms. You can change it at %3.")
+                        .arg(index + 1)
+                        .arg(timeUsed)
+                        .arg(SettingsHelper::pathOfDetectInputExhaustion()),
+              false);
+    testcases->setVerdict(index, Widgets::TestCase::IE);
+
+    if (!err.trimmed().isEmpty())
+        log->error(head + tr("/stderr"), err);
+    testcases->setOutput(index, out);
+
+    runResults[index] = QJsonObject{{"timeUsed", timeUsed}};
+    finishTestCase(index);
+
+    --runningCount;
+    stopRunsOnFailure(index);
+    runNextQueued();
+}
+
+void MainWindow::onRunCounters(int index, const Core::PerfCounters::Counts &counts)
+{
+    auto ratio = [](qint64 part, qint64 total) { return part < 0 || total <= 0 ? -1.0 : double(part) / total; };
+    auto count = [](qint64 value) { return value < 0 ? tr("N/A") : QString::number(value); };
+
+    QStringList summary;
+    double ipc = ratio(counts.instructions, counts.cycles);
+    if (ipc >= 0)
+        summary.push_back(tr("IPC %1").arg(ipc, 0, 'f', 2));
+    double cacheMissRate = ratio(counts.cacheMisses, counts.cacheReferences);
+    if (cacheMissRate >= 0)
+        summary.push_back(tr("cache miss %1%").arg(cacheMissRate * 100, 0, 'f', 1));
+    double branchMissRate = ratio(counts.branchMisses, counts.branches);
+    if (branchMissRate >= 0)
+        summary.push_back(tr("branch miss %1%").arg(branchMissRate * 100, 0, 'f', 1));
+    if (counts.pageFaults >= 0)
+        summary.push_back(tr("%1 page faults").arg(counts.pageFaults));
+
+    auto details = tr("cycles: %1\ninstructions: %2\ncache references: %3\ncache misses: %4\nbranches: %5\n"
+                      "branch misses: %6\npage faults: %7")
+                       .arg(count(counts.cycles))
+                       .arg(count(counts.instructions))
+                       .arg(count(counts.cacheReferences))
+                       .arg(count(counts.cacheMisses))
+                       .arg(count(counts.branches))
+                       .arg(count(counts.branchMisses))
+                       .arg(count(counts.pageFaults));
+
+    log->info(getRunnerHead(index), tr("Performance counters of test case #%1: %2")
+                                        .arg(index + 1)
+                                        .arg(summary.isEmpty() ? tr("N/A") : summary.join(", ")));
+    testcases->setRunStats(index, summary.join(" | "), details);
+}
+
+void MainWindow::onRunCountersUnavailable(int index, const QString &reason)
+{
+    if (countersWarningShown)
+        return;
+    countersWarningShown = true;
+    log->warn(getRunnerHead(index),
+              tr("Performance counters are unavailable, the test cases are run without them: %1").arg(reason), false);
+}
+
+void MainWindow::onRunHeapProfile(int index, const QString &reportPath)
+{
+    heapReports[reportPath] = index;
+    Extensions::HeapProfiler::instance()->readReport(reportPath, heapProfileSource);
+}
+
+void MainWindow::onHeapReportRead(const QString &reportPath, const QJsonObject &report, const QString &error)
+{
+    if (!heapReports.contains(reportPath))
+        return; // it's requested by another tab
+    int index = heapReports.take(reportPath);
+
+    if (report.isEmpty())
+    {
+        log->warn(getRunnerHead(index), tr("No heap profile for test case #%1: %2").arg(index + 1).arg(error));
+        return;
+    }
+    heapProfiles[index] = report;
+
+    auto size = [](double bytes) {
+        if (bytes < 1024)
+            return tr("%1 B").arg(bytes);
+        if (bytes < 1024 * 1024)
+            return tr("%1 KiB").arg(bytes / 1024, 0, 'f', 1);
+        return tr("%1 MiB").arg(bytes / 1024 / 1024, 0, 'f', 1);
+    };
+
+    auto message = tr("Heap profile of test case #%1: %2 allocations, %3 allocated, peak %4")
+                       .arg(index + 1)
+                       .arg(report["allocations"].toVariant().toLongLong())
+                       .arg(size(report["bytes"].toDouble()))
+                       .arg(size(report["peak"].toDouble()));
+
+    auto sites = report["sites"].toArray();
+    for (int i = 0; i < sites.count() && i < 5; ++i)
+    {
+        auto site = sites[i].toObject();
+        message += "\n" + tr("  %1: %2 allocations, %3")
+                              .arg(site["location"].toString())
+                              .arg(site["count"].toVariant().toLongLong())
+                              .arg(size(site["bytes"].toDouble()));
+    }
+
+    log->info(getRunnerHead(index), message);
+}
+
+void MainWindow::onRunTimingStats(int index, const QVector<qint64> &times)
+{
+    if (times.isEmpty())
+        return;
+
+    auto sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    int middle = sorted.length() / 2;
+    qint64 median = sorted.length() % 2 == 1 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+
+    double mean = std::accumulate(times.begin(), times.end(), 0.0) / times.length();
+    double variance = 0;
+    for (auto time : times)
+        variance += (time - mean) * (time - mean);
+    variance /= times.length();
+    double spread = mean > 0 ? std::sqrt(variance) / mean * 100 : 0;
+
+    QStringList list;
+    for (auto time : times)
+        list.push_back(QString::number(time));
+
+    log->info(getRunnerHead(index),
+              tr("Test case #%1: median %2ms, min %3ms, max %4ms, deviation %5% over %6 runs on CPU %7 (%8 ms)")
+                  .arg(index + 1)
+                  .arg(median)
+                  .arg(sorted.front())
+                  .arg(sorted.back())
+                  .arg(spread, 0, 'f', 1)
+                  .arg(times.length())
+                  .arg(Core::StableTiming::pinnedCpu())
+                  .arg(list.join(", ")));
+}
+
+void MainWindow::onRunTimeBreakdown(int index, qint64 startupTime, qint64 executionTime)
+{
+    log->info(getRunnerHead(index), tr("Test case #%1: start-up %2ms, execution %3ms")
+                                        .arg(index + 1)
+                                        .arg(startupTime)
+                                        .arg(executionTime));
 }
 
 void MainWindow::onFailedToStartRun(int index, const QString &error)
 {
     log->error(getRunnerHead(index), error, false);
+
+    if (index != -1)
+    {
+        runResults[index] = QJsonObject{{"error", error}};
+        finishTestCase(index);
+        --runningCount;
+        runNextQueued();
+    }
 }
 
 void MainWindow::onRunOutputLimitExceeded(int index, const QString &type)
@@ -18,12 +18,18 @@
 #ifndef MAINWINDOW_HPP
 #define MAINWINDOW_HPP
 
+#include "Core/PerfCounters.hpp"
+#include <QJsonObject>
 #include <QMainWindow>
+#include <QMap>
+#include <QQueue>
+#include <QSet>
 
 class AppWindow;
 class MessageLogger;
 class QCodeEditor;
 class QFileSystemWatcher;
+class QJsonArray;
 class QPushButton;
 class QSplitter;
 class QTemporaryDir;
@@ -44,13 +50,22 @@ class Runner;
 namespace Extensions
 {
 class CFTool;
+class CodeFormatter;
+class CompileProfiler;
+class ComplexityEstimator;
 struct CompanionData;
+class Profiler;
+class SanitizerBuild;
 } // namespace Extensions
 
 namespace Widgets
 {
+class CompileProfileDialog;
+class ComplexityDialog;
+class DiagnosticsView;
+class ProfilerDialog;
 class TestCases;
-}
+} // namespace Widgets
 
 class MainWindow : public QMainWindow
 {
@@ -59,7 +74,7 @@ class MainWindow : public QMainWindow
   public:
     struct EditorStatus
     {
-        bool isLanguageSet{};
+        bool isLanguageSet{}, stableTiming{};
         QString filePath, savedText, problemURL, editorText, language, customCompileCommand;
         int editorCursor{}, editorAnchor{}, horizontalScrollBarValue{}, verticalScrollbarValue{}, untitledIndex{},
             checkerIndex{}, customTimeLimit{};
@@ -105,7 +120,44 @@ class MainWindow : public QMainWindow
     void compileOnly();
     void runOnly();
     void compileAndRun();
-    void formatSource(bool selectionOnly, bool logOnNoChange);
+
+    /**
+     * @brief compile and run, without restoring the results from Core::RunCache
+     */
+    void compileAndRunWithoutCache();
+
+    /**
+     * @brief compile and run, and count the hardware events of each test case by perf_event_open
+     */
+    void compileAndRunWithCounters();
+
+    /**
+     * @brief compile and run, and record the heap allocations of each test case by Extensions::HeapProfiler
+     */
+    void compileAndRunWithHeapProfile();
+
+    /**
+     * @brief save the heap profiles of the last heap profiling run as a JSON file
+     */
+    void exportHeapProfile();
+
+    /**
+     * @brief show the dialog which measures the running time of the solution on generated inputs of growing sizes
+     */
+    void estimateComplexity();
+
+    /**
+     * @brief compile the solution again with the time report of the compiler, and show the slowest parts of it
+     */
+    void profileCompilation();
+
+    /**
+     * @brief format the code
+     * @param selectionOnly whether to format the selection only, the whole code is formatted if nothing is selected
+     * @param logOnNoChange whether to show a message if the code is already formatted
+     * @param changedLinesOnly whether to format only the lines changed since the last format
+     */
+    void formatSource(bool selectionOnly, bool logOnNoChange, bool changedLinesOnly = false);
 
     void applyCompanion(const Extensions::CompanionData &data);
 
@@ -137,6 +189,24 @@ class MainWindow : public QMainWindow
      */
     void updateTimeLimit();
 
+    /**
+     * @brief whether the test cases of this tab are run with the stable timing profile
+     */
+    bool isStableTiming() const;
+
+    /**
+     * @brief enable or disable the stable timing profile for this tab
+     * @note It's only supported on Linux. The test cases are run one by one when it's enabled.
+     */
+    void setStableTiming(bool enable);
+
+    /**
+     * @brief the results of the test cases in the last run, used by Extensions::LocalApi
+     * @returns an array of objects with the index, whether it's checked, the verdict, the output, and the exit code
+     *          and the time used if the test case has run
+     */
+    QJsonArray testCaseResults() const;
+
   private slots:
     void onCompilationStarted();
     void onCompilationFinished(const QString &warning);
@@ -149,6 +219,15 @@ class MainWindow : public QMainWindow
     void onFailedToStartRun(int index, const QString &error);
     void onRunOutputLimitExceeded(int index, const QString &type);
     void onRunKilled(int index);
+    void onRunTimeBreakdown(int index, qint64 startupTime, qint64 executionTime);
+    void onRunOutputMismatched(int index, const QString &out, const QString &err, int line, qint64 timeUsed);
+    void onRunInputExhausted(int index, const QString &out, const QString &err, qint64 timeUsed);
+    void onRunCounters(int index, const Core::PerfCounters::Counts &counts);
+    void onRunCountersUnavailable(int index, const QString &reason);
+    void onRunHeapProfile(int index, const QString &reportPath);
+    void onHeapProfilerPrepared(const QString &compiler, const QString &error);
+    void onHeapReportRead(const QString &reportPath, const QJsonObject &report, const QString &error);
+    void onRunTimingStats(int index, const QVector<qint64> &times);
 
     void onFileWatcherChanged(const QString &);
     void onEditorFontChanged(const QFont &newFont);
@@ -156,6 +235,7 @@ class MainWindow : public QMainWindow
     void updateCursorInfo();
     void updateChecker();
     void runTestCase(int index);
+    void profileTestCase(int index);
 
     // UI Slots
 
@@ -179,6 +259,22 @@ class MainWindow : public QMainWindow
     void editorLanguageChanged(MainWindow *window);
     void compileOrRunTriggered();
 
+    /**
+     * @brief the compilation is finished or failed, it's also emitted for Python
+     * @note it's not emitted when the compilation is killed, e.g. by a new compilation
+     */
+    void compilationEnded(MainWindow *window, bool succeeded);
+
+    /**
+     * @brief the result of a test case in the current run is final, i.e. it's not checked or the check is finished
+     */
+    void testCaseJudged(MainWindow *window, int index);
+
+    /**
+     * @brief all test cases in the current run are judged, cancelled or killed
+     */
+    void judgingFinished(MainWindow *window);
+
   private:
     enum SaveMode
     {
@@ -191,7 +287,8 @@ class MainWindow : public QMainWindow
     {
         Nothing,
         Run,
-        RunDetached
+        RunDetached,
+        EstimateComplexity
     };
 
     Ui::MainWindow *ui;
@@ -201,6 +298,22 @@ class MainWindow : public QMainWindow
 
     Core::Compiler *compiler = nullptr;
     QVector<Core::Runner *> runner;
+    QQueue<int> runQueue; // the test cases waiting to run
+    int runningCount = 0; // the number of runners which are not finished
+    bool profileCounters = false;        // whether the current runs count the hardware events
+    bool countersWarningShown = false;   // whether the counters unavailable warning is shown for the current runs
+    bool profileHeap = false;            // whether the current runs record the heap allocations
+    QString heapProfilerCompiler;        // the compiler of the allocation recorder this tab is waiting for
+    QString heapProfileSource;           // the compiled source file of the heap profiling runs
+    QMap<int, QJsonObject> heapProfiles; // the heap profiles of the last heap profiling runs, keyed by the test cases
+    QMap<QString, int> heapReports;      // the test cases of the heap profile reports being read, keyed by the paths
+    bool bypassRunCache = false;         // whether the current runs ignore the results in Core::RunCache
+    QByteArray runCacheProgramHash;      // the hash of the program of the current runs, computed on the first run
+    QMap<int, QString> runCacheKeys;     // the keys of the running test cases whose results will be cached
+    QSet<int> judgingTestCases;          // the test cases in the current run whose results are not final
+    QMap<int, QJsonObject> runResults;   // the exit codes and the time used of the test cases in the last run
+    QMap<int, Widgets::TestCase::Verdict> judgedVerdicts; // the verdicts given by the judge service, before runFinished
+    QMap<int, QString> wholeOutputPaths; // the files with the whole elided stdout of the runs on the judge service
     Core::Checker *checker = nullptr;
     Core::Runner *detachedRunner = nullptr;
     QTemporaryDir *tmpDir = nullptr;
@@ -225,15 +338,73 @@ class MainWindow : public QMainWindow
 
     Widgets::TestCases *testcases = nullptr;
 
+    Widgets::DiagnosticsView *diagnosticsView = nullptr;
+    QString compiledFilePath; // the temporary file of the current compilation, the diagnostics are located in it
+    int diagnosticsParseId = 0; // the results of the older parses of the compiler output are dropped
+
+    Extensions::Profiler *profiler = nullptr;
+    Widgets::ProfilerDialog *profilerDialog = nullptr;
+
+    Extensions::ComplexityEstimator *complexityEstimator = nullptr;
+    Widgets::ComplexityDialog *complexityDialog = nullptr;
+
+    Extensions::CompileProfiler *compileProfiler = nullptr;
+    Widgets::CompileProfileDialog *compileProfileDialog = nullptr;
+
+    Extensions::SanitizerBuild *sanitizerBuild = nullptr; // the sanitizer build of the current compilation
+    QMap<int, QString> sanitizerInputs;                   // the inputs of the current runs, run on it after them
+
+    Extensions::CodeFormatter *formatter = nullptr; // the formatter of the latest format request
+    bool skipFormatOnSave = false;                  // true when saving the code formatted after the previous save
+    QString formattedText;                          // the code after the last format, or when the file is loaded
+
     QTimer *autoSaveTimer = nullptr;
 
     int customTimeLimit = -1;     // the custom time limit for this tab, -1 represents for the same as settings
+    bool stableTiming = false;    // whether to run the test cases with the stable timing profile
     QString customCompileCommand; // the custom compile command for this tab, empty represents for the same as settings
 
     void setEditor();
     void compile();
     void run();
     void run(int index);
+    void runNextQueued();
+
+    /**
+     * @brief get the key of a test case in Core::RunCache
+     * @returns the key, empty if the result shouldn't be cached in the current runs
+     */
+    QString runCacheKey(int index);
+
+    /**
+     * @brief restore the result of a test case from Core::RunCache
+     * @returns whether the result is restored
+     */
+    bool restoreCachedRun(int index, const QString &key);
+
+    /**
+     * @brief start the complexity estimator on the compiled solution, with the options in the dialog
+     */
+    void startComplexityEstimation();
+
+    /**
+     * @brief show the output of the compiler in the diagnostics view, and a summary of it in the message logger
+     * @param output the output of the compiler
+     * @param isError whether the compilation failed
+     * @note the output is parsed in another thread, if no diagnostic is recognized, it's shown in the message logger
+     */
+    void showDiagnostics(const QString &output, bool isError);
+    void stopRunsOnFailure(int index);
+
+    /**
+     * @brief mark the result of a test case as final, and emit judgingFinished after the last one
+     */
+    void finishTestCase(int index);
+
+    /**
+     * @brief run the test cases of the current runs on the sanitizer build, if there is one
+     */
+    void runSanitizerBuild();
     void loadTests();
     void saveTests(bool safe);
     void setCFToolUI();
@@ -245,7 +416,8 @@ class MainWindow : public QMainWindow
     void performCompileAndRunDiagonistics();
     static QString getRunnerHead(int index);
     QString compileCommand() const;
-    int timeLimit() const;
+    int timeLimit() const;        // the time limit used to run, scaled by the speed of the judge of the problem
+    int problemTimeLimit() const; // the time limit of the problem, the custom one or the default one
     void updateCompileAndRunButtons() const;
 };
 #endif // MAINWINDOW_HPP
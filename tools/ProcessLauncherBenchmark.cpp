@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * A micro-benchmark of the process launchers used by Core::Runner.
+ * It starts a trivial program many times with each launcher and prints the latency from start() to finished().
+ *
+ * Usage: ProcessLauncherBenchmark [iterations] [program [arguments...]]
+ * The default program is /bin/true, and the default number of iterations is 1000.
+ */
+
+#include "Core/QtChildProcess.hpp"
+#include "Core/SpawnChildProcess.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+static bool benchmark(const QString &name, const std::function<Core::ChildProcess *()> &create, int iterations,
+                      const QString &program, const QStringList &arguments)
+{
+    QTextStream out(stdout);
+    std::vector<qint64> latencies;
+    latencies.reserve(size_t(iterations));
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        auto *process = create();
+        QEventLoop loop;
+        bool failed = false;
+        QObject::connect(process, &Core::ChildProcess::finished, &loop, &QEventLoop::quit);
+        QObject::connect(process, &Core::ChildProcess::errorOccurred, &loop, [&](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart)
+            {
+                failed = true;
+                loop.quit();
+            }
+        });
+
+        QElapsedTimer timer;
+        timer.start();
+        process->start(program, arguments);
+        process->closeWriteChannel();
+        if (!failed)
+            loop.exec();
+        latencies.push_back(timer.nsecsElapsed() / 1000);
+        delete process;
+
+        if (failed)
+        {
+            out << name << ": failed to start " << program << Qt::endl;
+            return false;
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto mean = std::accumulate(latencies.begin(), latencies.end(), qint64(0)) / qint64(latencies.size());
+    out << name << ": min " << latencies.front() << "us, median " << latencies[latencies.size() / 2] << "us, mean "
+        << mean << "us, p95 " << latencies[latencies.size() * 95 / 100] << "us, max " << latencies.back() << "us"
+        << Qt::endl;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    auto args = app.arguments().mid(1);
+    int iterations = args.isEmpty() ? 1000 : std::max(1, args.takeFirst().toInt());
+    QString program = args.isEmpty() ? "/bin/true" : args.takeFirst();
+
+    bool ok = benchmark(
+        "QProcess", [] { return new Core::QtChildProcess(); }, iterations, program, args);
+
+    if (Core::SpawnChildProcess::isSupported())
+        ok = benchmark(
+                 "posix_spawn", [] { return new Core::SpawnChildProcess(); }, iterations, program, args) &&
+             ok;
+    else
+        QTextStream(stdout) << "posix_spawn: not supported on this platform" << Qt::endl;
+
+    return ok ? 0 : 1;
+}